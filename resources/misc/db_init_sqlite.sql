@@ -6,7 +6,7 @@ CREATE TABLE IF NOT EXISTS Information (
   inf_value       TEXT        NOT NULL
 );
 -- !
-INSERT INTO Information VALUES (1, 'schema_version', '6');
+INSERT INTO Information VALUES (1, 'schema_version', '9');
 -- !
 CREATE TABLE IF NOT EXISTS Accounts (
   id              INTEGER     PRIMARY KEY,
@@ -94,4 +94,24 @@ CREATE TABLE IF NOT EXISTS Messages (
   custom_hash     TEXT,
   
   FOREIGN KEY (account_id) REFERENCES Accounts (id)
-);
\ No newline at end of file
+);
+-- !
+CREATE INDEX IF NOT EXISTS idx_Messages_fingerprint ON Messages (account_id, feed, custom_hash);
+-- !
+CREATE INDEX IF NOT EXISTS idx_Messages_feed ON Messages (account_id, feed, date_created);
+-- !
+DROP TABLE IF EXISTS PendingChanges;
+-- !
+CREATE TABLE IF NOT EXISTS PendingChanges (
+  id              INTEGER     PRIMARY KEY,
+  account_id      INTEGER     NOT NULL,
+  change_type     INTEGER(1)  NOT NULL CHECK (change_type >= 0),
+  change_value    INTEGER(1)  NOT NULL,
+  custom_id       TEXT        NOT NULL,
+  feed            TEXT,
+  custom_hash     TEXT,
+  
+  FOREIGN KEY (account_id) REFERENCES Accounts (id)
+);
+-- !
+CREATE INDEX IF NOT EXISTS idx_PendingChanges_message ON PendingChanges (account_id, change_type, custom_id);
\ No newline at end of file
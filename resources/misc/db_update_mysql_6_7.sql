@@ -0,0 +1,3 @@
+CREATE INDEX idx_Messages_fingerprint ON Messages (account_id, feed(64), custom_hash(40));
+-- !
+UPDATE Information SET inf_value = '7' WHERE inf_key = 'schema_version';
\ No newline at end of file
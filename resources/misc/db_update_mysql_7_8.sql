@@ -0,0 +1,15 @@
+CREATE TABLE IF NOT EXISTS PendingChanges (
+  id              INTEGER     AUTO_INCREMENT PRIMARY KEY,
+  account_id      INTEGER     NOT NULL,
+  change_type     INTEGER(1)  NOT NULL CHECK (change_type >= 0),
+  change_value    INTEGER(1)  NOT NULL,
+  custom_id       TEXT        NOT NULL,
+  feed            TEXT,
+  custom_hash     TEXT,
+  
+  FOREIGN KEY (account_id) REFERENCES Accounts (id)
+);
+-- !
+CREATE INDEX idx_PendingChanges_message ON PendingChanges (account_id, change_type, custom_id(64));
+-- !
+UPDATE Information SET inf_value = '8' WHERE inf_key = 'schema_version';
\ No newline at end of file
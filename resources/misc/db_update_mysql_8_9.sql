@@ -0,0 +1,3 @@
+CREATE INDEX idx_Messages_feed ON Messages (account_id, feed(64), date_created);
+-- !
+UPDATE Information SET inf_value = '9' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -0,0 +1,3 @@
+CREATE INDEX IF NOT EXISTS idx_Messages_fingerprint ON Messages (account_id, feed, custom_hash);
+-- !
+UPDATE Information SET inf_value = '7' WHERE inf_key = 'schema_version';
\ No newline at end of file
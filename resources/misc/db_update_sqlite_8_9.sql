@@ -0,0 +1,3 @@
+CREATE INDEX IF NOT EXISTS idx_Messages_feed ON Messages (account_id, feed, date_created);
+-- !
+UPDATE Information SET inf_value = '9' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -0,0 +1,99 @@
+#!/bin/bash
+
+# Measures startup of RSS Guard against generated profile.
+#
+# Usage: ./startup-benchmark.sh <rssguard-executable> [feeds] [messages] [runs]
+#
+# Profile with given count of feeds and messages is generated in temporary
+# home folder. Application is then started several times with
+# "--quit-after-startup", so that it quits once first frame of main window
+# is painted, and durations of all startup phases are printed.
+# Requires Linux and "sqlite3" command line tool.
+
+RSSGUARD=$1
+FEEDS=${2:-500}
+MESSAGES=${3:-100000}
+RUNS=${4:-5}
+CATEGORIES=$(( FEEDS / 20 + 1 ))
+
+if [ ! -x "$RSSGUARD" ]; then
+  echo "Usage: $0 <rssguard-executable> [feeds] [messages] [runs]"
+  exit 1
+fi
+
+SCRIPT_FOLDER=$(cd "$(dirname "$0")" && pwd)
+DB_INIT="$SCRIPT_FOLDER/../misc/db_init_sqlite.sql"
+PROFILE=$(mktemp -d)
+PROFILE_FOLDER="$PROFILE/.rssguard/data"
+REPORTS="$PROFILE/reports"
+NOW=$(( $(date +%s) * 1000 ))
+
+mkdir -p "$PROFILE_FOLDER/config" "$PROFILE_FOLDER/database/local" "$REPORTS"
+
+# Settings must exist in home folder, otherwise portable settings could be used.
+cat > "$PROFILE_FOLDER/config/config.ini" << CONFIG
+[main]
+first_run=false
+first_run_3.3.3=false
+update_on_start=false
+
+[feeds]
+feeds_update_on_startup=false
+CONFIG
+
+echo "Generating profile with $FEEDS feeds and $MESSAGES messages in '$PROFILE'."
+
+sqlite3 "$PROFILE_FOLDER/database/local/database.db" << SQL
+.read $DB_INIT
+BEGIN;
+INSERT INTO Accounts (id, type) VALUES (1, 'std-rss');
+INSERT INTO Categories (id, parent_id, title, description, date_created, icon, account_id, custom_id)
+  WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < $CATEGORIES)
+  SELECT n, -1, 'Category ' || n, 'Generated category.', $NOW, NULL, 1, n FROM seq;
+INSERT INTO Feeds (id, title, description, date_created, icon, category, encoding, url, protected, update_type, update_interval, type, account_id, custom_id)
+  WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < $FEEDS)
+  SELECT n, 'Feed ' || n, 'Generated feed.', $NOW, NULL, (n - 1) % $CATEGORIES + 1, 'UTF-8',
+         'http://localhost/feeds/' || n, 0, 0, 15, 1, 1, n FROM seq;
+INSERT INTO Messages (id, is_read, is_deleted, is_important, feed, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash)
+  WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < $MESSAGES)
+  SELECT n, n % 3 = 0, 0, n % 50 = 0, (n - 1) % $FEEDS + 1, 'Message ' || n, 'http://localhost/messages/' || n,
+         'Author', $NOW - n * 60000, '<p>Contents of generated message ' || n || '.</p>', 0, '', 1, n, '' FROM seq;
+COMMIT;
+SQL
+
+if [ $? -ne 0 ]; then
+  echo "Profile was not generated."
+  exit 1
+fi
+
+for RUN in $(seq 1 $RUNS); do
+  HOME="$PROFILE" QT_QPA_PLATFORM=${QT_QPA_PLATFORM:-offscreen} "$RSSGUARD" \
+    --quit-after-startup --startup-timings="$REPORTS/run-$RUN.json" > /dev/null 2>&1
+
+  if [ ! -f "$REPORTS/run-$RUN.json" ]; then
+    echo "Run $RUN did not produce startup timings."
+    exit 1
+  fi
+done
+
+# Print average duration of each phase, first run includes
+# cold caches and is therefore reported separately. Keys of each phase
+# are collected until its object is closed, so their order does not matter.
+awk -v runs=$RUNS '
+  /\{/ { name = ""; duration = 0 }
+  /"name"/ { sub(/^[^:]*: *"/, ""); sub(/",? *$/, ""); name = $0 }
+  /"duration"/ { gsub(/[^0-9]/, "", $2); duration = $2 }
+  /\}/ && name != "" {
+    if (!(name in sum)) order[count++] = name
+    sum[name] += duration
+    if (FILENAME ~ /run-1.json$/) first[name] = duration
+    name = ""
+  }
+  /"total"/ { gsub(/[^0-9]/, "", $2); total += $2; if (FILENAME ~ /run-1.json$/) first_total = $2 }
+  END {
+    printf "%-16s %12s %12s\n", "phase", "first [ms]", "average [ms]"
+    for (i = 0; i < count; i++) printf "%-16s %12d %12.1f\n", order[i], first[order[i]], sum[order[i]] / runs
+    printf "%-16s %12d %12.1f\n", "total", first_total, total / runs
+  }' $(for RUN in $(seq 1 $RUNS); do echo "$REPORTS/run-$RUN.json"; done)
+
+echo "Reports of all runs were saved to '$REPORTS'."
@@ -43,6 +43,10 @@
 #
 #   LRELEASE_EXECUTABLE - specifies the name/path of "lrelease" executable, defaults to "lrelease".
 #
+#   USE_SYSTEM_SQLITE - if "true", then application links against system SQLite library and uses its
+#   online backup API for loading/saving of in-memory database. Use this only if your Qt is built
+#   with "-system-sqlite" switch.
+#
 # Other information:
 #   - supports Windows, Linux,
 #   - Qt 5.7 and higher is required,
@@ -136,6 +140,13 @@ message(rssguard: Prefix directory: '$$PREFIX'.)
 message(rssguard: Build revision: '$$APP_REVISION'.)
 message(rssguard: lrelease executable name: '$$LRELEASE_EXECUTABLE'.)
 
+equals(USE_SYSTEM_SQLITE, true) {
+  message(rssguard: Linking against system SQLite library.)
+
+  DEFINES += USE_SYSTEM_SQLITE
+  LIBS += -lsqlite3
+}
+
 QT += core gui widgets webenginewidgets sql network xml printsupport
 CONFIG *= c++11 debug_and_release warn_on
 DEFINES *= QT_USE_QSTRINGBUILDER QT_USE_FAST_CONCATENATION QT_USE_FAST_OPERATOR_PLUS UNICODE _UNICODE
@@ -160,7 +171,9 @@ HEADERS +=  src/core/feeddownloader.h \
             src/core/message.h \
             src/core/messagesmodel.h \
             src/core/messagesproxymodel.h \
+            src/core/messagesreadmarker.h \
             src/core/parsingfactory.h \
+            src/core/pendingchangessender.h \
             src/definitions/definitions.h \
             src/dynamic-shortcuts/dynamicshortcuts.h \
             src/dynamic-shortcuts/dynamicshortcutswidget.h \
@@ -215,10 +228,13 @@ HEADERS +=  src/core/feeddownloader.h \
             src/miscellaneous/settingsproperties.h \
             src/miscellaneous/simplecrypt/simplecrypt.h \
             src/miscellaneous/skinfactory.h \
+            src/miscellaneous/skintemplate.h \
+            src/miscellaneous/startupprofiler.h \
             src/miscellaneous/systemfactory.h \
             src/miscellaneous/textfactory.h \
             src/network-web/basenetworkaccessmanager.h \
             src/network-web/downloader.h \
+            src/network-web/iconcache.h \
             src/network-web/downloadmanager.h \
             src/network-web/networkfactory.h \
             src/network-web/silentnetworkaccessmanager.h \
@@ -250,6 +266,7 @@ HEADERS +=  src/core/feeddownloader.h \
             src/services/standard/standardcategory.h \
             src/services/standard/standardfeed.h \
             src/services/standard/standardfeedsimportexportmodel.h \
+            src/services/standard/standardfeedmetadataprober.h \
             src/services/standard/standardserviceentrypoint.h \
             src/services/standard/standardserviceroot.h \
             src/services/tt-rss/definitions.h \
@@ -262,6 +279,7 @@ HEADERS +=  src/core/feeddownloader.h \
             src/services/tt-rss/ttrssserviceentrypoint.h \
             src/services/tt-rss/ttrssserviceroot.h \
             src/gui/webviewer.h \
+            src/gui/webviewerpool.h \
             src/gui/webbrowser.h \
             src/network-web/webpage.h \
             src/gui/locationlineedit.h \
@@ -283,7 +301,9 @@ SOURCES +=  src/core/feeddownloader.cpp \
             src/core/message.cpp \
             src/core/messagesmodel.cpp \
             src/core/messagesproxymodel.cpp \
+            src/core/messagesreadmarker.cpp \
             src/core/parsingfactory.cpp \
+            src/core/pendingchangessender.cpp \
             src/dynamic-shortcuts/dynamicshortcuts.cpp \
             src/dynamic-shortcuts/dynamicshortcutswidget.cpp \
             src/dynamic-shortcuts/shortcutbutton.cpp \
@@ -337,10 +357,13 @@ SOURCES +=  src/core/feeddownloader.cpp \
             src/miscellaneous/settings.cpp \
             src/miscellaneous/simplecrypt/simplecrypt.cpp \
             src/miscellaneous/skinfactory.cpp \
+            src/miscellaneous/skintemplate.cpp \
+            src/miscellaneous/startupprofiler.cpp \
             src/miscellaneous/systemfactory.cpp \
             src/miscellaneous/textfactory.cpp \
             src/network-web/basenetworkaccessmanager.cpp \
             src/network-web/downloader.cpp \
+            src/network-web/iconcache.cpp \
             src/network-web/downloadmanager.cpp \
             src/network-web/networkfactory.cpp \
             src/network-web/silentnetworkaccessmanager.cpp \
@@ -371,6 +394,7 @@ SOURCES +=  src/core/feeddownloader.cpp \
             src/services/standard/standardcategory.cpp \
             src/services/standard/standardfeed.cpp \
             src/services/standard/standardfeedsimportexportmodel.cpp \
+            src/services/standard/standardfeedmetadataprober.cpp \
             src/services/standard/standardserviceentrypoint.cpp \
             src/services/standard/standardserviceroot.cpp \
             src/services/tt-rss/gui/formeditaccount.cpp \
@@ -382,6 +406,7 @@ SOURCES +=  src/core/feeddownloader.cpp \
             src/services/tt-rss/ttrssserviceentrypoint.cpp \
             src/services/tt-rss/ttrssserviceroot.cpp \
             src/gui/webviewer.cpp \
+            src/gui/webviewerpool.cpp \
             src/gui/webbrowser.cpp \
             src/network-web/webpage.cpp \
             src/gui/locationlineedit.cpp \
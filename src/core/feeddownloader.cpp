@@ -18,6 +18,7 @@
 #include "core/feeddownloader.h"
 
 #include "services/abstract/feed.h"
+#include "services/abstract/serviceroot.h"
 #include "definitions/definitions.h"
 
 #include <QThread>
@@ -25,55 +26,117 @@
 #include <QMetaType>
 #include <QMutex>
 #include <QThreadPool>
+#include <QTimer>
 
 
 FeedDownloader::FeedDownloader(QObject *parent)
-  : QObject(parent), m_results(FeedDownloadResults()), m_msgUpdateMutex(new QMutex()), m_feedsUpdated(0), m_feedsToUpdate(0),
-    m_feedsUpdating(0), m_feedsTotalCount(0), m_stopUpdate(false) {
+  : QObject(parent), m_results(FeedDownloadResults()), m_feedsInUpdate(QSet<Feed*>()),
+    m_requestsCount(0), m_resultsMutex(new QMutex()), m_msgUpdateMutex(new QMutex()),
+    m_feedsUpdated(0), m_feedsToUpdate(0), m_feedsUpdating(0), m_feedsTotalCount(0), m_progressTimer(QElapsedTimer()),
+    m_pendingProgressTimer(new QTimer(this)), m_pendingProgressFeed(nullptr), m_pendingProgressCurrent(0),
+    m_stopUpdate(false) {
   qRegisterMetaType<FeedDownloadResults>("FeedDownloadResults");
+
+  // Timer is child of this object, so it fires in the downloader thread.
+  m_pendingProgressTimer->setSingleShot(true);
+  connect(m_pendingProgressTimer, SIGNAL(timeout()), this, SLOT(emitPendingProgress()));
 }
 
 FeedDownloader::~FeedDownloader() {
   m_msgUpdateMutex->unlock();
   delete m_msgUpdateMutex;
+  delete m_resultsMutex;
   qDebug("Destroying FeedDownloader instance.");
 }
 
 bool FeedDownloader::isUpdateRunning() const {
-  return m_feedsToUpdate > 0 || m_feedsUpdating > 0;
+  return m_feedsToUpdate.load() > 0 || m_feedsUpdating.load() > 0;
 }
 
-void FeedDownloader::updateFeeds(const QList<Feed*> &feeds) {
-  if (feeds.isEmpty()) {
-    qDebug("No feeds to update in worker thread, aborting update.");
-    finalizeUpdate();
-    return;
-  }
+FeedDownloadResults FeedDownloader::results() const {
+  QMutexLocker locker(m_resultsMutex);
+  return m_results;
+}
+
+void FeedDownloader::updateFeeds(const QList<Feed*> &feeds, bool user_requested) {
+  const bool merging = isUpdateRunning();
 
-  qDebug().nospace() << "Starting feed updates from worker in thread: \'" << QThread::currentThreadId() << "\'.";
+  m_requestsCount++;
 
-  // It may be good to disable "stop" action when batch feed update
-  // starts.
+  // "Stop" action affects only requests which were already being
+  // started, new request is always started.
   m_stopUpdate = false;
 
-  m_results.clear();
+  if (!merging) {
+    if (feeds.isEmpty()) {
+      qDebug("No feeds to update in worker thread, aborting update.");
+      finalizeUpdate();
+      return;
+    }
+
+    qDebug().nospace() << "Starting feed updates from worker in thread: \'" << QThread::currentThreadId() << "\'.";
+
+    m_resultsMutex->lock();
+    m_results.clear();
+    m_resultsMutex->unlock();
+
+    m_feedsUpdated.store(0);
+    m_feedsUpdating.store(0);
+    m_feedsToUpdate.store(0);
+    m_feedsTotalCount = 0;
+    m_progressTimer.start();
+
+    // Job starts now.
+    emit started();
+  }
+
+  // Each feed is updated only once at a time, feeds which
+  // already wait for update or are being updated are skipped.
+  QList<Feed*> new_feeds;
+
+  foreach (Feed *feed, feeds) {
+    if (!m_feedsInUpdate.contains(feed)) {
+      m_feedsInUpdate.insert(feed);
+      new_feeds.append(feed);
+    }
+  }
+
+  if (merging) {
+    qDebug("Merging %d of %d requested feeds into running feed update.", new_feeds.size(), feeds.size());
+  }
+
+  m_feedsToUpdate.fetchAndAddOrdered(new_feeds.size());
+  m_feedsTotalCount += new_feeds.size();
+
+  // Changes made locally are pushed to online services first, otherwise
+  // they would be overwritten by older states of messages obtained by update.
+  // NOTE: This is done for each request, because changes could have been
+  // recorded since previous request was merged into the update.
+  QSet<ServiceRoot*> roots;
+
+  foreach (Feed *feed, new_feeds) {
+    roots.insert(feed->getParentServiceRoot());
+  }
 
-  m_feedsUpdated = 0;
-  m_feedsUpdating = 0;
-  m_feedsToUpdate = feeds.size();
-  m_feedsTotalCount = m_feedsToUpdate;
+  foreach (ServiceRoot *root, roots) {
+    root->pushPendingChanges();
+  }
 
-  // Job starts now.
-  emit started();
+  for (int i = 0; i < new_feeds.size(); i++) {
+    Feed *feed = new_feeds.at(i);
 
-  for (int i = 0; i < m_feedsTotalCount; i++) {
     if (m_stopUpdate) {
       qDebug("Stopping batch feed update now.");
 
       // We want indicate that no more feeds will be updated in this queue.
-      m_feedsToUpdate = 0;
+      m_feedsToUpdate.store(0);
 
-      if (m_feedsUpdating <= 0) {
+      // Feeds which were not started can be requested again.
+      for (int j = i; j < new_feeds.size(); j++) {
+        m_feedsInUpdate.remove(new_feeds.at(j));
+      }
+
+      if (m_feedsUpdating.load() <= 0) {
         // User forced to stop, no more feeds will start updating.
         // If also no feeds are updating right now, finish.
         finalizeUpdate();
@@ -82,12 +145,14 @@ void FeedDownloader::updateFeeds(const QList<Feed*> &feeds) {
       break;
     }
 
-    connect(feeds.at(i), &Feed::messagesObtained, this, &FeedDownloader::oneFeedUpdateFinished,
+    connect(feed, &Feed::messagesObtained, this, &FeedDownloader::oneFeedUpdateFinished,
             (Qt::ConnectionType) (Qt::UniqueConnection | Qt::AutoConnection));
-    QThreadPool::globalInstance()->start(feeds.at(i));
 
-    m_feedsUpdating++;
-    m_feedsToUpdate--;
+    // Feeds requested by user jump ahead of scheduled ones which still wait in the pool.
+    QThreadPool::globalInstance()->start(feed, user_requested ? 1 : 0);
+
+    m_feedsUpdating.ref();
+    m_feedsToUpdate.deref();
   }
 }
 
@@ -99,9 +164,10 @@ void FeedDownloader::oneFeedUpdateFinished(const QList<Message> &messages) {
   Feed *feed = qobject_cast<Feed*>(sender());
 
   disconnect(feed, &Feed::messagesObtained, this, &FeedDownloader::oneFeedUpdateFinished);
+  m_feedsInUpdate.remove(feed);
 
-  m_feedsUpdated++;
-  m_feedsUpdating--;
+  const int feeds_updated = m_feedsUpdated.fetchAndAddOrdered(1) + 1;
+  m_feedsUpdating.deref();
 
   // Now make sure, that messages are actually stored to SQL in a locked state.
 
@@ -113,34 +179,80 @@ void FeedDownloader::oneFeedUpdateFinished(const QList<Message> &messages) {
   int updated_messages = messages.isEmpty() ? 0 : feed->updateMessages(messages);
   m_msgUpdateMutex->unlock();
 
+  m_resultsMutex->lock();
+
   if (updated_messages > 0) {
     m_results.appendUpdatedFeed(QPair<QString,int>(feed->title(), updated_messages));
   }
+  else if (feed->contentUnchanged()) {
+    m_results.appendUnchangedFeed(feed->title());
+  }
+
+  m_resultsMutex->unlock();
+
+  qDebug("Made progress in feed updates, total feeds count %d/%d (id of feed is %d).", feeds_updated, m_feedsTotalCount, feed->id());
 
-  qDebug("Made progress in feed updates, total feeds count %d/%d (id of feed is %d).", m_feedsUpdated, m_feedsTotalCount, feed->id());
-  emit progress(feed, m_feedsUpdated, m_feedsTotalCount);
+  // Progress is not reported for each feed, otherwise GUI would
+  // be flooded with repaints when many small feeds are updated.
+  // Throttled progress is remembered and emitted once the interval
+  // passes, so that the last feeds of a burst are reported too.
+  m_pendingProgressFeed = feed;
+  m_pendingProgressCurrent = feeds_updated;
 
-  if (m_feedsToUpdate <= 0 && m_feedsUpdating <= 0) {
+  const qint64 elapsed = m_progressTimer.elapsed();
+
+  if (elapsed >= FEED_UPDATE_PROGRESS_INTERVAL) {
+    emitPendingProgress();
+  }
+  else if (!m_pendingProgressTimer->isActive()) {
+    m_pendingProgressTimer->start(FEED_UPDATE_PROGRESS_INTERVAL - elapsed);
+  }
+
+  if (m_feedsToUpdate.load() <= 0 && m_feedsUpdating.load() <= 0) {
     finalizeUpdate();
   }
 }
 
+void FeedDownloader::emitPendingProgress() {
+  m_pendingProgressTimer->stop();
+
+  if (m_pendingProgressFeed == nullptr) {
+    return;
+  }
+
+  m_progressTimer.restart();
+  emit progress(m_pendingProgressFeed, m_pendingProgressCurrent, m_feedsTotalCount);
+  m_pendingProgressFeed = nullptr;
+}
+
 void FeedDownloader::finalizeUpdate() {
-  qDebug().nospace() << "Finished feed updates in thread: \'" << QThread::currentThreadId() << "\'.";
+  qDebug().nospace() << "Finished feed updates in thread: \'" << QThread::currentThreadId() << "\', "
+                     << m_results.unchangedFeeds().size() << " feeds were unchanged.";
 
+  m_resultsMutex->lock();
   m_results.sort();
+  m_resultsMutex->unlock();
+
+  // Progress which was throttled is reported before update finishes.
+  if (m_pendingProgressTimer->isActive()) {
+    emitPendingProgress();
+  }
 
   // Make sure that there is not "stop" action pending.
   m_stopUpdate = false;
+  m_feedsInUpdate.clear();
+
+  const int requests = m_requestsCount;
+  m_requestsCount = 0;
 
   // Update of feeds has finished.
   // NOTE: This means that now "update lock" can be unlocked
   // and feeds can be added/edited/deleted and application
-  // can eventually quit.
-  emit finished(m_results);
+  // can eventually quit, if no other requests are pending.
+  emit finished(results(), requests);
 }
 
-FeedDownloadResults::FeedDownloadResults() : m_updatedFeeds(QList<QPair<QString,int> >()) {
+FeedDownloadResults::FeedDownloadResults() : m_updatedFeeds(QList<QPair<QString,int> >()), m_unchangedFeeds(QStringList()) {
 }
 
 QString FeedDownloadResults::overview(int how_many_feeds) const {
@@ -163,6 +275,10 @@ void FeedDownloadResults::appendUpdatedFeed(const QPair<QString,int> &feed) {
   m_updatedFeeds.append(feed);
 }
 
+void FeedDownloadResults::appendUnchangedFeed(const QString &feed_title) {
+  m_unchangedFeeds.append(feed_title);
+}
+
 void FeedDownloadResults::sort() {
   qSort(m_updatedFeeds.begin(), m_updatedFeeds.end(), FeedDownloadResults::lessThan);
 }
@@ -174,3 +290,7 @@ bool FeedDownloadResults::lessThan(const QPair<QString, int> &lhs, const QPair<Q
 QList<QPair<QString,int> > FeedDownloadResults::updatedFeeds() const {
   return m_updatedFeeds;
 }
+
+QStringList FeedDownloadResults::unchangedFeeds() const {
+  return m_unchangedFeeds;
+}
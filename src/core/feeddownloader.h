@@ -21,6 +21,10 @@
 #include <QObject>
 
 #include <QPair>
+#include <QSet>
+#include <QStringList>
+#include <QAtomicInt>
+#include <QElapsedTimer>
 
 #include "core/message.h"
 
@@ -33,23 +37,30 @@ class FeedDownloadResults {
     explicit FeedDownloadResults();
 
     QList<QPair<QString,int> > updatedFeeds() const;
+    QStringList unchangedFeeds() const;
     QString overview(int how_many_feeds) const;
 
     void appendUpdatedFeed(const QPair<QString,int> &feed);
+    void appendUnchangedFeed(const QString &feed_title);
     void sort();
 
     static bool lessThan(const QPair<QString,int> &lhs, const QPair<QString,int> &rhs);
 
     inline void clear() {
       m_updatedFeeds.clear();
+      m_unchangedFeeds.clear();
     }
 
   private:
     // QString represents title if the feed, int represents count of newly downloaded messages.
     QList<QPair<QString,int> > m_updatedFeeds;
+
+    // Titles of feeds whose data did not change since their previous update.
+    QStringList m_unchangedFeeds;
 };
 
 class QMutex;
+class QTimer;
 
 // This class offers means to "update" feeds and "special" categories.
 // NOTE: This class is used within separate thread.
@@ -63,12 +74,20 @@ class FeedDownloader : public QObject {
 
     bool isUpdateRunning() const;
 
+    // Returns results of feeds which were updated so far.
+    // NOTE: This can be called from any thread, also during update.
+    FeedDownloadResults results() const;
+
   public slots:
     // Performs update of all feeds from the "feeds" parameter.
     // New messages are downloaded for each feed and they
     // are stored persistently in the database.
     // Appropriate signals are emitted.
-    void updateFeeds(const QList<Feed*> &feeds);
+    // NOTE: If update is already running, feeds are merged into it
+    // and feeds which are already waiting for update or being updated
+    // are skipped. Feeds requested by user are updated before
+    // scheduled ones.
+    void updateFeeds(const QList<Feed*> &feeds, bool user_requested = true);
 
     // Stops running update.
     void stopRunningUpdate();
@@ -76,15 +95,21 @@ class FeedDownloader : public QObject {
   private slots:
     void oneFeedUpdateFinished(const QList<Message> &messages);
 
+    // Emits progress which was held back by throttling.
+    void emitPendingProgress();
+
   signals:
     // Emitted if feed updates started.
     void started();
 
     // Emitted if all items from update queue are
-    // processed.
-    void finished(FeedDownloadResults updated_feeds);
+    // processed. "Requests" is count of update requests
+    // which were merged into finished update.
+    void finished(FeedDownloadResults updated_feeds, int requests);
 
-    // Emitted if any item is processed.
+    // Emitted if any item is processed, but at most once
+    // per FEED_UPDATE_PROGRESS_INTERVAL. The latest progress
+    // is always emitted, at the latest when interval passes.
     // "Current" number indicates count of processed feeds
     // and "total" number indicates total number of feeds
     // which were in the initial queue.
@@ -94,13 +119,24 @@ class FeedDownloader : public QObject {
     void finalizeUpdate();
 
     FeedDownloadResults m_results;
+    QSet<Feed*> m_feedsInUpdate;
+    int m_requestsCount;
+    QMutex *m_resultsMutex;
     QMutex *m_msgUpdateMutex;
 
-    int m_feedsUpdated;
-    int m_feedsToUpdate;
-    int m_feedsUpdating;
+    QAtomicInt m_feedsUpdated;
+    QAtomicInt m_feedsToUpdate;
+    QAtomicInt m_feedsUpdating;
     int m_feedsTotalCount;
 
+    // Measures time since last emitted progress.
+    QElapsedTimer m_progressTimer;
+
+    // Emits throttled progress when interval passes.
+    QTimer *m_pendingProgressTimer;
+    const Feed *m_pendingProgressFeed;
+    int m_pendingProgressCurrent;
+
     bool m_stopUpdate;
 };
 
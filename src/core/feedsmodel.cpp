@@ -26,28 +26,34 @@
 #include "miscellaneous/textfactory.h"
 #include "miscellaneous/databasefactory.h"
 #include "miscellaneous/databasecleaner.h"
+#include "miscellaneous/databasequeries.h"
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/mutex.h"
 #include "gui/messagebox.h"
 #include "gui/statusbar.h"
 #include "gui/dialogs/formmain.h"
 #include "core/feeddownloader.h"
+#include "core/pendingchangessender.h"
 
 #include <QThread>
 #include <QSqlError>
 #include <QSqlRecord>
 #include <QPair>
-#include <QStack>
+#include <QSet>
 #include <QMimeData>
 #include <QTimer>
+#include <QElapsedTimer>
 
 #include <algorithm>
 
 
 FeedsModel::FeedsModel(QObject *parent)
   : QAbstractItemModel(parent), m_autoUpdateTimer(new QTimer(this)),
-    m_feedDownloaderThread(nullptr), m_feedDownloader(nullptr),
-    m_dbCleanerThread(nullptr), m_dbCleaner(nullptr) {
+    m_feedDownloaderThread(nullptr), m_feedDownloader(nullptr), m_feedUpdateRequests(0),
+    m_queuedUserFeeds(QList<QPointer<Feed> >()), m_queuedScheduledFeeds(QList<QPointer<Feed> >()), m_feedUpdateRunning(false),
+    m_coalescedItemsTimer(new QTimer(this)), m_coalescedItems(QList<QPointer<RootItem> >()),
+    m_dbCleanerThread(nullptr), m_dbCleaner(nullptr), m_archivingTimer(new QTimer(this)), m_pendingChangesTimer(new QTimer(this)),
+    m_changesSenderThread(nullptr), m_changesSender(nullptr) {
   setObjectName(QSL("FeedsModel"));
 
   // Create root item.
@@ -67,6 +73,19 @@ FeedsModel::FeedsModel(QObject *parent)
                    /*: Feed list header "counts" column tooltip.*/ tr("Counts of unread/all mesages.");
 
   connect(m_autoUpdateTimer, SIGNAL(timeout()), this, SLOT(executeNextAutoUpdate()));
+
+  m_pendingChangesTimer->setSingleShot(true);
+  connect(m_pendingChangesTimer, SIGNAL(timeout()), this, SLOT(pushPendingChanges()));
+
+  m_archivingTimer->setInterval(ARCHIVING_INTERVAL);
+  connect(m_archivingTimer, SIGNAL(timeout()), this, SLOT(archiveOldMessages()));
+
+  m_coalescedItemsTimer->setSingleShot(true);
+  m_coalescedItemsTimer->setInterval(FEED_UPDATE_PROGRESS_INTERVAL);
+  connect(m_coalescedItemsTimer, SIGNAL(timeout()), this, SLOT(reloadCoalescedItems()));
+
+  // Feeds which could not be updated are updated once other critical operation finishes.
+  connect(qApp->feedUpdateLock(), SIGNAL(unlocked()), this, SLOT(startQueuedFeedUpdates()), Qt::QueuedConnection);
   updateAutoUpdateStatus();
 }
 
@@ -86,6 +105,15 @@ void FeedsModel::quit() {
     m_autoUpdateTimer->stop();
   }
 
+  // Changes which are not pushed yet remain
+  // in the journal and are pushed on next startup.
+  m_pendingChangesTimer->stop();
+  m_archivingTimer->stop();
+
+  // Queued feeds are not updated anymore.
+  m_queuedUserFeeds.clear();
+  m_queuedScheduledFeeds.clear();
+
   // Close worker threads.
   if (m_feedDownloaderThread != nullptr && m_feedDownloaderThread->isRunning()) {
     m_feedDownloader->stopRunningUpdate();
@@ -101,6 +129,7 @@ void FeedsModel::quit() {
 
   if (m_dbCleanerThread != nullptr && m_dbCleanerThread->isRunning()) {
     qDebug("Quitting database cleaner thread.");
+    m_dbCleanerThread->requestInterruption();
     m_dbCleanerThread->quit();
 
     if (!m_dbCleanerThread->wait(CLOSE_LOCK_TIMEOUT)) {
@@ -109,6 +138,16 @@ void FeedsModel::quit() {
     }
   }
 
+  if (m_changesSenderThread != nullptr && m_changesSenderThread->isRunning()) {
+    qDebug("Quitting pending changes sender thread.");
+    m_changesSenderThread->quit();
+
+    if (!m_changesSenderThread->wait(CLOSE_LOCK_TIMEOUT)) {
+      qCritical("Pending changes sender thread is running despite it was told to quit. Terminating it.");
+      m_changesSenderThread->terminate();
+    }
+  }
+
   // Close workers.
   if (m_feedDownloader != nullptr) {
     qDebug("Feed downloader exists. Deleting it from memory.");
@@ -120,16 +159,91 @@ void FeedsModel::quit() {
     m_dbCleaner->deleteLater();
   }
 
+  if (m_changesSender != nullptr) {
+    qDebug("Pending changes sender exists. Deleting it from memory.");
+    m_changesSender->deleteLater();
+  }
+
   if (qApp->settings()->value(GROUP(Messages), SETTING(Messages::ClearReadOnExit)).toBool()) {
     markItemCleared(m_rootItem, true);
   }
 }
 
-void FeedsModel::updateFeeds(const QList<Feed*> &feeds) {
-  if (!qApp->feedUpdateLock()->tryLock()) {
-    qApp->showGuiMessage(tr("Cannot update all items"),
-                         tr("You cannot update all items because another critical operation is ongoing."),
-                         QSystemTrayIcon::Warning, qApp->mainForm(), true);
+void FeedsModel::updateFeeds(const QList<Feed*> &feeds, bool user_requested) {
+  if (feeds.isEmpty()) {
+    return;
+  }
+  else if (m_feedUpdateRequests > 0) {
+    // Update is running and we hold the lock, feeds are merged into it.
+    requestFeedsUpdate(feeds, user_requested);
+  }
+  else if (qApp->feedUpdateLock()->tryLock()) {
+    // Feeds which waited for the lock are handed over too.
+    requestFeedsUpdate(takeQueuedFeeds(m_queuedUserFeeds), true);
+    requestFeedsUpdate(takeQueuedFeeds(m_queuedScheduledFeeds), false);
+    requestFeedsUpdate(feeds, user_requested);
+  }
+  else {
+    qDebug("Delaying update of %d feeds until another critical operation finishes.", feeds.size());
+    queueFeedsUpdate(feeds, user_requested);
+  }
+}
+
+void FeedsModel::startQueuedFeedUpdates() {
+  if (m_feedUpdateRequests > 0 || (m_queuedUserFeeds.isEmpty() && m_queuedScheduledFeeds.isEmpty())) {
+    // Nothing waits for update or queued feeds were merged into running update already.
+    return;
+  }
+
+  const QList<Feed*> user_feeds = takeQueuedFeeds(m_queuedUserFeeds);
+  const QList<Feed*> scheduled_feeds = takeQueuedFeeds(m_queuedScheduledFeeds);
+
+  if ((user_feeds.isEmpty() && scheduled_feeds.isEmpty()) || !qApp->feedUpdateLock()->tryLock()) {
+    // Either all queued feeds were removed in the meantime or the lock
+    // was obtained by other operation, feeds wait for its end.
+    queueFeedsUpdate(user_feeds, true);
+    queueFeedsUpdate(scheduled_feeds, false);
+    return;
+  }
+
+  qDebug("Starting update of %d feeds which waited for another critical operation.", user_feeds.size() + scheduled_feeds.size());
+
+  requestFeedsUpdate(user_feeds, true);
+  requestFeedsUpdate(scheduled_feeds, false);
+}
+
+void FeedsModel::queueFeedsUpdate(const QList<Feed*> &feeds, bool user_requested) {
+  foreach (Feed *feed, feeds) {
+    if (m_queuedUserFeeds.contains(feed)) {
+      continue;
+    }
+    else if (user_requested) {
+      // Feeds requested by user are updated before scheduled ones.
+      m_queuedScheduledFeeds.removeAll(feed);
+      m_queuedUserFeeds.append(feed);
+    }
+    else if (!m_queuedScheduledFeeds.contains(feed)) {
+      m_queuedScheduledFeeds.append(feed);
+    }
+  }
+}
+
+QList<Feed*> FeedsModel::takeQueuedFeeds(QList<QPointer<Feed> > &queue) {
+  QList<Feed*> feeds;
+
+  foreach (const QPointer<Feed> &feed, queue) {
+    // Feeds could be deleted while they were waiting.
+    if (!feed.isNull()) {
+      feeds.append(feed.data());
+    }
+  }
+
+  queue.clear();
+  return feeds;
+}
+
+void FeedsModel::requestFeedsUpdate(const QList<Feed*> &feeds, bool user_requested) {
+  if (feeds.isEmpty()) {
     return;
   }
 
@@ -141,9 +255,9 @@ void FeedsModel::updateFeeds(const QList<Feed*> &feeds) {
     qRegisterMetaType<QList<Feed*> >("QList<Feed*>");
     m_feedDownloader->moveToThread(m_feedDownloaderThread);
 
-    connect(this, SIGNAL(feedsUpdateRequested(QList<Feed*>)), m_feedDownloader, SLOT(updateFeeds(QList<Feed*>)));
+    connect(this, SIGNAL(feedsUpdateRequested(QList<Feed*>,bool)), m_feedDownloader, SLOT(updateFeeds(QList<Feed*>,bool)));
     connect(m_feedDownloaderThread, SIGNAL(finished()), m_feedDownloaderThread, SLOT(deleteLater()));
-    connect(m_feedDownloader, SIGNAL(finished(FeedDownloadResults)), this, SLOT(onFeedUpdatesFinished(FeedDownloadResults)));
+    connect(m_feedDownloader, SIGNAL(finished(FeedDownloadResults,int)), this, SLOT(onFeedUpdatesFinished(FeedDownloadResults,int)));
     connect(m_feedDownloader, SIGNAL(started()), this, SLOT(onFeedUpdatesStarted()));
     connect(m_feedDownloader, SIGNAL(progress(const Feed*,int,int)), this, SLOT(onFeedUpdatesProgress(const Feed*,int,int)));
 
@@ -151,13 +265,15 @@ void FeedsModel::updateFeeds(const QList<Feed*> &feeds) {
     m_feedDownloaderThread->start();
   }
 
-  emit feedsUpdateRequested(feeds);
+  m_feedUpdateRequests++;
+  emit feedsUpdateRequested(feeds, user_requested);
 }
 
 void FeedsModel::onFeedUpdatesStarted() {
   //: Text display in status bar when feed update is started.
   qApp->mainForm()->statusBar()->showProgressFeeds(0, tr("Feed update started"));
 
+  m_feedUpdateRunning = true;
   emit feedsUpdateStarted();
 }
 
@@ -168,8 +284,21 @@ void FeedsModel::onFeedUpdatesProgress(const Feed *feed, int current, int total)
                                                    tr("Updated feed '%1'").arg(feed->title()));
 }
 
-void FeedsModel::onFeedUpdatesFinished(const FeedDownloadResults &results) {
-  qApp->feedUpdateLock()->unlock();
+void FeedsModel::onFeedUpdatesFinished(const FeedDownloadResults &results, int requests) {
+  // Display all remaining changes of updated items now.
+  m_feedUpdateRunning = false;
+  m_coalescedItemsTimer->stop();
+  reloadCoalescedItems();
+
+  m_feedUpdateRequests -= requests;
+
+  // Requests which reached feed downloader after this update
+  // had finished start next update, which keeps the lock.
+  if (m_feedUpdateRequests <= 0) {
+    m_feedUpdateRequests = 0;
+    qApp->feedUpdateLock()->unlock();
+  }
+
   qApp->mainForm()->statusBar()->clearProgressFeeds();
 
   if (!results.updatedFeeds().isEmpty()) {
@@ -193,6 +322,8 @@ DatabaseCleaner *FeedsModel::databaseCleaner() {
     qRegisterMetaType<CleanerOrders>("CleanerOrders");
     m_dbCleaner->moveToThread(m_dbCleanerThread);
     connect(m_dbCleanerThread, SIGNAL(finished()), m_dbCleanerThread, SLOT(deleteLater()));
+    connect(m_dbCleaner, SIGNAL(compressionFinished(bool,qint64)), this, SLOT(onContentsCompressionFinished(bool,qint64)));
+    connect(m_dbCleaner, SIGNAL(archivingFinished(bool)), this, SLOT(onArchivingFinished(bool)));
 
     // Connections are made, start the feed downloader thread.
     m_dbCleanerThread->start();
@@ -298,13 +429,8 @@ Qt::ItemFlags FeedsModel::flags(const QModelIndex &index) const {
 }
 
 void FeedsModel::executeNextAutoUpdate() {
-  if (!qApp->feedUpdateLock()->tryLock()) {
-    qDebug("Delaying scheduled feed auto-updates for one minute due to another running update.");
-
-    // Cannot update, quit.
-    return;
-  }
-
+  // NOTE: Feeds are merged into running update or they wait
+  // for running critical operation, so no pass is skipped.
   // If global auto-update is enabled and its interval counter reached zero,
   // then we need to restore it.
   if (m_globalAutoUpdateEnabled && --m_globalAutoUpdateRemainingInterval < 0) {
@@ -318,11 +444,9 @@ void FeedsModel::executeNextAutoUpdate() {
   // should be updated in this pass.
   QList<Feed*> feeds_for_update = feedsForScheduledUpdate(m_globalAutoUpdateEnabled && m_globalAutoUpdateRemainingInterval == 0);
 
-  qApp->feedUpdateLock()->unlock();
-
   if (!feeds_for_update.isEmpty()) {
     // Request update for given feeds.
-    updateFeeds(feeds_for_update);
+    updateFeeds(feeds_for_update, false);
 
     // NOTE: OSD/bubble informing about performing
     // of scheduled update can be shown now.
@@ -557,8 +681,10 @@ QList<Feed*> FeedsModel::feedsForScheduledUpdate(bool auto_update_now) {
   return feeds_for_update;
 }
 
-QList<Message> FeedsModel::messagesForItem(RootItem *item) const {
-  return item->undeletedMessages();
+QList<Message> FeedsModel::messagesForItem(RootItem *item, MessagesCursor &more_messages) const {
+  more_messages = item->undeletedMessagesCursor();
+  return DatabaseQueries::fetchNextMessages(qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings),
+                                            more_messages, NEWSPAPER_PAGE_SIZE);
 }
 
 int FeedsModel::columnCount(const QModelIndex &parent) const {
@@ -582,23 +708,13 @@ QModelIndex FeedsModel::indexForItem(const RootItem *item) const {
     return QModelIndex();
   }
 
-  QStack<const RootItem*> chain;
-
-  while (item->kind() != RootItemKind::Root) {
-    chain.push(item);
-    item = item->parent();
-  }
-
-  // Now, we have complete chain list: parent --- ..... --- parent --- leaf (item).
-  QModelIndex target_index = indexForItem(m_rootItem);
-
-  // We go through the stack and create our target index.
-  while (!chain.isEmpty()) {
-    const RootItem *parent_item = chain.pop();
-    target_index = index(parent_item->parent()->childItems().indexOf(const_cast<RootItem* const>(parent_item)), 0, target_index);
+  else if (item->parent() == nullptr) {
+    // Item is not placed in the model.
+    return QModelIndex();
   }
 
-  return target_index;
+  // Items know their rows, so the index can be created directly.
+  return createIndex(item->row(), 0, const_cast<RootItem*>(item));
 }
 
 bool FeedsModel::hasAnyFeedNewMessages() const {
@@ -616,12 +732,18 @@ bool FeedsModel::isFeedUpdateRunning() const {
 }
 
 void FeedsModel::reloadChangedLayout(QModelIndexList list) {
+  // Items often share their parents, each
+  // item is notified only once.
+  QSet<QModelIndex> notified_indexes;
+
   while (!list.isEmpty()) {
     QModelIndex indx = list.takeFirst();
 
-    if (indx.isValid()) {
+    if (indx.isValid() && !notified_indexes.contains(indx)) {
       QModelIndex indx_parent = indx.parent();
 
+      notified_indexes.insert(indx);
+
       // Underlying data are changed.
       emit dataChanged(index(indx.row(), 0, indx_parent), index(indx.row(), FDS_MODEL_COUNTS_INDEX, indx_parent));
 
@@ -642,6 +764,41 @@ void FeedsModel::notifyWithCounts() {
 }
 
 void FeedsModel::onItemDataChanged(const QList<RootItem *> &items) {
+  if (m_feedUpdateRunning) {
+    // Each updated feed reports its change separately, changes are
+    // coalesced so that GUI is not repainted for each feed.
+    foreach (RootItem *item, items) {
+      m_coalescedItems.append(item);
+    }
+
+    if (!m_coalescedItemsTimer->isActive()) {
+      m_coalescedItemsTimer->start();
+    }
+  }
+  else {
+    reloadChangedItems(items);
+  }
+}
+
+void FeedsModel::reloadCoalescedItems() {
+  QList<RootItem*> items;
+  QSet<RootItem*> unique_items;
+
+  foreach (const QPointer<RootItem> &item, m_coalescedItems) {
+    if (!item.isNull() && !unique_items.contains(item.data())) {
+      unique_items.insert(item.data());
+      items.append(item.data());
+    }
+  }
+
+  m_coalescedItems.clear();
+
+  if (!items.isEmpty()) {
+    reloadChangedItems(items);
+  }
+}
+
+void FeedsModel::reloadChangedItems(const QList<RootItem*> &items) {
   if (items.size() > RELOAD_MODEL_BORDER_NUM) {
     qDebug("There is request to reload feed model for more than %d items, reloading model fully.", RELOAD_MODEL_BORDER_NUM);
     reloadWholeLayout();
@@ -649,9 +806,14 @@ void FeedsModel::onItemDataChanged(const QList<RootItem *> &items) {
   else {
     qDebug("There is request to reload feed model, reloading the %d items individually.", items.size());
 
+    QModelIndexList changed_indexes;
+    changed_indexes.reserve(items.size());
+
     foreach (RootItem *item, items) {
-      reloadChangedItem(item);
+      changed_indexes.append(indexForItem(item));
     }
+
+    reloadChangedLayout(changed_indexes);
   }
 
   notifyWithCounts();
@@ -676,6 +838,7 @@ bool FeedsModel::addServiceAccount(ServiceRoot *root, bool freshly_activated) {
   connect(root, SIGNAL(reloadMessageListRequested(bool)), this, SIGNAL(reloadMessageListRequested(bool)));
   connect(root, SIGNAL(itemExpandRequested(QList<RootItem*>,bool)), this, SIGNAL(itemExpandRequested(QList<RootItem*>,bool)));
   connect(root, SIGNAL(itemExpandStateSaveRequested(RootItem*)), this, SIGNAL(itemExpandStateSaveRequested(RootItem*)));
+  connect(root, SIGNAL(pendingChangesRecorded()), this, SLOT(schedulePendingChangesPush()));
 
   root->start(freshly_activated);
   return true;
@@ -710,6 +873,18 @@ bool FeedsModel::emptyAllBins() {
 }
 
 void FeedsModel::loadActivatedServiceAccounts() {
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  QElapsedTimer load_timer;
+  int moved_icons = 0;
+
+  load_timer.start();
+
+  // Icons stored by older versions are moved to icon store
+  // first, so that all icons can be loaded lazily.
+  if (DatabaseQueries::moveIconsToStore(database, &moved_icons) && moved_icons > 0) {
+    qDebug("Moved %d embedded icons to icon store in %lld ms.", moved_icons, load_timer.restart());
+  }
+
   // Iterate all globally available feed "service plugins".
   foreach (const ServiceEntryPoint *entry_point, qApp->feedServices()) {
     // Load all stored root nodes from the entry point and add those to the model.
@@ -720,10 +895,123 @@ void FeedsModel::loadActivatedServiceAccounts() {
     }
   }
 
+  qDebug("Loaded %d feeds of all accounts in %lld ms.", m_rootItem->getSubTreeFeeds().size(), load_timer.elapsed());
+
   if (qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::FeedsUpdateOnStartup)).toBool()) {
     qDebug("Requesting update for all feeds on application startup.");
     QTimer::singleShot(STARTUP_UPDATE_DELAY, this, SLOT(updateAllFeeds()));
   }
+
+  if (qApp->settings()->value(GROUP(Database), SETTING(Database::CompressMessageContents)).toBool() &&
+      !qApp->settings()->value(GROUP(Database), SETTING(Database::MessageContentsCompressed)).toBool()) {
+    qDebug("Requesting compression of stored messages on application startup.");
+    QTimer::singleShot(STARTUP_COMPRESSION_DELAY, this, SLOT(compressMessageContents()));
+  }
+
+  // Archive database is available only for SQLite backends.
+  if (qApp->database()->activeDatabaseDriver() != DatabaseFactory::MYSQL) {
+    QTimer::singleShot(STARTUP_ARCHIVING_DELAY, this, SLOT(archiveOldMessages()));
+    m_archivingTimer->start();
+  }
+
+  // Changes which were not pushed before application was closed.
+  schedulePendingChangesPush();
+}
+
+void FeedsModel::compressMessageContents() {
+  // Cleaner lives in its own thread, compression is done there.
+  QMetaObject::invokeMethod(databaseCleaner(), "compressMessageContents", Qt::QueuedConnection);
+}
+
+void FeedsModel::onContentsCompressionFinished(bool result, qint64 saved_bytes) {
+  if (result) {
+    qDebug("Contents of all stored messages are compressed now, %lld bytes saved.", saved_bytes);
+    qApp->settings()->setValue(GROUP(Database), Database::MessageContentsCompressed, true);
+  }
+  else {
+    qWarning("Compression of stored messages was not finished, it will be resumed on next startup.");
+  }
+}
+
+void FeedsModel::archiveOldMessages() {
+  const int days = qApp->settings()->value(GROUP(Database), SETTING(Database::ArchiveMessagesOlderThan)).toInt();
+
+  if (days <= 0) {
+    return;
+  }
+
+  // Messages cannot be moved while feeds are updated or items are
+  // removed, archiving waits until running critical operation finishes.
+  if (!qApp->feedUpdateLock()->tryLock()) {
+    qDebug("Delaying archiving of old messages due to another running critical operation.");
+    connect(qApp->feedUpdateLock(), SIGNAL(unlocked()), this, SLOT(archiveOldMessages()),
+            (Qt::ConnectionType) (Qt::UniqueConnection | Qt::QueuedConnection));
+    return;
+  }
+
+  disconnect(qApp->feedUpdateLock(), SIGNAL(unlocked()), this, SLOT(archiveOldMessages()));
+
+  // Cleaner lives in its own thread, archiving is done there.
+  QMetaObject::invokeMethod(databaseCleaner(), "archiveMessages", Qt::QueuedConnection, Q_ARG(int, days));
+}
+
+void FeedsModel::onArchivingFinished(bool result) {
+  qApp->feedUpdateLock()->unlock();
+
+  if (result) {
+    qDebug("Old messages were moved to archive database.");
+  }
+  else {
+    qWarning("Archiving of old messages failed, it will be retried in %d hours.", ARCHIVING_INTERVAL / 3600000);
+  }
+
+  // Archived messages are not displayed in message list anymore.
+  reloadCountsOfWholeModel();
+  emit reloadMessageListRequested(false);
+}
+
+void FeedsModel::schedulePendingChangesPush() {
+  // Changes are collected for a while, so that they are pushed in batches.
+  if (!m_pendingChangesTimer->isActive()) {
+    m_pendingChangesTimer->start(PENDING_CHANGES_DELAY);
+  }
+}
+
+void FeedsModel::pushPendingChanges() {
+  // Accounts cannot be removed while changes are pushed. Dedicated lock is used,
+  // so that feed updates and other critical operations do not wait for network.
+  if (!qApp->pendingChangesLock()->tryLock()) {
+    qDebug("Delaying push of pending changes due to another running push or removal of account.");
+    m_pendingChangesTimer->start(PENDING_CHANGES_DELAY);
+    return;
+  }
+
+  if (m_changesSender == nullptr) {
+    m_changesSender = new PendingChangesSender();
+    m_changesSenderThread = new QThread();
+
+    // Sender setup.
+    qRegisterMetaType<QList<ServiceRoot*> >("QList<ServiceRoot*>");
+    m_changesSender->moveToThread(m_changesSenderThread);
+
+    connect(this, SIGNAL(pendingChangesPushRequested(QList<ServiceRoot*>)), m_changesSender, SLOT(pushChanges(QList<ServiceRoot*>)));
+    connect(m_changesSenderThread, SIGNAL(finished()), m_changesSenderThread, SLOT(deleteLater()));
+    connect(m_changesSender, SIGNAL(changesPushed(bool)), this, SLOT(onPendingChangesPushed(bool)));
+
+    // Connections are made, start the sender thread.
+    m_changesSenderThread->start();
+  }
+
+  emit pendingChangesPushRequested(serviceRoots());
+}
+
+void FeedsModel::onPendingChangesPushed(bool result) {
+  qApp->pendingChangesLock()->unlock();
+
+  if (!result && !m_pendingChangesTimer->isActive()) {
+    qWarning("Some pending changes were not pushed, next attempt in %d seconds.", PENDING_CHANGES_RETRY_INTERVAL / 1000);
+    m_pendingChangesTimer->start(PENDING_CHANGES_RETRY_INTERVAL);
+  }
 }
 
 void FeedsModel::stopRunningFeedUpdate() {
@@ -20,11 +20,14 @@
 
 #include <QAbstractItemModel>
 
+#include <QPointer>
+
 #include "core/message.h"
 #include "core/feeddownloader.h"
 #include "services/abstract/rootitem.h"
 
 class DatabaseCleaner;
+class PendingChangesSender;
 class Category;
 class Feed;
 class ServiceRoot;
@@ -99,10 +102,11 @@ class FeedsModel : public QAbstractItemModel {
     // This method might change some properties of some feeds.
     QList<Feed*> feedsForScheduledUpdate(bool auto_update_now);
 
-    // Returns (undeleted) messages for given feeds.
+    // Returns first page of (undeleted) messages for given feeds,
+    // cursor is set up to read remaining messages.
     // This is usually used for displaying whole feeds
     // in "newspaper" mode.
-    QList<Message> messagesForItem(RootItem *item) const;
+    QList<Message> messagesForItem(RootItem *item, MessagesCursor &more_messages) const;
 
     // Returns ALL RECURSIVE CHILD feeds contained within single index.
     QList<Feed*> feedsForIndex(const QModelIndex &index) const;
@@ -134,8 +138,10 @@ class FeedsModel : public QAbstractItemModel {
     // Does necessary job before quitting this component.
     void quit();
 
-    // Schedules given feeds for update.
-    void updateFeeds(const QList<Feed*> &feeds);
+    // Schedules given feeds for update. Feeds are merged into
+    // running update or they wait until running critical operation
+    // finishes, so no update request is rejected.
+    void updateFeeds(const QList<Feed*> &feeds, bool user_requested = true);
 
     // Adds given service root account.
     bool addServiceAccount(ServiceRoot *root, bool freshly_activated);
@@ -183,13 +189,32 @@ class FeedsModel : public QAbstractItemModel {
   private slots:
     void onItemDataChanged(const QList<RootItem*> &items);
 
+    // Displays changes of items which were coalesced during feed update.
+    void reloadCoalescedItems();
+
     // Is executed when next auto-update round could be done.
     void executeNextAutoUpdate();
 
     // Reacts on feed updates.
     void onFeedUpdatesStarted();
     void onFeedUpdatesProgress(const Feed *feed, int current, int total);
-    void onFeedUpdatesFinished(const FeedDownloadResults &results);
+    void onFeedUpdatesFinished(const FeedDownloadResults &results, int requests);
+
+    // Starts update of feeds which waited for another critical operation.
+    void startQueuedFeedUpdates();
+
+    // Compresses contents of stored messages in the background.
+    void compressMessageContents();
+    void onContentsCompressionFinished(bool result, qint64 saved_bytes);
+
+    // Moves old read messages to archive database in the background.
+    void archiveOldMessages();
+    void onArchivingFinished(bool result);
+
+    // Pushes changes of messages made in online accounts in the background.
+    void schedulePendingChangesPush();
+    void pushPendingChanges();
+    void onPendingChangesPushed(bool result);
 
   signals:
     // Update of feeds is finished.
@@ -198,7 +223,10 @@ class FeedsModel : public QAbstractItemModel {
     void feedsUpdateStarted();
 
     // Emitted when model requests update of some feeds.
-    void feedsUpdateRequested(QList<Feed*> feeds);
+    void feedsUpdateRequested(QList<Feed*> feeds, bool user_requested);
+
+    // Emitted when model requests push of pending changes of given accounts.
+    void pendingChangesPushRequested(QList<ServiceRoot*> roots);
 
     // Emitted if counts of messages are changed.
     void messageCountsChanged(int unread_messages, int total_messages, bool any_feed_has_unread_messages);
@@ -218,6 +246,13 @@ class FeedsModel : public QAbstractItemModel {
     void requireItemValidationAfterDragDrop(const QModelIndex &source_index);
 
   private:
+    void reloadChangedItems(const QList<RootItem*> &items);
+
+    // Hands given feeds over to feed downloader, update lock must be held.
+    void requestFeedsUpdate(const QList<Feed*> &feeds, bool user_requested);
+    void queueFeedsUpdate(const QList<Feed*> &feeds, bool user_requested);
+    static QList<Feed*> takeQueuedFeeds(QList<QPointer<Feed> > &queue);
+
     RootItem *m_rootItem;
     QList<QString> m_headerData;
     QList<QString> m_tooltipData;
@@ -232,8 +267,27 @@ class FeedsModel : public QAbstractItemModel {
     QThread *m_feedDownloaderThread;
     FeedDownloader *m_feedDownloader;
 
+    // Count of update requests handed over to feed downloader
+    // and not finished yet. Update lock is held while it is positive.
+    int m_feedUpdateRequests;
+
+    // Feeds which wait for another critical operation to finish.
+    QList<QPointer<Feed> > m_queuedUserFeeds;
+    QList<QPointer<Feed> > m_queuedScheduledFeeds;
+
+    // Items changed during feed update are displayed at most
+    // once per FEED_UPDATE_PROGRESS_INTERVAL.
+    bool m_feedUpdateRunning;
+    QTimer *m_coalescedItemsTimer;
+    QList<QPointer<RootItem> > m_coalescedItems;
+
     QThread *m_dbCleanerThread;
     DatabaseCleaner *m_dbCleaner;
+    QTimer *m_archivingTimer;
+
+    QTimer *m_pendingChangesTimer;
+    QThread *m_changesSenderThread;
+    PendingChangesSender *m_changesSender;
 };
 
 #endif // FEEDSMODEL_H
@@ -28,7 +28,8 @@
 
 
 FeedsProxyModel::FeedsProxyModel(QObject *parent)
-  : QSortFilterProxyModel(parent), m_selectedItem(nullptr), m_showUnreadOnly(false), m_hiddenIndices(QList<QPair<int,QModelIndex> >()) {
+  : QSortFilterProxyModel(parent), m_selectedItem(nullptr), m_filterChanged(false), m_sortFilterSuspended(false),
+    m_showUnreadOnly(false) {
   m_sourceModel = new FeedsModel(this);
 
   setObjectName(QSL("FeedsProxyModel"));
@@ -39,6 +40,13 @@ FeedsProxyModel::FeedsProxyModel(QObject *parent)
   setFilterRole(Qt::EditRole);
   setDynamicSortFilter(true);
   setSourceModel(m_sourceModel);
+
+  connect(m_sourceModel, SIGNAL(feedsUpdateStarted()), this, SLOT(suspendSortFilter()));
+  connect(m_sourceModel, SIGNAL(feedsUpdateFinished()), this, SLOT(resumeSortFilter()));
+  connect(m_sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), this, SLOT(onSourceDataChanged(QModelIndex,QModelIndex)));
+  connect(m_sourceModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+          this, SLOT(onSourceRowsAboutToBeRemoved(QModelIndex,int,int)));
+  connect(m_sourceModel, SIGNAL(modelReset()), this, SLOT(onSourceModelReset()));
 }
 
 FeedsProxyModel::~FeedsProxyModel() {
@@ -154,7 +162,7 @@ bool FeedsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right
       }
       else {
         // In other cases, sort by title.
-        return QString::localeAwareCompare(left_item->title(), right_item->title()) < 0;
+        return left_item->titleSortKey().compare(right_item->titleSortKey()) < 0;
       }
     }
     else if (left_item->kind() == RootItemKind::Bin) {
@@ -183,40 +191,38 @@ bool FeedsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right
 }
 
 bool FeedsProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const {
-  bool should_show = filterAcceptsRowInternal(source_row, source_parent);
-
-  if (should_show && m_hiddenIndices.contains(QPair<int,QModelIndex>(source_row, source_parent))) {
-    const_cast<FeedsProxyModel*>(this)->m_hiddenIndices.removeAll(QPair<int,QModelIndex>(source_row, source_parent));
+  const QModelIndex idx = m_sourceModel->index(source_row, 0, source_parent);
 
-    // Load status.
-    emit expandAfterFilterIn(m_sourceModel->index(source_row, 0, source_parent));
+  if (!idx.isValid()) {
+    return false;
   }
 
-  if (!should_show) {
-    const_cast<FeedsProxyModel*>(this)->m_hiddenIndices.append(QPair<int,QModelIndex>(source_row, source_parent));
+  const RootItem *item = m_sourceModel->itemForIndex(idx);
+  const bool should_show = filterAcceptsRowInternal(item, source_row, source_parent);
+
+  if (should_show) {
+    if (const_cast<FeedsProxyModel*>(this)->m_hiddenItems.remove(item)) {
+      // Load status.
+      emit expandAfterFilterIn(idx);
+    }
+  }
+  else {
+    const_cast<FeedsProxyModel*>(this)->m_hiddenItems.insert(item);
   }
 
   return should_show;
 }
 
-bool FeedsProxyModel::filterAcceptsRowInternal(int source_row, const QModelIndex &source_parent) const {
+bool FeedsProxyModel::filterAcceptsRowInternal(const RootItem *item, int source_row, const QModelIndex &source_parent) const {
   if (!m_showUnreadOnly) {
     return QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
   }
 
-  const QModelIndex idx = m_sourceModel->index(source_row, 0, source_parent);
-
-  if (!idx.isValid()) {
-    return false;
-  }
-
-  const RootItem *item = m_sourceModel->itemForIndex(idx);
-
   if (item->kind() == RootItemKind::Bin || item->kind() == RootItemKind::ServiceRoot) {
     // Recycle bin is always displayed.
     return true;
   }
-  else if (item->isParentOf(m_selectedItem)/* || item->isChildOf(m_selectedItem)*/ || m_selectedItem == item) {
+  else if (m_selectedItemAncestors.contains(item)) {
     // Currently selected item and all its parents and children must be displayed.
     return true;
   }
@@ -232,7 +238,27 @@ const RootItem *FeedsProxyModel::selectedItem() const {
 }
 
 void FeedsProxyModel::setSelectedItem(const RootItem *selected_item) {
+  if (m_selectedItem == selected_item) {
+    return;
+  }
+
+  // Previously selected item and its parents may need to be hidden now,
+  // they are re-evaluated together with their parents.
+  if (m_selectedIndex.isValid()) {
+    m_pendingIndexes.insert(m_selectedIndex);
+  }
+  else if (m_selectedItem != nullptr) {
+    // Previously selected item is not in the model anymore.
+    m_filterChanged = true;
+  }
+
   m_selectedItem = selected_item;
+  m_selectedItemAncestors.clear();
+  m_selectedIndex = selected_item != nullptr ? m_sourceModel->indexForItem(selected_item) : QModelIndex();
+
+  for (const RootItem *item = selected_item; item != nullptr; item = item->parent()) {
+    m_selectedItemAncestors.insert(item);
+  }
 }
 
 bool FeedsProxyModel::showUnreadOnly() const {
@@ -242,6 +268,7 @@ bool FeedsProxyModel::showUnreadOnly() const {
 void FeedsProxyModel::invalidateReadFeedsFilter(bool set_new_value, bool show_unread_only) {
   if (set_new_value) {
     setShowUnreadOnly(show_unread_only);
+    m_filterChanged = true;
   }
 
   QTimer::singleShot(0, this, SLOT(invalidateFilter()));
@@ -263,5 +290,80 @@ QModelIndexList FeedsProxyModel::mapListToSource(const QModelIndexList &indexes)
 }
 
 void FeedsProxyModel::invalidateFilter() {
-  QSortFilterProxyModel::invalidateFilter();
+  if (m_sortFilterSuspended) {
+    // Filter is applied once sorting and filtering is resumed.
+    return;
+  }
+
+  if (m_filterChanged) {
+    m_filterChanged = false;
+    m_pendingIndexes.clear();
+    QSortFilterProxyModel::invalidateFilter();
+    return;
+  }
+
+  QModelIndexList changed_indexes;
+
+  if (m_showUnreadOnly) {
+    foreach (const QPersistentModelIndex &index, m_pendingIndexes) {
+      if (index.isValid()) {
+        changed_indexes.append(index);
+      }
+    }
+  }
+
+  m_pendingIndexes.clear();
+
+  // Rows of other items are re-evaluated by dynamic filtering when their
+  // data (counts of unread messages) change, so only rows of changed
+  // items and their parents are filtered here.
+  if (!changed_indexes.isEmpty()) {
+    m_sourceModel->reloadChangedLayout(changed_indexes);
+  }
+}
+
+void FeedsProxyModel::suspendSortFilter() {
+  m_sortFilterSuspended = true;
+  setDynamicSortFilter(false);
+}
+
+void FeedsProxyModel::resumeSortFilter() {
+  if (!m_sortFilterSuspended) {
+    return;
+  }
+
+  m_sortFilterSuspended = false;
+
+  // Whole model is sorted once here and then rows which
+  // were changed in the meantime are filtered.
+  setDynamicSortFilter(true);
+  invalidateFilter();
+}
+
+void FeedsProxyModel::onSourceDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right) {
+  if (m_sortFilterSuspended) {
+    for (int row = top_left.row(); row <= bottom_right.row(); row++) {
+      m_pendingIndexes.insert(m_sourceModel->index(row, 0, top_left.parent()));
+    }
+  }
+}
+
+void FeedsProxyModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last) {
+  if (m_hiddenItems.isEmpty()) {
+    return;
+  }
+
+  for (int row = first; row <= last; row++) {
+    const RootItem *removed_item = m_sourceModel->itemForIndex(m_sourceModel->index(row, 0, parent));
+
+    if (removed_item != nullptr) {
+      foreach (const RootItem *item, removed_item->getSubTree()) {
+        m_hiddenItems.remove(item);
+      }
+    }
+  }
+}
+
+void FeedsProxyModel::onSourceModelReset() {
+  m_hiddenItems.clear();
 }
@@ -20,6 +20,8 @@
 
 #include <QSortFilterProxyModel>
 
+#include <QSet>
+
 
 class FeedsModel;
 class RootItem;
@@ -54,8 +56,20 @@ class FeedsProxyModel : public QSortFilterProxyModel {
     void invalidateReadFeedsFilter(bool set_new_value = false, bool show_unread_only = false);
 
   private slots:
+    // Re-evaluates rows whose visibility could change since last
+    // filtering, whole model is filtered again only if filter itself changed.
     void invalidateFilter();
 
+    // Sorting and filtering of changed rows is suspended while feeds are
+    // updated and both are applied at once when update finishes.
+    void suspendSortFilter();
+    void resumeSortFilter();
+    void onSourceDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right);
+
+    // Forgets removed items, so that hidden items do not refer to deleted ones.
+    void onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceModelReset();
+
   signals:
     void expandAfterFilterIn(QModelIndex idx) const;
 
@@ -63,13 +77,21 @@ class FeedsProxyModel : public QSortFilterProxyModel {
     // Compares two rows of data.
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
     bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
-    bool filterAcceptsRowInternal(int source_row, const QModelIndex &source_parent) const;
+    bool filterAcceptsRowInternal(const RootItem *item, int source_row, const QModelIndex &source_parent) const;
 
     // Source model pointer.
     FeedsModel *m_sourceModel;
     const RootItem *m_selectedItem;
+
+    // Selected item and all its parents, they are always displayed.
+    QSet<const RootItem*> m_selectedItemAncestors;
+    QPersistentModelIndex m_selectedIndex;
+    QSet<QPersistentModelIndex> m_pendingIndexes;
+    bool m_filterChanged;
+    bool m_sortFilterSuspended;
+
     bool m_showUnreadOnly;
-    QList<QPair<int,QModelIndex> > m_hiddenIndices;
+    QSet<const RootItem*> m_hiddenItems;
 };
 
 #endif // FEEDSPROXYMODEL_H
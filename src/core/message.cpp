@@ -20,13 +20,14 @@
 #include "miscellaneous/textfactory.h"
 
 #include <QVariant>
+#include <QtEndian>
 
 
 Enclosure::Enclosure(const QString &url, const QString &mime) : m_url(url), m_mimeType(mime) {
 }
 
-QList<Enclosure> Enclosures::decodeEnclosuresFromString(const QString &enclosures_data) {
-  QList<Enclosure> enclosures;
+QVector<Enclosure> Enclosures::decodeEnclosuresFromString(const QString &enclosures_data) {
+  QVector<Enclosure> enclosures;
 
   foreach (const QString &single_enclosure, enclosures_data.split(ENCLOSURES_OUTER_SEPARATOR, QString::SkipEmptyParts)) {
     Enclosure enclosure;
@@ -47,7 +48,7 @@ QList<Enclosure> Enclosures::decodeEnclosuresFromString(const QString &enclosure
   return enclosures;
 }
 
-QString Enclosures::encodeEnclosuresToString(const QList<Enclosure> &enclosures) {
+QString Enclosures::encodeEnclosuresToString(const QVector<Enclosure> &enclosures) {
   QStringList enclosures_str;
 
   foreach (const Enclosure &enclosure, enclosures) {
@@ -66,9 +67,10 @@ QString Enclosures::encodeEnclosuresToString(const QList<Enclosure> &enclosures)
 
 Message::Message() {
   m_title = m_url = m_author = m_contents = m_feedId = m_customId = m_customHash = "";
-  m_enclosures = QList<Enclosure>();
+  m_enclosures = QVector<Enclosure>();
+  m_created = 0;
   m_accountId = m_id = 0;
-  m_isRead = m_isImportant = false;
+  m_isRead = m_isImportant = m_createdFromFeed = m_isArchived = false;
 }
 
 Message Message::fromSqlRecord(const QSqlRecord &record, bool *result) {
@@ -88,8 +90,8 @@ Message Message::fromSqlRecord(const QSqlRecord &record, bool *result) {
   message.m_title = record.value(MSG_DB_TITLE_INDEX).toString();
   message.m_url = record.value(MSG_DB_URL_INDEX).toString();
   message.m_author = record.value(MSG_DB_AUTHOR_INDEX).toString();
-  message.m_created = TextFactory::parseDateTime(record.value(MSG_DB_DCREATED_INDEX).value<qint64>());
-  message.m_contents = record.value(MSG_DB_CONTENTS_INDEX).toString();
+  message.m_created = record.value(MSG_DB_DCREATED_INDEX).value<qint64>();
+  message.m_contents = decompressContents(record.value(MSG_DB_CONTENTS_INDEX).toString());
   message.m_enclosures = Enclosures::decodeEnclosuresFromString(record.value(MSG_DB_ENCLOSURES_INDEX).toString());
   message.m_accountId = record.value(MSG_DB_ACCOUNT_ID_INDEX).toInt();
   message.m_customId = record.value(MSG_DB_CUSTOM_ID_INDEX).toString();
@@ -101,3 +103,92 @@ Message Message::fromSqlRecord(const QSqlRecord &record, bool *result) {
 
   return message;
 }
+
+quint64 Message::identityHash() const {
+  QByteArray identity;
+
+  if (m_customId.isEmpty()) {
+    identity.append(m_title.toUtf8()).append('\0').append(m_url.toUtf8()).append('\0').append(m_author.toUtf8());
+  }
+  else {
+    identity.append(m_customId.toUtf8());
+  }
+
+  return TextFactory::hash64(identity);
+}
+
+quint64 Message::fingerprint() const {
+  QByteArray state = QByteArray::number(identityHash());
+
+  // See DatabaseQueries::updateMessages() for list of attributes which
+  // are checked when deciding if message should be updated.
+  if (!m_customId.isEmpty()) {
+    state.append('\0').append(QByteArray::number(m_created))
+         .append('\0').append(m_isRead ? '1' : '0')
+         .append('\0').append(m_isImportant ? '1' : '0');
+  }
+  else if (m_createdFromFeed) {
+    state.append('\0').append(QByteArray::number(m_created));
+  }
+
+  return TextFactory::hash64(state);
+}
+
+QString Message::compressContents(const QString &contents) {
+  if (contents.size() < CONTENTS_COMPRESSION_THRESHOLD || contents.startsWith(QL1S(CONTENTS_COMPRESSED_PREFIX))) {
+    return contents;
+  }
+
+  const QByteArray contents_data = contents.toUtf8();
+  const QString compressed = QL1S(CONTENTS_COMPRESSED_PREFIX) + QString::fromLatin1(qCompress(contents_data).toBase64());
+
+  // Store compressed form only if it is really smaller.
+  return compressed.size() < contents_data.size() ? compressed : contents;
+}
+
+QString Message::decompressContents(const QString &stored_contents) {
+  if (!stored_contents.startsWith(QL1S(CONTENTS_COMPRESSED_PREFIX))) {
+    return stored_contents;
+  }
+
+  const QByteArray data = QByteArray::fromBase64(stored_contents.mid(int(qstrlen(CONTENTS_COMPRESSED_PREFIX))).toLatin1());
+  return QString::fromUtf8(qUncompress(data));
+}
+
+int Message::uncompressedContentsSize(const QString &stored_contents) {
+  if (!stored_contents.startsWith(QL1S(CONTENTS_COMPRESSED_PREFIX))) {
+    return -1;
+  }
+
+  // Data produced by qCompress() start with 4-byte big-endian size
+  // of uncompressed data, which fits into first 8 base64 characters.
+  const QByteArray header = QByteArray::fromBase64(stored_contents.mid(int(qstrlen(CONTENTS_COMPRESSED_PREFIX)), 8).toLatin1());
+
+  if (header.size() < 4) {
+    return -1;
+  }
+
+  return qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(header.constData()));
+}
+
+QString MessageStringPool::intern(const QString &string) {
+  if (string.isEmpty()) {
+    // Null and empty strings are not shared, so that they remain distinguishable.
+    return string;
+  }
+
+  QSet<QString>::const_iterator existing = m_strings.constFind(string);
+
+  if (existing != m_strings.constEnd()) {
+    return *existing;
+  }
+  else {
+    m_strings.insert(string);
+    return string;
+  }
+}
+
+MessagesCursor::MessagesCursor(const QString &condition, const QVariantHash &bindings, bool include_archived, Columns columns)
+  : m_condition(condition), m_bindings(bindings), m_includeArchived(include_archived), m_columns(columns), m_inArchive(false),
+    m_atEnd(condition.isEmpty()), m_lastCreated(0), m_lastId(-1) {
+}
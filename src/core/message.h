@@ -23,6 +23,9 @@
 #include <QDateTime>
 #include <QStringList>
 #include <QSqlRecord>
+#include <QVariantHash>
+#include <QVector>
+#include <QSet>
 
 
 // Represents single enclosure.
@@ -34,11 +37,26 @@ struct Enclosure {
     QString m_mimeType;
 };
 
+Q_DECLARE_TYPEINFO(Enclosure, Q_MOVABLE_TYPE);
+
 // Represents single enclosure.
 class Enclosures {
   public:
-    static QList<Enclosure> decodeEnclosuresFromString(const QString &enclosures_data);
-    static QString encodeEnclosuresToString(const QList<Enclosure> &enclosures);
+    static QVector<Enclosure> decodeEnclosuresFromString(const QString &enclosures_data);
+    static QString encodeEnclosuresToString(const QVector<Enclosure> &enclosures);
+};
+
+// Shares equal strings among messages of single batch, so that
+// values which repeat a lot (feed IDs, authors, MIME types of
+// enclosures) are held in memory only once.
+class MessageStringPool {
+  public:
+    // Returns copy of given string which shares data
+    // with equal strings returned before.
+    QString intern(const QString &string);
+
+  private:
+    QSet<QString> m_strings;
 };
 
 // Represents single message.
@@ -50,11 +68,33 @@ class Message {
     // row from query SELECT * FROM Messages WHERE ....;
     static Message fromSqlRecord(const QSqlRecord &record, bool *result = NULL);
 
+    // Returns hash which identifies this message within its feed.
+    // NOTE: Message is identified by its custom ID, if it has some,
+    // otherwise by its title, URL and author.
+    quint64 identityHash() const;
+
+    // Returns hash of message identity and of all attributes which,
+    // when changed, cause the stored message to be updated.
+    quint64 fingerprint() const;
+
+    // Converts message contents to the form which is stored in DB.
+    // Contents are compressed only if it saves some space.
+    static QString compressContents(const QString &contents);
+
+    // Returns original message contents from their stored form.
+    static QString decompressContents(const QString &stored_contents);
+
+    // Returns size (in bytes) of original contents, if given stored
+    // contents are compressed, otherwise returns -1.
+    static int uncompressedContentsSize(const QString &stored_contents);
+
     QString m_title;
     QString m_url;
     QString m_author;
     QString m_contents;
-    QDateTime m_created;
+
+    // Creation date in milliseconds since epoch.
+    qint64 m_created;
     QString m_feedId;
     int m_accountId;
     int m_id;
@@ -64,11 +104,57 @@ class Message {
     bool m_isRead;
     bool m_isImportant;
 
-    QList<Enclosure> m_enclosures;
+    QVector<Enclosure> m_enclosures;
 
     // Is true if "created" date was obtained directly
     // from the feed, otherwise is false
     bool m_createdFromFeed;
+
+    // Is true if message was read from archive database.
+    // NOTE: Archived messages are read-only and their IDs are
+    // negated, so that they never match IDs of live messages.
+    bool m_isArchived;
+};
+
+// Describes position of forward-only reading of stored messages,
+// which are read in chunks from newest to oldest.
+// See DatabaseQueries::fetchNextMessages().
+struct MessagesCursor {
+  public:
+    // Columns which are read only if requested, columns which
+    // are not requested are empty in returned messages.
+    // NOTE: IDs, states, dates and custom IDs/hashes are read always.
+    enum Column {
+      NoExtraColumns    = 0,
+      TextColumns       = 1,    // Title, url and author.
+      ContentsColumn    = 2,
+      EnclosuresColumn  = 4,
+      AllColumns        = TextColumns | ContentsColumn | EnclosuresColumn
+    };
+
+    Q_DECLARE_FLAGS(Columns, Column)
+
+    // Cursor with empty condition does not return any messages.
+    explicit MessagesCursor(const QString &condition = QString(), const QVariantHash &bindings = QVariantHash(),
+                            bool include_archived = false, Columns columns = AllColumns);
+
+    inline bool atEnd() const {
+      return m_atEnd;
+    }
+
+    QString m_condition;
+    QVariantHash m_bindings;
+    bool m_includeArchived;
+    Columns m_columns;
+
+    // Current position, messages older than (m_lastCreated, m_lastId)
+    // are returned next.
+    bool m_inArchive;
+    bool m_atEnd;
+    qint64 m_lastCreated;
+    int m_lastId;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(MessagesCursor::Columns)
+
 #endif // MESSAGE_H
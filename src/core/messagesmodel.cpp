@@ -25,11 +25,26 @@
 #include "gui/dialogs/formmain.h"
 #include "services/abstract/serviceroot.h"
 #include "miscellaneous/databasequeries.h"
+#include "core/messagesreadmarker.h"
+
+#include <QTimer>
+#include <QSet>
+#include <QThread>
+#include <QSqlDriver>
+#include <QSqlField>
 
 
 MessagesModel::MessagesModel(QObject *parent)
   : QSqlTableModel(parent, qApp->database()->connection(QSL("MessagesModel"), DatabaseFactory::FromSettings)),
-    m_messageHighlighter(NoHighlighting), m_customDateFormat(QString()) {
+    m_messageHighlighter(NoHighlighting), m_sortOrder(Qt::AscendingOrder), m_itemFilter(QString()),
+    m_searchPattern(QString()), m_searchArchive(false), m_customDateFormat(QString()), m_selectedItem(nullptr),
+    m_readQueueTimer(new QTimer(this)), m_readQueue(QList<Message>()), m_readQueueItem(nullptr),
+    m_readQueueStatus(RootItem::Read), m_markedBatches(QQueue<QPair<QPointer<RootItem>,QList<Message> > >()),
+    m_readMarker(nullptr), m_readMarkerThread(nullptr) {
+  m_readQueueTimer->setSingleShot(true);
+  m_readQueueTimer->setInterval(MESSAGES_READ_QUEUE_DELAY);
+  connect(m_readQueueTimer, SIGNAL(timeout()), this, SLOT(sendQueuedMessagesRead()));
+
   setupFonts();
   setupIcons();
   setupHeaderData();
@@ -53,12 +68,40 @@ void MessagesModel::setupIcons() {
   m_unreadIcon = qApp->icons()->fromTheme(QSL("mail-mark-unread"));
 }
 
-void MessagesModel::fetchAllData() {
+void MessagesModel::repopulate() {
+  const int loaded_rows = rowCount();
+
+  // Make sure that reloaded data contain queued changes.
+  finishQuery();
+  flushQueuedMessagesRead();
   select();
 
+  while (rowCount() < loaded_rows && canFetchMore()) {
+    fetchMore();
+  }
+}
+
+int MessagesModel::messageRow(int id) {
+  for (int i = 0; i < rowCount(); i++) {
+    if (messageId(i) == id) {
+      return i;
+    }
+  }
+
+  // Message can be among rows which are not fetched yet.
   while (canFetchMore()) {
+    const int fetched_rows = rowCount();
+
     fetchMore();
+
+    for (int i = fetched_rows; i < rowCount(); i++) {
+      if (messageId(i) == id) {
+        return i;
+      }
+    }
   }
+
+  return -1;
 }
 
 void MessagesModel::setupFonts() {
@@ -85,7 +128,149 @@ void MessagesModel::loadMessages(RootItem *item) {
     }
   }
 
-  fetchAllData();
+  // Service root sets filter of the item, search pattern is added to it.
+  m_itemFilter = filter();
+  setFilter(messagesFilter());
+  updateArchiveSearch();
+
+  // Only first rows are fetched now, others are fetched
+  // when they are displayed.
+  finishQuery();
+  flushQueuedMessagesRead();
+  select();
+}
+
+void MessagesModel::setSearchPattern(const QString &pattern) {
+  if (m_searchPattern == pattern) {
+    return;
+  }
+
+  m_searchPattern = pattern;
+  setFilter(messagesFilter());
+  updateArchiveSearch();
+
+  finishQuery();
+  flushQueuedMessagesRead();
+  select();
+}
+
+void MessagesModel::finishQuery() {
+  // Statement of the model stays open until all its rows are fetched. It is
+  // closed before queued changes are written, so that writing does not wait
+  // for lock held by the statement which is going to be replaced anyway.
+  query().finish();
+}
+
+QString MessagesModel::messagesFilter() const {
+  if (m_searchPattern.isEmpty() || m_itemFilter.isEmpty()) {
+    return m_itemFilter;
+  }
+
+  // Pattern is matched as plain text, wildcards of LIKE are escaped.
+  QString like_pattern = m_searchPattern;
+  QSqlField like_field(QString(), QVariant::String);
+
+  like_pattern.replace(QL1C('!'), QL1S("!!")).replace(QL1C('%'), QL1S("!%")).replace(QL1C('_'), QL1S("!_"));
+  like_field.setValue(QL1S("%") + like_pattern + QL1S("%"));
+
+  const QString like_literal = database().driver()->formatValue(like_field);
+
+  // Compressed contents cannot be matched by the database, messages
+  // with them are matched later in the model.
+  QSqlField compressed_field(QString(), QVariant::String);
+
+  compressed_field.setValue(QL1S(CONTENTS_COMPRESSED_PREFIX) + QL1S("%"));
+
+  const QString compressed_literal = database().driver()->formatValue(compressed_field);
+
+  return QString(QSL("(%1) AND (title LIKE %2 ESCAPE '!' OR url LIKE %2 ESCAPE '!' OR author LIKE %2 ESCAPE '!' OR "
+                     "contents LIKE %2 ESCAPE '!' OR contents LIKE %3)")).arg(m_itemFilter, like_literal, compressed_literal);
+}
+
+void MessagesModel::updateArchiveSearch() {
+  // Archived messages are searched only if user wants to see them,
+  // recycle bin never contains them.
+  m_searchArchive = !m_searchPattern.isEmpty() && !m_itemFilter.isEmpty() &&
+                    m_selectedItem != nullptr && m_selectedItem->kind() != RootItemKind::Bin &&
+                    qApp->settings()->value(GROUP(Messages), SETTING(Messages::ShowArchivedMessages)).toBool() &&
+                    qApp->database()->attachArchiveDatabase(database(), false);
+}
+
+bool MessagesModel::matchesSearchPattern(int row) const {
+  if (m_searchPattern.isEmpty()) {
+    return true;
+  }
+
+  if (messageId(row) >= 0 &&
+      !QSqlTableModel::data(index(row, MSG_DB_CONTENTS_INDEX)).toString().startsWith(QL1S(CONTENTS_COMPRESSED_PREFIX))) {
+    // Message was already matched by the database.
+    return true;
+  }
+
+  return QSqlTableModel::data(index(row, MSG_DB_TITLE_INDEX)).toString().contains(m_searchPattern, Qt::CaseInsensitive) ||
+         QSqlTableModel::data(index(row, MSG_DB_URL_INDEX)).toString().contains(m_searchPattern, Qt::CaseInsensitive) ||
+         QSqlTableModel::data(index(row, MSG_DB_AUTHOR_INDEX)).toString().contains(m_searchPattern, Qt::CaseInsensitive) ||
+         messageContents(row).contains(m_searchPattern, Qt::CaseInsensitive);
+}
+
+QString MessagesModel::messageContents(int row_index) const {
+  const QVariant stored_contents = QSqlTableModel::data(index(row_index, MSG_DB_CONTENTS_INDEX));
+
+  if (messageId(row_index) < 0) {
+    // Contents of archived messages are stored compressed.
+    return QString::fromUtf8(qUncompress(stored_contents.toByteArray()));
+  }
+  else {
+    return Message::decompressContents(stored_contents.toString());
+  }
+}
+
+void MessagesModel::setSort(int column, Qt::SortOrder order) {
+  m_sortOrder = order;
+  QSqlTableModel::setSort(column, order);
+}
+
+void MessagesModel::sort(int column, Qt::SortOrder order) {
+  setSort(column, order);
+  repopulate();
+}
+
+QString MessagesModel::selectStatement() const {
+  if (!m_searchArchive) {
+    return QSqlTableModel::selectStatement();
+  }
+
+  // Live and archived messages are read by single statement. Archived messages
+  // get negated IDs, like in newspaper view. Only item filter is applied to them,
+  // their contents are compressed and they are matched in the model.
+  const QSqlRecord columns = record();
+  QStringList live_columns;
+  QStringList archived_columns;
+
+  for (int i = 0; i < columns.count(); i++) {
+    const QString column = database().driver()->escapeIdentifier(columns.fieldName(i), QSqlDriver::FieldName);
+
+    live_columns.append(column);
+    archived_columns.append(i == MSG_DB_ID_INDEX ? QString(QSL("-%1 AS %1")).arg(column) : column);
+  }
+
+  return QString(QSL("SELECT * FROM (SELECT %1 FROM Messages WHERE %2 UNION ALL "
+                     "SELECT %3 FROM archive.Messages WHERE %4) AS Messages %5")).arg(live_columns.join(QSL(", ")),
+                                                                                     filter(),
+                                                                                     archived_columns.join(QSL(", ")),
+                                                                                     m_itemFilter,
+                                                                                     orderByClause());
+}
+
+QString MessagesModel::orderByClause() const {
+  const QString order_by = QSqlTableModel::orderByClause();
+
+  if (order_by.isEmpty()) {
+    return order_by;
+  }
+  else {
+    return order_by + (m_sortOrder == Qt::AscendingOrder ? QSL(", id ASC") : QSL(", id DESC"));
+  }
 }
 
 bool MessagesModel::setMessageImportantById(int id, RootItem::Importance important) {
@@ -113,8 +298,11 @@ bool MessagesModel::submitAll() {
 
 void MessagesModel::highlightMessages(MessagesModel::MessageHighlighter highlight) {
   m_messageHighlighter = highlight;
-  emit layoutAboutToBeChanged();
-  emit layoutChanged();
+
+  // Only colors of rows change, there is no need to relayout them.
+  if (rowCount() > 0) {
+    emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1), QVector<int>() << Qt::ForegroundRole);
+  }
 }
 
 int MessagesModel::messageId(int row_index) const {
@@ -143,8 +331,33 @@ void MessagesModel::reloadWholeLayout() {
   emit layoutChanged();
 }
 
-Message MessagesModel::messageAt(int row_index) const { 
-  return Message::fromSqlRecord(record(row_index));
+Message MessagesModel::messageAt(int row_index, MessagesCursor::Columns columns) const {
+  QSqlRecord message_record = record(row_index);
+  const bool is_archived = message_record.value(MSG_DB_ID_INDEX).toInt() < 0;
+
+  // Columns which were not requested are not decoded, contents of
+  // archived messages are decompressed only if requested.
+  if (!columns.testFlag(MessagesCursor::TextColumns)) {
+    message_record.setNull(MSG_DB_TITLE_INDEX);
+    message_record.setNull(MSG_DB_URL_INDEX);
+    message_record.setNull(MSG_DB_AUTHOR_INDEX);
+  }
+
+  if (!columns.testFlag(MessagesCursor::ContentsColumn)) {
+    message_record.setNull(MSG_DB_CONTENTS_INDEX);
+  }
+  else if (is_archived) {
+    message_record.setValue(MSG_DB_CONTENTS_INDEX, messageContents(row_index));
+  }
+
+  if (!columns.testFlag(MessagesCursor::EnclosuresColumn)) {
+    message_record.setNull(MSG_DB_ENCLOSURES_INDEX);
+  }
+
+  Message message = Message::fromSqlRecord(message_record);
+
+  message.m_isArchived = is_archived;
+  return message;
 }
 
 void MessagesModel::setupHeaderData() {
@@ -204,6 +417,11 @@ QVariant MessagesModel::data(const QModelIndex &idx, int role) const {
 
         return author_name.isEmpty() ? "-" : author_name;
       }
+      else if (index_column == MSG_DB_CONTENTS_INDEX) {
+        // Contents are decompressed only when really needed, for example
+        // when message is displayed.
+        return messageContents(idx.row());
+      }
       else if (index_column != MSG_DB_IMPORTANT_INDEX && index_column != MSG_DB_READ_INDEX) {
         return QSqlTableModel::data(idx, role);
       }
@@ -257,7 +475,15 @@ bool MessagesModel::setMessageRead(int row_index, RootItem::ReadStatus read) {
     return true;
   }
 
-  Message message = messageAt(row_index);
+  if (messageId(row_index) < 0) {
+    // Archived messages are read-only.
+    return false;
+  }
+
+  // Queued changes must not overwrite this one later.
+  flushQueuedMessagesRead();
+
+  Message message = messageAt(row_index, MessagesCursor::NoExtraColumns);
 
   if (!m_selectedItem->getParentServiceRoot()->onBeforeSetMessagesRead(m_selectedItem, QList<Message>() << message, read)) {
     // Cannot change read status of the item. Abort.
@@ -281,6 +507,137 @@ bool MessagesModel::setMessageRead(int row_index, RootItem::ReadStatus read) {
   }
 }
 
+void MessagesModel::queueMessageRead(int row_index, RootItem::ReadStatus read) {
+  if (m_selectedItem == nullptr || messageId(row_index) < 0 || data(row_index, MSG_DB_READ_INDEX, Qt::EditRole).toInt() == read) {
+    return;
+  }
+
+  if (!m_readQueue.isEmpty() && (m_readQueueItem != m_selectedItem || m_readQueueStatus != read)) {
+    // Each batch contains messages of single item with the same status.
+    sendQueuedMessagesRead();
+  }
+
+  m_readQueue.append(messageAt(row_index, MessagesCursor::NoExtraColumns));
+  m_readQueueItem = m_selectedItem;
+  m_readQueueStatus = read;
+
+  // Rewrite "visible" data in the model now, so that user
+  // sees the change immediately.
+  setData(index(row_index, MSG_DB_READ_INDEX), read);
+
+  if (m_readQueue.size() >= MESSAGES_READ_QUEUE_BATCH) {
+    sendQueuedMessagesRead();
+  }
+  else {
+    m_readQueueTimer->start();
+  }
+}
+
+void MessagesModel::flushQueuedMessagesRead() {
+  if (!m_readQueue.isEmpty() || !m_markedBatches.isEmpty()) {
+    // Batches are processed in order, so once this one is
+    // processed, all batches sent before are processed too.
+    sendQueuedMessagesRead(Qt::BlockingQueuedConnection);
+  }
+}
+
+void MessagesModel::quit() {
+  flushQueuedMessagesRead();
+
+  if (m_readMarkerThread != nullptr && m_readMarkerThread->isRunning()) {
+    qDebug("Quitting messages read marker thread.");
+    m_readMarkerThread->quit();
+
+    if (!m_readMarkerThread->wait(CLOSE_LOCK_TIMEOUT)) {
+      qCritical("Messages read marker thread is running despite it was told to quit. Terminating it.");
+      m_readMarkerThread->terminate();
+    }
+  }
+}
+
+void MessagesModel::sendQueuedMessagesRead() {
+  sendQueuedMessagesRead(Qt::QueuedConnection);
+}
+
+void MessagesModel::sendQueuedMessagesRead(Qt::ConnectionType connection_type) {
+  m_readQueueTimer->stop();
+
+  if (m_readMarker == nullptr) {
+    m_readMarker = new MessagesReadMarker();
+    m_readMarkerThread = new QThread();
+
+    qRegisterMetaType<RootItem::ReadStatus>("RootItem::ReadStatus");
+    m_readMarker->moveToThread(m_readMarkerThread);
+
+    connect(m_readMarkerThread, SIGNAL(finished()), m_readMarkerThread, SLOT(deleteLater()));
+    connect(m_readMarkerThread, SIGNAL(finished()), m_readMarker, SLOT(deleteLater()));
+    connect(m_readMarker, SIGNAL(messagesMarked(QStringList,RootItem::ReadStatus,bool)),
+            this, SLOT(onQueuedMessagesMarked(QStringList,RootItem::ReadStatus,bool)));
+
+    m_readMarkerThread->start();
+  }
+
+  const QList<Message> messages = m_readQueue;
+  QStringList message_ids;
+
+  m_readQueue.clear();
+
+  if (!messages.isEmpty()) {
+    if (m_readQueueItem.isNull()) {
+      // Item was removed meanwhile, together with its messages.
+      qWarning("Dropping %d queued read changes of removed item.", messages.size());
+    }
+    // Online services are notified first (in this thread), messages
+    // are not marked in DB if they refuse the change.
+    else if (!m_readQueueItem->getParentServiceRoot()->onBeforeSetMessagesRead(m_readQueueItem.data(), messages, m_readQueueStatus)) {
+      restoreMessagesRead(messages, m_readQueueStatus == RootItem::Read ? RootItem::Unread : RootItem::Read);
+    }
+    else {
+      foreach (const Message &message, messages) {
+        message_ids.append(QString::number(message.m_id));
+      }
+
+      m_markedBatches.enqueue(QPair<QPointer<RootItem>,QList<Message> >(m_readQueueItem, messages));
+    }
+  }
+
+  // Empty batch is sent too, blocking call then waits for previous batches.
+  QMetaObject::invokeMethod(m_readMarker, "markMessagesRead", connection_type,
+                            Q_ARG(QStringList, message_ids),
+                            Q_ARG(RootItem::ReadStatus, m_readQueueStatus));
+}
+
+void MessagesModel::onQueuedMessagesMarked(const QStringList &message_ids, RootItem::ReadStatus read, bool result) {
+  Q_UNUSED(message_ids)
+
+  const QPair<QPointer<RootItem>,QList<Message> > batch = m_markedBatches.dequeue();
+
+  if (result) {
+    // Item might have been removed meanwhile.
+    if (!batch.first.isNull()) {
+      batch.first->getParentServiceRoot()->onAfterSetMessagesRead(batch.first.data(), batch.second, read);
+    }
+  }
+  else {
+    // Changes were not written to DB, show original state again.
+    restoreMessagesRead(batch.second, read == RootItem::Read ? RootItem::Unread : RootItem::Read);
+  }
+}
+
+void MessagesModel::restoreMessagesRead(const QList<Message> &messages, RootItem::ReadStatus read) {
+  QSet<int> message_ids;
+
+  foreach (const Message &message, messages) {
+    message_ids.insert(message.m_id);
+  }
+
+  for (int i = 0; i < rowCount() && !message_ids.isEmpty(); i++) {
+    if (message_ids.remove(data(i, MSG_DB_ID_INDEX, Qt::EditRole).toInt()) && setData(index(i, MSG_DB_READ_INDEX), read)) {
+      emit dataChanged(index(i, 0), index(i, MSG_DB_CUSTOM_HASH_INDEX));
+    }
+  }
+}
+
 bool MessagesModel::setMessageReadById(int id, RootItem::ReadStatus read) {
   for (int i = 0; i < rowCount(); i++) {
     int found_id = data(i, MSG_DB_ID_INDEX, Qt::EditRole).toInt();
@@ -300,11 +657,16 @@ bool MessagesModel::setMessageReadById(int id, RootItem::ReadStatus read) {
 }
 
 bool MessagesModel::switchMessageImportance(int row_index) {
+  if (messageId(row_index) < 0) {
+    // Archived messages are read-only.
+    return false;
+  }
+
   const QModelIndex target_index = index(row_index, MSG_DB_IMPORTANT_INDEX);
   const RootItem::Importance current_importance = (RootItem::Importance) data(target_index, Qt::EditRole).toInt();
   const RootItem::Importance next_importance = current_importance == RootItem::Important ?
                                                  RootItem::NotImportant : RootItem::Important;
-  const Message message = messageAt(row_index);
+  const Message message = messageAt(row_index, MessagesCursor::NoExtraColumns);
   const QPair<Message,RootItem::Importance> pair(message, next_importance);
 
   if (!m_selectedItem->getParentServiceRoot()->onBeforeSwitchMessageImportance(m_selectedItem,
@@ -337,7 +699,12 @@ bool MessagesModel::switchBatchMessageImportance(const QModelIndexList &messages
 
   // Obtain IDs of all desired messages.
   foreach (const QModelIndex &message, messages) {
-    const Message msg = messageAt(message.row());
+    const Message msg = messageAt(message.row(), MessagesCursor::NoExtraColumns);
+
+    if (msg.m_isArchived) {
+      continue;
+    }
+
     RootItem::Importance message_importance = messageImportance((message.row()));
 
     message_states.append(QPair<Message,RootItem::Importance>(msg, message_importance == RootItem::Important ?
@@ -351,7 +718,7 @@ bool MessagesModel::switchBatchMessageImportance(const QModelIndexList &messages
   }
 
   if (DatabaseQueries::switchMessagesImportance(database(), message_ids)) {
-    fetchAllData();
+    repopulate();
     return m_selectedItem->getParentServiceRoot()->onAfterSwitchMessageImportance(m_selectedItem, message_states);
   }
   else {
@@ -363,12 +730,14 @@ bool MessagesModel::setBatchMessagesDeleted(const QModelIndexList &messages) {
   QStringList message_ids;
   QList<Message> msgs;
 
-  // Obtain IDs of all desired messages.
+  // Obtain IDs of all desired messages, archived ones are read-only.
   foreach (const QModelIndex &message, messages) {
-    const Message msg = messageAt(message.row());
+    const Message msg = messageAt(message.row(), MessagesCursor::NoExtraColumns);
 
-    msgs.append(msg);
-    message_ids.append(QString::number(msg.m_id));
+    if (!msg.m_isArchived) {
+      msgs.append(msg);
+      message_ids.append(QString::number(msg.m_id));
+    }
   }
 
   if (!m_selectedItem->getParentServiceRoot()->onBeforeMessagesDelete(m_selectedItem, msgs)) {
@@ -385,7 +754,7 @@ bool MessagesModel::setBatchMessagesDeleted(const QModelIndexList &messages) {
   }
 
   if (deleted) {
-    fetchAllData();
+    repopulate();
     return m_selectedItem->getParentServiceRoot()->onAfterMessagesDelete(m_selectedItem, msgs);
   }
   else {
@@ -397,12 +766,17 @@ bool MessagesModel::setBatchMessagesRead(const QModelIndexList &messages, RootIt
   QStringList message_ids;
   QList<Message> msgs;
 
-  // Obtain IDs of all desired messages.
+  // Queued changes must not overwrite these ones later.
+  flushQueuedMessagesRead();
+
+  // Obtain IDs of all desired messages, archived ones are read-only.
   foreach (const QModelIndex &message, messages) {
-    Message msg = messageAt(message.row());
+    Message msg = messageAt(message.row(), MessagesCursor::NoExtraColumns);
 
-    msgs.append(msg);
-    message_ids.append(QString::number(msg.m_id));
+    if (!msg.m_isArchived) {
+      msgs.append(msg);
+      message_ids.append(QString::number(msg.m_id));
+    }
   }
 
   if (!m_selectedItem->getParentServiceRoot()->onBeforeSetMessagesRead(m_selectedItem, msgs, read)) {
@@ -410,7 +784,7 @@ bool MessagesModel::setBatchMessagesRead(const QModelIndexList &messages, RootIt
   }
 
   if (DatabaseQueries::markMessagesReadUnread(database(), message_ids, read)) {
-    fetchAllData();
+    repopulate();
     return m_selectedItem->getParentServiceRoot()->onAfterSetMessagesRead(m_selectedItem, msgs, read);
   }
   else {
@@ -424,7 +798,7 @@ bool MessagesModel::setBatchMessagesRestored(const QModelIndexList &messages) {
 
   // Obtain IDs of all desired messages.
   foreach (const QModelIndex &message, messages) {
-    const Message msg = messageAt(message.row());
+    const Message msg = messageAt(message.row(), MessagesCursor::NoExtraColumns);
 
     msgs.append(msg);
     message_ids.append(QString::number(msg.m_id));
@@ -435,7 +809,7 @@ bool MessagesModel::setBatchMessagesRestored(const QModelIndexList &messages) {
   }
 
   if (DatabaseQueries::deleteOrRestoreMessagesToFromBin(database(), message_ids, false)) {
-    fetchAllData();
+    repopulate();
     return m_selectedItem->getParentServiceRoot()->onAfterMessagesRestoredFromBin(m_selectedItem, msgs);
   }
   else {
@@ -26,8 +26,14 @@
 #include <QSqlTableModel>
 #include <QFont>
 #include <QIcon>
+#include <QPointer>
+#include <QQueue>
 
 
+class QTimer;
+class QThread;
+class MessagesReadMarker;
+
 class MessagesModel : public QSqlTableModel {
     Q_OBJECT
 
@@ -50,8 +56,12 @@ class MessagesModel : public QSqlTableModel {
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
     Qt::ItemFlags flags(const QModelIndex &index) const;
 
-    // Returns message at given index.
-    Message messageAt(int row_index) const;
+    // Returns message at given index, only given columns
+    // are read, see MessagesCursor::Column.
+    Message messageAt(int row_index, MessagesCursor::Columns columns = MessagesCursor::AllColumns) const;
+
+    // Returns decompressed contents of message at given index.
+    QString messageContents(int row_index) const;
     int messageId(int row_index) const;
     RootItem::Importance messageImportance(int row_index) const;
 
@@ -67,6 +77,17 @@ class MessagesModel : public QSqlTableModel {
     bool switchMessageImportance(int row_index);
     bool setMessageRead(int row_index, RootItem::ReadStatus read);
 
+    // Changes read status of message in the model immediately, change
+    // is written to the database later in background, together
+    // with other queued changes.
+    void queueMessageRead(int row_index, RootItem::ReadStatus read);
+
+    // Writes all queued read changes, returns when they are written.
+    void flushQueuedMessagesRead();
+
+    // Writes queued changes and stops background thread.
+    void quit();
+
     // BATCH messages manipulators.
     // NOTE: These methods are used for changing of attributes of
     // many messages via DIRECT SQL calls.
@@ -77,8 +98,14 @@ class MessagesModel : public QSqlTableModel {
     bool setBatchMessagesRead(const QModelIndexList &messages, RootItem::ReadStatus read);
     bool setBatchMessagesRestored(const QModelIndexList &messages);
 
-    // Fetches ALL available data to the model.
-    void fetchAllData();
+    // Reloads messages from the database. At least as many rows
+    // as were loaded before are fetched, so that rows of selected
+    // messages stay valid. Other rows are fetched when needed.
+    void repopulate();
+
+    // Returns row of message with given ID or -1 if the message is not loaded.
+    // NOTE: Rows are fetched until the message is found or all rows are fetched.
+    int messageRow(int id);
 
     // Filters messages
     void highlightMessages(MessageHighlighter highlight);
@@ -86,22 +113,54 @@ class MessagesModel : public QSqlTableModel {
     // Loads messages of given feeds.
     void loadMessages(RootItem *item);
 
+    // Shows only messages whose title, url, author or contents contain given text.
+    // NOTE: Messages are filtered by the database, not in the model. Only messages
+    // with compressed contents are matched by matchesSearchPattern().
+    // NOTE: If archived messages are shown, archive database is searched too.
+    void setSearchPattern(const QString &pattern);
+    bool matchesSearchPattern(int row) const;
+
+    void setSort(int column, Qt::SortOrder order);
+    void sort(int column, Qt::SortOrder order);
+
   public slots:
     // NOTE: These methods DO NOT actually change data in the DB, just in the model.
     // These are particularly used by msg browser.
     bool setMessageImportantById(int id, RootItem::Importance important);
     bool setMessageReadById(int id, RootItem::ReadStatus read);
 
+  protected:
+    // Includes archived messages when they are searched.
+    QString selectStatement() const;
+
+    // Messages with the same value in sort column are ordered by their IDs,
+    // so that messages are always returned in the same order.
+    QString orderByClause() const;
+
   private slots:
     // To disable persistent changes submissions.
     bool submitAll();
 
+    void sendQueuedMessagesRead();
+    void onQueuedMessagesMarked(const QStringList &message_ids, RootItem::ReadStatus read, bool result);
+
   private:
     void setupHeaderData();
     void setupFonts();
     void setupIcons();
+    void sendQueuedMessagesRead(Qt::ConnectionType connection_type);
+
+    // Restores read status of given messages in the model only.
+    void restoreMessagesRead(const QList<Message> &messages, RootItem::ReadStatus read);
+    QString messagesFilter() const;
+    void updateArchiveSearch();
+    void finishQuery();
 
     MessageHighlighter m_messageHighlighter;
+    Qt::SortOrder m_sortOrder;
+    QString m_itemFilter;
+    QString m_searchPattern;
+    bool m_searchArchive;
 
     QString m_customDateFormat;
     RootItem *m_selectedItem;
@@ -114,6 +173,16 @@ class MessagesModel : public QSqlTableModel {
     QIcon m_favoriteIcon;
     QIcon m_readIcon;
     QIcon m_unreadIcon;
+
+    QTimer *m_readQueueTimer;
+    QList<Message> m_readQueue;
+    QPointer<RootItem> m_readQueueItem;
+    RootItem::ReadStatus m_readQueueStatus;
+
+    // Items and messages of batches which are being written.
+    QQueue<QPair<QPointer<RootItem>,QList<Message> > > m_markedBatches;
+    MessagesReadMarker *m_readMarker;
+    QThread *m_readMarkerThread;
 };
 
 Q_DECLARE_METATYPE(MessagesModel::MessageHighlighter)
@@ -27,9 +27,6 @@ MessagesProxyModel::MessagesProxyModel(QObject *parent)
   setObjectName(QSL("MessagesProxyModel"));
   setSortRole(Qt::EditRole);
   setSortCaseSensitivity(Qt::CaseInsensitive);
-  setFilterCaseSensitivity(Qt::CaseInsensitive);
-  setFilterKeyColumn(-1);
-  setFilterRole(Qt::EditRole);
   setDynamicSortFilter(false);
   setSourceModel(m_sourceModel);
 }
@@ -42,6 +39,14 @@ QModelIndex MessagesProxyModel::getNextPreviousUnreadItemIndex(int default_row)
   const bool started_from_zero = default_row == 0;
   QModelIndex next_index = getNextUnreadItemIndex(default_row, rowCount() - 1);
 
+  // Messages which are not fetched yet are searched too.
+  while (!next_index.isValid() && m_sourceModel->canFetchMore()) {
+    const int fetched_rows = rowCount();
+
+    m_sourceModel->fetchMore();
+    next_index = getNextUnreadItemIndex(fetched_rows, rowCount() - 1);
+  }
+
   // There is no next message, check previous.
   if (!next_index.isValid() && !started_from_zero) {
     next_index = getNextUnreadItemIndex(0, default_row - 1);
@@ -77,6 +82,12 @@ bool MessagesProxyModel::lessThan(const QModelIndex &left, const QModelIndex &ri
   return false;
 }
 
+bool MessagesProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const {
+  Q_UNUSED(source_parent)
+
+  return m_sourceModel->matchesSearchPattern(source_row);
+}
+
 QModelIndexList MessagesProxyModel::mapListFromSource(const QModelIndexList &indexes, bool deep) const {
   QModelIndexList mapped_indexes;
 
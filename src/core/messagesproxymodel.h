@@ -53,6 +53,9 @@ class MessagesProxyModel : public QSortFilterProxyModel {
     // Compares two rows of data.
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
 
+    // Hides messages with compressed contents which do not match search pattern.
+    bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
+
     // Source model pointer.
     MessagesModel *m_sourceModel;
 };
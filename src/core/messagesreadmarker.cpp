@@ -0,0 +1,51 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "core/messagesreadmarker.h"
+
+#include "miscellaneous/application.h"
+#include "miscellaneous/databasefactory.h"
+#include "miscellaneous/databasequeries.h"
+
+#include <QThread>
+
+
+MessagesReadMarker::MessagesReadMarker(QObject *parent) : QObject(parent) {
+}
+
+MessagesReadMarker::~MessagesReadMarker() {
+  qDebug("Destroying MessagesReadMarker instance.");
+}
+
+void MessagesReadMarker::markMessagesRead(const QStringList &message_ids, RootItem::ReadStatus read) {
+  if (message_ids.isEmpty()) {
+    return;
+  }
+
+  qDebug().nospace() << "Marking " << message_ids.size() << " messages in thread: \'" << QThread::currentThreadId() << "\'.";
+
+  const bool result = DatabaseQueries::markMessagesReadUnread(qApp->database()->connection(metaObject()->className(),
+                                                                                           DatabaseFactory::FromSettings),
+                                                              message_ids, read);
+
+  if (!result) {
+    qWarning("Marking of %d messages failed.", message_ids.size());
+  }
+
+  emit messagesMarked(message_ids, read, result);
+}
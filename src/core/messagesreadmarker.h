@@ -0,0 +1,48 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef MESSAGESREADMARKER_H
+#define MESSAGESREADMARKER_H
+
+#include <QObject>
+#include <QStringList>
+
+#include "services/abstract/rootitem.h"
+
+
+// Writes read status of messages into DB in separate thread,
+// so that GUI does not wait for it. Online services are notified
+// by the caller in GUI thread.
+class MessagesReadMarker : public QObject {
+    Q_OBJECT
+
+  public:
+    // Constructors and destructors.
+    explicit MessagesReadMarker(QObject *parent = 0);
+    virtual ~MessagesReadMarker();
+
+  public slots:
+    // Marks messages with given IDs. Batches are
+    // processed in the same order in which they were sent.
+    void markMessagesRead(const QStringList &message_ids, RootItem::ReadStatus read);
+
+  signals:
+    void messagesMarked(const QStringList &message_ids, RootItem::ReadStatus read, bool result);
+};
+
+#endif // MESSAGESREADMARKER_H
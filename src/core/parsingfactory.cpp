@@ -22,15 +22,121 @@
 
 #include <QDomDocument>
 #include <QDomElement>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QAtomicInt>
 
+#include <cstdlib>
+#include <new>
+
+
+// Allocations made via operator new are counted while parsing
+// benchmark runs. Atomics are initialized statically, because
+// allocations can happen before any constructor is called.
+static QBasicAtomicInt s_countingAllocations = Q_BASIC_ATOMIC_INITIALIZER(0);
+static QBasicAtomicInt s_countedAllocations = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+void *operator new(std::size_t size) {
+  if (s_countingAllocations.load() != 0) {
+    s_countedAllocations.ref();
+  }
+
+  void *pointer = std::malloc(size == 0 ? 1 : size);
+
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return pointer;
+}
+
+void *operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *pointer) Q_DECL_NOTHROW {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer) Q_DECL_NOTHROW {
+  std::free(pointer);
+}
 
 ParsingFactory::ParsingFactory() {
 }
 
+void ParsingFactory::benchmarkParsing(int message_count) {
+  if (message_count <= 0) {
+    message_count = PARSING_BENCHMARK_MESSAGES;
+  }
+
+  // Generated feed has only few distinct authors, just like real feeds.
+  QString data = QSL("<?xml version=\"1.0\" encoding=\"UTF-8\"?><rss version=\"2.0\"><channel><title>Benchmark</title>");
+
+  for (int i = 0; i < message_count; i++) {
+    data.append(QString(QSL("<item><title>Benchmark message %1</title><link>http://example.com/messages/%1</link>"
+                            "<author>Author %2</author><pubDate>Mon, 17 Oct 2016 10:00:00 +0000</pubDate>"
+                            "<description>&lt;p&gt;Contents of generated message %1.&lt;/p&gt;</description>"
+                            "<enclosure url=\"http://example.com/files/%1.mp3\" type=\"audio/mpeg\" length=\"1000\"/>"
+                            "</item>")).arg(QString::number(i), QString::number(i % 10)));
+  }
+
+  data.append(QSL("</channel></rss>"));
+
+  QElapsedTimer timer;
+
+  s_countedAllocations.store(0);
+  s_countingAllocations.store(1);
+  timer.start();
+
+  const QList<Message> messages = parseAsRSS20(data);
+  const qint64 parsing_time = qMax(timer.nsecsElapsed(), Q_INT64_C(1));
+
+  s_countingAllocations.store(0);
+
+  const int allocations = s_countedAllocations.load();
+
+  // Strings which share their data are counted as single buffer.
+  QSet<const QChar*> buffers;
+  qint64 buffers_size = 0;
+  int strings = 0;
+
+  foreach (const Message &message, messages) {
+    QList<const QString*> fields;
+
+    fields << &message.m_title << &message.m_url << &message.m_author << &message.m_contents
+           << &message.m_feedId << &message.m_customId << &message.m_customHash;
+
+    foreach (const Enclosure &enclosure, message.m_enclosures) {
+      fields << &enclosure.m_url << &enclosure.m_mimeType;
+    }
+
+    foreach (const QString *field, fields) {
+      if (!field->isEmpty()) {
+        strings++;
+
+        if (!buffers.contains(field->constData())) {
+          buffers.insert(field->constData());
+          buffers_size += field->capacity() * sizeof(QChar);
+        }
+      }
+    }
+  }
+
+  qDebug("Parsing of %d generated RSS 2.0 messages:", messages.size());
+  qDebug("  %.2f ms, %.0f messages/s, %.1f MB/s.",
+         parsing_time / 1e6, messages.size() * 1e9 / parsing_time, data.size() * sizeof(QChar) * 1e3 / parsing_time);
+  qDebug("  %d allocations via operator new, %.1f per message.",
+         allocations, messages.isEmpty() ? 0.0 : double(allocations) / messages.size());
+  qDebug("  %d strings are held in %d buffers of %.1f kB, %.1f buffers per message.",
+         strings, buffers.size(), buffers_size / 1e3, messages.isEmpty() ? 0.0 : double(buffers.size()) / messages.size());
+}
+
 QList<Message> ParsingFactory::parseAsATOM10(const QString &data) {
   QList<Message> messages;
   QDomDocument xml_file;
-  QDateTime current_time = QDateTime::currentDateTime();
+  const qint64 current_time = QDateTime::currentMSecsSinceEpoch();
+  MessageStringPool strings;
 
   xml_file.setContent(data, true);
 
@@ -74,9 +180,7 @@ QList<Message> ParsingFactory::parseAsATOM10(const QString &data) {
       QDomElement link = elem_links.at(i).toElement();
 
       if (link.attribute(QSL("rel")) == QSL("enclosure")) {
-        new_message.m_enclosures.append(Enclosure(link.attribute(QSL("href")), link.attribute(QSL("type"))));
-
-        qDebug("Adding enclosure '%s' for the message.", qPrintable(new_message.m_enclosures.last().m_url));
+        new_message.m_enclosures.append(Enclosure(link.attribute(QSL("href")), strings.intern(link.attribute(QSL("type")))));
       }
       else {
         new_message.m_url = link.attribute(QSL("href"));
@@ -88,13 +192,16 @@ QList<Message> ParsingFactory::parseAsATOM10(const QString &data) {
     }
 
     // Deal with authors.
-    new_message.m_author = WebFactory::instance()->escapeHtml(message_item.namedItem(QSL("author")).namedItem(QSL("name")).toElement().text());
+    new_message.m_author = strings.intern(WebFactory::instance()->escapeHtml(message_item.namedItem(QSL("author")).namedItem(QSL("name")).toElement().text()));
 
     // Deal with creation date.
-    new_message.m_created = TextFactory::parseDateTime(message_item.namedItem(QSL("updated")).toElement().text());
-    new_message.m_createdFromFeed = !new_message.m_created.isNull();
+    const QDateTime elem_created = TextFactory::parseDateTime(message_item.namedItem(QSL("updated")).toElement().text());
+    new_message.m_createdFromFeed = !elem_created.isNull();
 
-    if (!new_message.m_createdFromFeed) {
+    if (new_message.m_createdFromFeed) {
+      new_message.m_created = elem_created.toMSecsSinceEpoch();
+    }
+    else {
       // Date was NOT obtained from the feed, set current date as creation date for the message.
       new_message.m_created = current_time;
     }
@@ -119,7 +226,8 @@ QList<Message> ParsingFactory::parseAsATOM10(const QString &data) {
 QList<Message> ParsingFactory::parseAsRDF(const QString &data) {
   QList<Message> messages;
   QDomDocument xml_file;
-  QDateTime current_time = QDateTime::currentDateTime();
+  const qint64 current_time = QDateTime::currentMSecsSinceEpoch();
+  MessageStringPool strings;
 
   xml_file.setContent(data, true);
 
@@ -155,7 +263,7 @@ QList<Message> ParsingFactory::parseAsRDF(const QString &data) {
 
     // Deal with link and author.
     new_message.m_url = message_item.namedItem(QSL("link")).toElement().text();
-    new_message.m_author = message_item.namedItem(QSL("creator")).toElement().text();
+    new_message.m_author = strings.intern(message_item.namedItem(QSL("creator")).toElement().text());
 
     // Deal with creation date.
     QString elem_updated = message_item.namedItem(QSL("date")).toElement().text();
@@ -165,10 +273,13 @@ QList<Message> ParsingFactory::parseAsRDF(const QString &data) {
     }
 
     // Deal with creation date.
-    new_message.m_created = TextFactory::parseDateTime(elem_updated);
-    new_message.m_createdFromFeed = !new_message.m_created.isNull();
+    const QDateTime elem_created = TextFactory::parseDateTime(elem_updated);
+    new_message.m_createdFromFeed = !elem_created.isNull();
 
-    if (!new_message.m_createdFromFeed) {
+    if (new_message.m_createdFromFeed) {
+      new_message.m_created = elem_created.toMSecsSinceEpoch();
+    }
+    else {
       // Date was NOT obtained from the feed, set current date as creation date for the message.
       new_message.m_created = current_time;
     }
@@ -190,7 +301,8 @@ QList<Message> ParsingFactory::parseAsRDF(const QString &data) {
 QList<Message> ParsingFactory::parseAsRSS20(const QString &data) {
   QList<Message> messages;
   QDomDocument xml_file;
-  QDateTime current_time = QDateTime::currentDateTime();
+  const qint64 current_time = QDateTime::currentMSecsSinceEpoch();
+  MessageStringPool strings;
 
   xml_file.setContent(data, true);
 
@@ -230,9 +342,7 @@ QList<Message> ParsingFactory::parseAsRSS20(const QString &data) {
     }
 
     if (!elem_enclosure.isEmpty()) {
-      new_message.m_enclosures.append(Enclosure(elem_enclosure, elem_enclosure_type));
-
-      qDebug("Adding enclosure '%s' for the message.", qPrintable(elem_enclosure));
+      new_message.m_enclosures.append(Enclosure(elem_enclosure, strings.intern(elem_enclosure_type)));
     }
 
     // Deal with link and author.
@@ -253,14 +363,19 @@ QList<Message> ParsingFactory::parseAsRSS20(const QString &data) {
       new_message.m_author = message_item.namedItem(QSL("creator")).toElement().text();
     }
 
+    new_message.m_author = strings.intern(new_message.m_author);
+
     // Deal with creation date.
-    new_message.m_created = TextFactory::parseDateTime(message_item.namedItem(QSL("pubDate")).toElement().text());
+    QDateTime elem_created = TextFactory::parseDateTime(message_item.namedItem(QSL("pubDate")).toElement().text());
 
-    if (new_message.m_created.isNull()) {
-      new_message.m_created = TextFactory::parseDateTime(message_item.namedItem(QSL("date")).toElement().text());
+    if (elem_created.isNull()) {
+      elem_created = TextFactory::parseDateTime(message_item.namedItem(QSL("date")).toElement().text());
     }
 
-    if (!(new_message.m_createdFromFeed = !new_message.m_created.isNull())) {
+    if ((new_message.m_createdFromFeed = !elem_created.isNull())) {
+      new_message.m_created = elem_created.toMSecsSinceEpoch();
+    }
+    else {
       // Date was NOT obtained from the feed,
       // set current date as creation date for the message.
       new_message.m_created = current_time;
@@ -42,6 +42,13 @@ class ParsingFactory {
     static QList<Message> parseAsATOM10(const QString &data);
     static QList<Message> parseAsRDF(const QString &data);
     static QList<Message> parseAsRSS20(const QString &data);
+
+    // Parses generated RSS 2.0 feed with given count of messages and logs
+    // parsing throughput, count of allocations done via operator new during
+    // parsing and count and size of string buffers held by parsed messages.
+    // NOTE: Strings allocate their buffers via malloc(), so they are
+    // not included in count of allocations.
+    static void benchmarkParsing(int message_count);
 };
 
 #endif // PARSINGFACTORY_H
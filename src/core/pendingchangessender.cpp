@@ -0,0 +1,45 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#include "core/pendingchangessender.h"
+
+#include "services/abstract/serviceroot.h"
+
+#include <QThread>
+
+
+PendingChangesSender::PendingChangesSender(QObject *parent) : QObject(parent) {
+}
+
+PendingChangesSender::~PendingChangesSender() {
+  qDebug("Destroying PendingChangesSender instance.");
+}
+
+void PendingChangesSender::pushChanges(const QList<ServiceRoot*> &roots) {
+  qDebug().nospace() << "Pushing pending changes of " << roots.size() << " accounts in thread: \'"
+                     << QThread::currentThreadId() << "\'.";
+
+  bool result = true;
+
+  foreach (ServiceRoot *root, roots) {
+    // Changes of other accounts are pushed even if some account
+    // is unreachable, failed changes are pushed again later.
+    result &= root->pushPendingChanges();
+  }
+
+  emit changesPushed(result);
+}
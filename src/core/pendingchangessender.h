@@ -0,0 +1,46 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PENDINGCHANGESSENDER_H
+#define PENDINGCHANGESSENDER_H
+
+#include <QObject>
+
+
+class ServiceRoot;
+
+// Pushes changes of messages recorded in journals of pending
+// changes to online services in separate thread.
+class PendingChangesSender : public QObject {
+    Q_OBJECT
+
+  public:
+    // Constructors and destructors.
+    explicit PendingChangesSender(QObject *parent = 0);
+    virtual ~PendingChangesSender();
+
+  public slots:
+    // Pushes pending changes of all given accounts.
+    void pushChanges(const QList<ServiceRoot*> &roots);
+
+  signals:
+    // Emitted when pushing finishes, "result" is false if
+    // changes of any account could not be pushed.
+    void changesPushed(bool result);
+};
+
+#endif // PENDINGCHANGESSENDER_H
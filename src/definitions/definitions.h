@@ -28,6 +28,12 @@
 
 #define ENCLOSURES_OUTER_SEPARATOR            '#'
 #define ECNLOSURES_INNER_SEPARATOR            '&'
+
+// Message contents which are stored compressed in DB start with this
+// prefix. Only contents longer than threshold are compressed.
+#define CONTENTS_COMPRESSED_PREFIX            "\x1bqz:"
+#define CONTENTS_COMPRESSION_THRESHOLD        512
+#define CONTENTS_COMPRESSION_BATCH_SIZE       500
 #define URI_SCHEME_FEED_SHORT                 "feed:"
 #define URI_SCHEME_FEED                       "feed://"
 #define URI_SCHEME_HTTP                       "http://"
@@ -50,11 +56,35 @@
 #define MESSAGES_VIEW_DEFAULT_COL             170
 #define FEEDS_VIEW_COLUMN_COUNT               2
 #define DEFAULT_DAYS_TO_DELETE_MSG            14
+#define DEFAULT_DAYS_TO_ARCHIVE_MSG           90
 #define ELLIPSIS_LENGTH                       3
 #define MIN_CATEGORY_NAME_LENGTH              1
 #define DEFAULT_AUTO_UPDATE_INTERVAL          15
 #define AUTO_UPDATE_INTERVAL                  60000
 #define STARTUP_UPDATE_DELAY                  30000
+#define STARTUP_COMPRESSION_DELAY             60000
+#define STARTUP_ARCHIVING_DELAY               90000
+#define ARCHIVING_INTERVAL                    86400000
+#define METADATA_PROBES_PARALLEL              12
+#define METADATA_PROBES_PER_HOST              2
+#define METADATA_PROBE_MAX_REDIRECTIONS       5
+#define METADATA_PROBE_MAX_PREFETCH           32768
+#define METADATA_PROBE_MAX_PREFETCH_TOTAL     16777216
+#define PREFETCHED_CONTENTS_VALIDITY          600
+#define ICON_CACHE_PARALLEL_DOWNLOADS         8
+#define WEB_VIEWER_POOL_SIZE                  2
+#define WEB_VIEWER_POOL_REFILL_DELAY          3000
+#define MESSAGES_PREVIEW_DELAY                150
+#define MESSAGES_READ_QUEUE_DELAY             1000
+#define MESSAGES_READ_QUEUE_BATCH             100
+#define MESSAGES_SEARCH_DELAY                 250
+#define PENDING_CHANGES_BATCH                 500
+#define PENDING_CHANGES_DELAY                 2000
+#define PENDING_CHANGES_RETRY_INTERVAL        60000
+#define FEED_UPDATE_PROGRESS_INTERVAL         100
+#define ICON_CACHE_VALIDITY                   604800
+#define ICON_CACHE_NEGATIVE_VALIDITY          86400
+#define ICON_REFERENCE_PREFIX                 "icon:"
 #define TIMEZONE_OFFSET_LIMIT                 6
 #define CHANGE_EVENT_DELAY                    250
 #define FLAG_ICON_SUBFOLDER                   "flags"
@@ -79,6 +109,15 @@
 #define DEFAULT_ZOOM_FACTOR 1.0f
 #define ZOOM_FACTOR_STEP    0.1f
 
+// Count of messages rendered at once in newspaper view.
+#define NEWSPAPER_PAGE_SIZE 20
+
+// Default count of messages rendered by skin rendering benchmark.
+#define SKIN_BENCHMARK_MESSAGES 10000
+
+// Default count of messages parsed by feed parsing benchmark.
+#define PARSING_BENCHMARK_MESSAGES 10000
+
 #define INTERNAL_URL_MESSAGE                  "http://rssguard.message"
 #define INTERNAL_URL_BLANK                    "http://rssguard.blank"
 #define INTERNAL_URL_MESSAGE_HOST             "rssguard.message"
@@ -106,9 +145,22 @@
 #define APP_DB_SQLITE_INIT            "db_init_sqlite.sql"
 #define APP_DB_SQLITE_PATH            "data/database/local"
 #define APP_DB_SQLITE_FILE            "database.db"
+#define APP_DB_SQLITE_ARCHIVE_INIT    "db_init_sqlite_archive.sql"
+#define APP_DB_SQLITE_ARCHIVE_FILE    "archive.db"
+
+#define APP_ICON_CACHE_PATH           "data/icons"
+#define APP_ICON_CACHE_INDEX          "index.json"
+
+// Count of messages moved to archive database in one transaction.
+#define APP_DB_ARCHIVE_BATCH_SIZE     500
+
+// Count of DB pages copied in one step of SQLite online backup
+// and delay between steps of periodic in-memory DB snapshot.
+#define APP_DB_SQLITE_BACKUP_PAGES    256
+#define APP_DB_SQLITE_BACKUP_DELAY    25
 
 // Keep this in sync with schema versions declared in SQL initialization code.
-#define APP_DB_SCHEMA_VERSION         "6"
+#define APP_DB_SCHEMA_VERSION         "9"
 #define APP_DB_UPDATE_FILE_PATTERN    "db_update_%1_%2_%3.sql"
 #define APP_DB_COMMENT_SPLIT          "-- !\n"
 #define APP_DB_WEB_PATH               "data/database/web"
@@ -122,6 +174,10 @@
 
 #define APP_QUIT_INSTANCE   "app_quit"
 #define APP_IS_RUNNING      "app_is_running"
+#define APP_STARTUP_TIMINGS "--startup-timings="
+#define APP_QUIT_AFTER_STARTUP "--quit-after-startup"
+#define APP_BENCHMARK_RENDERING "--benchmark-rendering="
+#define APP_BENCHMARK_PARSING "--benchmark-parsing="
 #define APP_SKIN_DEFAULT    "base/vergilius.xml"
 #define APP_THEME_DEFAULT   "Faenza"
 #define APP_NO_THEME        ""
@@ -20,6 +20,7 @@
 #include "miscellaneous/application.h"
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/databasefactory.h"
+#include "miscellaneous/databasequeries.h"
 
 #include <QCloseEvent>
 
@@ -32,7 +33,9 @@ FormDatabaseCleanup::FormDatabaseCleanup(QWidget *parent) : QDialog(parent), m_u
   setWindowIcon(qApp->icons()->fromTheme(QSL("edit-clear")));
 
   connect(m_ui->m_spinDays, SIGNAL(valueChanged(int)), this, SLOT(updateDaysSuffix(int)));
+  connect(m_ui->m_spinArchiveDays, SIGNAL(valueChanged(int)), this, SLOT(updateArchiveDaysSuffix(int)));
   m_ui->m_spinDays->setValue(DEFAULT_DAYS_TO_DELETE_MSG);
+  m_ui->m_spinArchiveDays->setValue(DEFAULT_DAYS_TO_ARCHIVE_MSG);
   m_ui->m_lblResult->setStatus(WidgetWithStatus::Information, tr("I am ready."), tr("I am ready."));
   loadDatabaseInfo();
 }
@@ -78,6 +81,10 @@ void FormDatabaseCleanup::updateDaysSuffix(int number) {
   m_ui->m_spinDays->setSuffix(tr(" day(s)", 0, number));
 }
 
+void FormDatabaseCleanup::updateArchiveDaysSuffix(int number) {
+  m_ui->m_spinArchiveDays->setSuffix(tr(" day(s)", 0, number));
+}
+
 void FormDatabaseCleanup::startPurging() {
   CleanerOrders orders;
 
@@ -87,6 +94,8 @@ void FormDatabaseCleanup::startPurging() {
   orders.m_removeReadMessages = m_ui->m_checkRemoveReadMessages->isChecked();
   orders.m_shrinkDatabase = m_ui->m_checkShrink->isEnabled() && m_ui->m_checkShrink->isChecked();
   orders.m_removeStarredMessages = m_ui->m_checkRemoveStarredMessages->isChecked();
+  orders.m_archiveOldMessages = m_ui->m_checkArchiveOldMessages->isEnabled() && m_ui->m_checkArchiveOldMessages->isChecked();
+  orders.m_barrierForArchivingOldMessagesInDays = m_ui->m_spinArchiveDays->value();
 
   emit purgeRequested(orders);
 }
@@ -127,7 +136,21 @@ void FormDatabaseCleanup::loadDatabaseInfo() {
 
   m_ui->m_txtFileSize->setText(tr("file: %1, data: %2").arg(file_size_str, data_size_str));
   m_ui->m_txtDatabaseType->setText(qApp->database()->humanDriverName(qApp->database()->activeDatabaseDriver()));
+
+  int compressed_messages;
+  qint64 saved_bytes;
+
+  if (DatabaseQueries::getContentsCompressionStats(qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings),
+                                                   &compressed_messages, &saved_bytes)) {
+    m_ui->m_txtCompression->setText(tr("%n message(s), saved: %1", 0, compressed_messages).arg(QString::number(saved_bytes / 1000000.0) + QL1S(" MB")));
+  }
+  else {
+    m_ui->m_txtCompression->setText(tr("unknown"));
+  }
   m_ui->m_checkShrink->setEnabled(qApp->database()->activeDatabaseDriver() == DatabaseFactory::SQLITE ||
                                   qApp->database()->activeDatabaseDriver() == DatabaseFactory::SQLITE_MEMORY);
   m_ui->m_checkShrink->setChecked(m_ui->m_checkShrink->isEnabled());
+
+  // Archive database is supported only with SQLite backends.
+  m_ui->m_checkArchiveOldMessages->setEnabled(m_ui->m_checkShrink->isEnabled());
 }
@@ -45,6 +45,7 @@ class FormDatabaseCleanup : public QDialog {
 
   private slots:
     void updateDaysSuffix(int number);
+    void updateArchiveDaysSuffix(int number);
     void startPurging();
     void onPurgeStarted();
     void onPurgeProgress(int progress, const QString &description);
@@ -209,6 +209,8 @@ void FormSettings::selectEmailExecutable() {
 
 void FormSettings::loadFeedsMessages() {
   m_ui->m_checkKeppMessagesInTheMiddle->setChecked(m_settings->value(GROUP(Messages), SETTING(Messages::KeepCursorInCenter)).toBool());
+  m_ui->m_checkShowArchivedMessages->setChecked(m_settings->value(GROUP(Messages), SETTING(Messages::ShowArchivedMessages)).toBool());
+  m_ui->m_checkPreloadPreviewer->setChecked(m_settings->value(GROUP(Messages), SETTING(Messages::PreloadPreviewer)).toBool());
   m_ui->m_checkRemoveReadMessagesOnExit->setChecked(m_settings->value(GROUP(Messages), SETTING(Messages::ClearReadOnExit)).toBool());
   m_ui->m_checkAutoUpdate->setChecked(m_settings->value(GROUP(Feeds), SETTING(Feeds::AutoUpdateEnabled)).toBool());
   m_ui->m_spinAutoUpdateInterval->setValue(m_settings->value(GROUP(Feeds), SETTING(Feeds::AutoUpdateInterval)).toInt());
@@ -216,6 +218,7 @@ void FormSettings::loadFeedsMessages() {
   m_ui->m_checkUpdateAllFeedsOnStartup->setChecked(m_settings->value(GROUP(Feeds), SETTING(Feeds::FeedsUpdateOnStartup)).toBool());
   m_ui->m_cmbCountsFeedList->addItems(QStringList() << "(%unread)" << "[%unread]" << "%unread/%all" << "%unread-%all" << "[%unread|%all]");
   m_ui->m_cmbCountsFeedList->setEditText(m_settings->value(GROUP(Feeds), SETTING(Feeds::CountFormat)).toString());
+  m_ui->m_checkContentHashItemsOnly->setChecked(m_settings->value(GROUP(Feeds), SETTING(Feeds::ContentHashItemsOnly)).toBool());
 
   initializeMessageDateFormats();
 
@@ -259,12 +262,15 @@ void FormSettings::changeMessagesFont() {
 
 void FormSettings::saveFeedsMessages() {
   m_settings->setValue(GROUP(Messages), Messages::KeepCursorInCenter, m_ui->m_checkKeppMessagesInTheMiddle->isChecked());
+  m_settings->setValue(GROUP(Messages), Messages::ShowArchivedMessages, m_ui->m_checkShowArchivedMessages->isChecked());
+  m_settings->setValue(GROUP(Messages), Messages::PreloadPreviewer, m_ui->m_checkPreloadPreviewer->isChecked());
   m_settings->setValue(GROUP(Messages), Messages::ClearReadOnExit, m_ui->m_checkRemoveReadMessagesOnExit->isChecked());
   m_settings->setValue(GROUP(Feeds), Feeds::AutoUpdateEnabled, m_ui->m_checkAutoUpdate->isChecked());
   m_settings->setValue(GROUP(Feeds), Feeds::AutoUpdateInterval, m_ui->m_spinAutoUpdateInterval->value());
   m_settings->setValue(GROUP(Feeds), Feeds::UpdateTimeout, m_ui->m_spinFeedUpdateTimeout->value());
   m_settings->setValue(GROUP(Feeds), Feeds::FeedsUpdateOnStartup, m_ui->m_checkUpdateAllFeedsOnStartup->isChecked());
   m_settings->setValue(GROUP(Feeds), Feeds::CountFormat, m_ui->m_cmbCountsFeedList->currentText());
+  m_settings->setValue(GROUP(Feeds), Feeds::ContentHashItemsOnly, m_ui->m_checkContentHashItemsOnly->isChecked());
   m_settings->setValue(GROUP(Messages), Messages::UseCustomDate, m_ui->m_checkMessagesDateTimeFormat->isChecked());
   m_settings->setValue(GROUP(Messages), Messages::CustomDateFormat,
                        m_ui->m_cmbMessagesDateTimeFormat->itemData(m_ui->m_cmbMessagesDateTimeFormat->currentIndex()).toString());
@@ -479,6 +485,14 @@ void FormSettings::loadDataStorage() {
 
   // Load in-memory database status.
   m_ui->m_checkSqliteUseInMemoryDatabase->setChecked(m_settings->value(GROUP(Database), SETTING(Database::UseInMemory)).toBool());
+  m_ui->m_spinSqliteSnapshotInterval->setValue(m_settings->value(GROUP(Database), SETTING(Database::InMemorySnapshotInterval)).toInt());
+  m_ui->m_spinArchiveMessagesOlderThan->setValue(m_settings->value(GROUP(Database), SETTING(Database::ArchiveMessagesOlderThan)).toInt());
+  m_ui->m_checkCompressMessageContents->setChecked(m_settings->value(GROUP(Database), SETTING(Database::CompressMessageContents)).toBool());
+
+  if (!DatabaseFactory::supportsMemoryDatabaseSnapshots()) {
+    m_ui->m_spinSqliteSnapshotInterval->setEnabled(false);
+    m_ui->m_spinSqliteSnapshotInterval->setToolTip(tr("Periodic snapshots are available only when %1 is linked against system SQLite library.").arg(APP_NAME));
+  }
 
   if (QSqlDatabase::isDriverAvailable(APP_DB_MYSQL_DRIVER)) {
     onMysqlHostnameChanged(QString());
@@ -526,6 +540,18 @@ void FormSettings::saveDataStorage() {
 
   // Save SQLite.
   m_settings->setValue(GROUP(Database), Database::UseInMemory, new_inmemory);
+  m_settings->setValue(GROUP(Database), Database::InMemorySnapshotInterval, m_ui->m_spinSqliteSnapshotInterval->value());
+  m_settings->setValue(GROUP(Database), Database::ArchiveMessagesOlderThan, m_ui->m_spinArchiveMessagesOlderThan->value());
+
+  // Compression of already stored messages is (re)started on next
+  // application startup each time compression gets enabled.
+  const bool new_compress_contents = m_ui->m_checkCompressMessageContents->isChecked();
+
+  if (new_compress_contents && !m_settings->value(GROUP(Database), SETTING(Database::CompressMessageContents)).toBool()) {
+    m_settings->setValue(GROUP(Database), Database::MessageContentsCompressed, false);
+  }
+
+  m_settings->setValue(GROUP(Database), Database::CompressMessageContents, new_compress_contents);
 
   if (QSqlDatabase::isDriverAvailable(APP_DB_MYSQL_DRIVER)) {
     // Save MySQL.
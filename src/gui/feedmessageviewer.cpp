@@ -67,7 +67,6 @@ FeedMessageViewer::FeedMessageViewer(QWidget *parent)
     m_messagesBrowser(new WebBrowser(this)) {
   initialize();
   initializeViews();
-  loadMessageViewerFonts();
   createConnections();
 }
 
@@ -120,9 +119,17 @@ void FeedMessageViewer::loadMessageViewerFonts() {
   m_messagesBrowser->reloadFontSettings();
 }
 
+void FeedMessageViewer::preloadMessagePreviewer() {
+  qDebug("Preloading message previewer.");
+  m_messagesBrowser->preload();
+}
+
 void FeedMessageViewer::quit() {
   // Quit the feeds model (stops auto-update timer etc.).
   m_feedsView->sourceModel()->quit();
+
+  // Write queued changes of messages.
+  m_messagesView->sourceModel()->quit();
 }
 
 bool FeedMessageViewer::areToolBarsEnabled() const {
@@ -235,6 +242,7 @@ void FeedMessageViewer::createConnections() {
   // Message changers.
   connect(m_messagesView, SIGNAL(currentMessageRemoved()), m_messagesBrowser, SLOT(clear()));
   connect(m_messagesView, SIGNAL(currentMessageChanged(Message,RootItem*)), m_messagesBrowser, SLOT(loadMessage(Message,RootItem*)));
+  connect(m_messagesView, SIGNAL(adjacentMessagesChanged(QList<Message>)), m_messagesBrowser, SLOT(prerenderMessages(QList<Message>)));
   connect(m_messagesView, SIGNAL(currentMessageRemoved()), this, SLOT(updateMessageButtonsAvailability()));
   connect(m_messagesView, SIGNAL(currentMessageChanged(Message,RootItem*)), this, SLOT(updateMessageButtonsAvailability()));
   connect(m_messagesBrowser, SIGNAL(markMessageRead(int,RootItem::ReadStatus)),
@@ -259,8 +267,8 @@ void FeedMessageViewer::createConnections() {
   // Message openers.
   connect(m_messagesView, SIGNAL(openMessagesInNewspaperView(RootItem*,QList<Message>)),
           qApp->mainForm()->tabWidget(), SLOT(addNewspaperView(RootItem*,QList<Message>)));
-  connect(m_feedsView, SIGNAL(openMessagesInNewspaperView(RootItem*,QList<Message>)),
-          qApp->mainForm()->tabWidget(), SLOT(addNewspaperView(RootItem*,QList<Message>)));
+  connect(m_feedsView, SIGNAL(openMessagesInNewspaperView(RootItem*,QList<Message>,MessagesCursor)),
+          qApp->mainForm()->tabWidget(), SLOT(addNewspaperView(RootItem*,QList<Message>,MessagesCursor)));
 
   // Toolbar forwardings.
   connect(form_main->m_ui->m_actionAddFeedIntoSelectedAccount, SIGNAL(triggered()),
@@ -413,6 +421,8 @@ void FeedMessageViewer::initializeViews() {
 
 void FeedMessageViewer::showDbCleanupAssistant() {
   if (qApp->feedUpdateLock()->tryLock()) {
+    disconnect(qApp->feedUpdateLock(), SIGNAL(unlocked()), this, SLOT(showDbCleanupAssistant()));
+
     QScopedPointer<FormDatabaseCleanup> form_pointer(new FormDatabaseCleanup(this));
     form_pointer.data()->setCleaner(m_feedsView->sourceModel()->databaseCleaner());
     form_pointer.data()->exec();
@@ -423,9 +433,12 @@ void FeedMessageViewer::showDbCleanupAssistant() {
     m_feedsView->sourceModel()->reloadCountsOfWholeModel();
   }
   else {
-    qApp->showGuiMessage(tr("Cannot cleanup database"),
-                         tr("Cannot cleanup database, because another critical action is running."),
-                         QSystemTrayIcon::Warning, qApp->mainForm(), true);
+    // Cleanup waits until running critical action finishes.
+    qApp->showGuiMessage(tr("Database cleanup delayed"),
+                         tr("Database cleanup will start as soon as another critical action finishes."),
+                         QSystemTrayIcon::Information, qApp->mainForm(), true);
+    connect(qApp->feedUpdateLock(), SIGNAL(unlocked()), this, SLOT(showDbCleanupAssistant()),
+            (Qt::ConnectionType) (Qt::UniqueConnection | Qt::QueuedConnection));
   }
 }
 
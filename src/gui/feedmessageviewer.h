@@ -96,6 +96,10 @@ class FeedMessageViewer : public TabContent {
     // Reloads some changeable visual settings.
     void refreshVisualProperties();
 
+    // Creates web engine of message previewer in advance,
+    // so that first displayed message does not wait for it.
+    void preloadMessagePreviewer();
+
   private slots:
     // Called when feed update finishes.
     void onFeedsUpdateFinished();
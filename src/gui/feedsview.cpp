@@ -257,8 +257,18 @@ void FeedsView::deleteSelectedItem() {
     return;
   }
 
+  // Accounts cannot be removed while their pending changes are pushed.
+  if (!qApp->pendingChangesLock()->tryLock()) {
+    qApp->feedUpdateLock()->unlock();
+    qApp->showGuiMessage(tr("Cannot delete item"),
+                         tr("Selected item cannot be deleted because changes are being sent to online services."),
+                         QSystemTrayIcon::Warning, qApp->mainForm(), true);
+    return;
+  }
+
   if (!currentIndex().isValid()) {
     // Changes are done, unlock the update master lock and exit.
+    qApp->pendingChangesLock()->unlock();
     qApp->feedUpdateLock()->unlock();
     return;
   }
@@ -275,6 +285,7 @@ void FeedsView::deleteSelectedItem() {
                            tr("Are you sure?"),
                            QString(), QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes) == QMessageBox::No) {
         // User refused.
+        qApp->pendingChangesLock()->unlock();
         qApp->feedUpdateLock()->unlock();
         return;
       }
@@ -298,6 +309,7 @@ void FeedsView::deleteSelectedItem() {
   }
 
   // Changes are done, unlock the update master lock.
+  qApp->pendingChangesLock()->unlock();
   qApp->feedUpdateLock()->unlock();
 }
 
@@ -323,10 +335,11 @@ void FeedsView::markAllItemsRead() {
 
 void FeedsView::openSelectedItemsInNewspaperMode() {
   RootItem *selected_item = selectedItem();
-  const QList<Message> messages = m_sourceModel->messagesForItem(selected_item);
+  MessagesCursor more_messages;
+  const QList<Message> messages = m_sourceModel->messagesForItem(selected_item, more_messages);
 
   if (!messages.isEmpty()) {
-    emit openMessagesInNewspaperView(selected_item, messages);
+    emit openMessagesInNewspaperView(selected_item, messages, more_messages);
   }
 }
 
@@ -98,8 +98,9 @@ class FeedsView : public QTreeView {
     // Emitted if user selects new feeds.
     void itemSelected(RootItem *item);
 
-    // Requests opening of given messages in newspaper mode.
-    void openMessagesInNewspaperView(RootItem *root, const QList<Message> &messages);
+    // Requests opening of given messages in newspaper mode,
+    // remaining messages are read via given cursor.
+    void openMessagesInNewspaperView(RootItem *root, const QList<Message> &messages, const MessagesCursor &more_messages);
 
   protected:
     // Handle selections.
@@ -37,7 +37,17 @@ MessagesView::MessagesView(QWidget *parent)
   : QTreeView(parent),
     m_contextMenu(nullptr),
     m_columnsAdjusted(false),
-    m_batchUnreadSwitch(false) {
+    m_batchUnreadSwitch(false),
+    m_previewTimer(new QTimer(this)),
+    m_previewPending(false),
+    m_previewMarksRead(true),
+    m_searchTimer(new QTimer(this)),
+    m_searchPattern(QString()) {
+  m_previewTimer->setSingleShot(true);
+  m_previewTimer->setInterval(MESSAGES_PREVIEW_DELAY);
+  m_searchTimer->setSingleShot(true);
+  m_searchTimer->setInterval(MESSAGES_SEARCH_DELAY);
+
   m_proxyModel = new MessagesProxyModel(this);
   m_sourceModel = m_proxyModel->sourceModel();
 
@@ -57,6 +67,8 @@ void MessagesView::createConnections() {
   // Adjust columns when layout gets changed.
   connect(header(), SIGNAL(geometriesChanged()), this, SLOT(adjustColumns()));
   connect(header(), SIGNAL(sortIndicatorChanged(int,Qt::SortOrder)), this, SLOT(onSortIndicatorChanged(int,Qt::SortOrder)));
+  connect(m_previewTimer, SIGNAL(timeout()), this, SLOT(onPreviewTimeout()));
+  connect(m_searchTimer, SIGNAL(timeout()), this, SLOT(onSearchTimeout()));
 }
 
 void MessagesView::keyboardSearch(const QString &search) {
@@ -193,7 +205,7 @@ void MessagesView::mousePressEvent(QMouseEvent *event) {
 
       if (clicked_index.isValid()) {
         const QModelIndex mapped_index = m_proxyModel->mapToSource(clicked_index);
-        const QString url = m_sourceModel->messageAt(mapped_index.row()).m_url;
+        const QString url = m_sourceModel->messageAt(mapped_index.row(), MessagesCursor::TextColumns).m_url;
 
         if (!url.isEmpty()) {
           qApp->mainForm()->tabWidget()->addLinkedBrowser(url);
@@ -219,18 +231,24 @@ void MessagesView::selectionChanged(const QItemSelection &selected, const QItemS
          mapped_current_index.row(), mapped_current_index.column());
 
   if (mapped_current_index.isValid() && selected_rows.count() == 1) {
-    Message message = m_sourceModel->messageAt(m_proxyModel->mapToSource(selected_rows.at(0)).row());
-
-    if (!m_batchUnreadSwitch) {
-      // Set this message as read only if current item
-      // wasn't changed by "mark selected messages unread" action.
-      m_sourceModel->setMessageRead(mapped_current_index.row(), RootItem::Read);
-      message.m_isRead = true;
+    // Set this message as read only if current item
+    // wasn't changed by "mark selected messages unread" action.
+    m_previewMarksRead = !m_batchUnreadSwitch;
+
+    if (m_previewTimer->isActive()) {
+      // User walks through messages quickly, display
+      // the message once the navigation stops.
+      m_previewPending = true;
+    }
+    else {
+      displayCurrentMessage();
     }
 
-    emit currentMessageChanged(message, m_sourceModel->loadedItem());
+    m_previewTimer->start();
   }
   else {
+    m_previewTimer->stop();
+    m_previewPending = false;
     emit currentMessageRemoved();
   }
 
@@ -241,6 +259,49 @@ void MessagesView::selectionChanged(const QItemSelection &selected, const QItemS
   QTreeView::selectionChanged(selected, deselected);
 }
 
+void MessagesView::onPreviewTimeout() {
+  if (m_previewPending) {
+    m_previewPending = false;
+    displayCurrentMessage();
+  }
+}
+
+void MessagesView::displayCurrentMessage() {
+  const QModelIndexList selected_rows = selectionModel()->selectedRows();
+  const QModelIndex current_index = currentIndex();
+  const QModelIndex mapped_current_index = m_proxyModel->mapToSource(current_index);
+
+  if (!mapped_current_index.isValid() || selected_rows.count() != 1) {
+    return;
+  }
+
+  Message message = m_sourceModel->messageAt(m_proxyModel->mapToSource(selected_rows.at(0)).row());
+
+  if (m_previewMarksRead) {
+    // Read status is written to DB later in background.
+    m_sourceModel->queueMessageRead(mapped_current_index.row(), RootItem::Read);
+    message.m_isRead = true;
+  }
+
+  emit currentMessageChanged(message, m_sourceModel->loadedItem());
+
+  // Prepare messages which will be probably displayed next. They
+  // will be marked as read when displayed.
+  QList<Message> adjacent_messages;
+
+  foreach (const QModelIndex &adjacent_index, QModelIndexList() << current_index.sibling(current_index.row() - 1, 0) <<
+           current_index.sibling(current_index.row() + 1, 0)) {
+    if (adjacent_index.isValid()) {
+      Message adjacent_message = m_sourceModel->messageAt(m_proxyModel->mapToSource(adjacent_index).row());
+
+      adjacent_message.m_isRead = true;
+      adjacent_messages.append(adjacent_message);
+    }
+  }
+
+  emit adjacentMessagesChanged(adjacent_messages);
+}
+
 void MessagesView::loadItem(RootItem *item) {
   const int col = qApp->settings()->value(GROUP(GUI), SETTING(GUI::DefaultSortColumnMessages)).toInt();
   const Qt::SortOrder ord = static_cast<Qt::SortOrder>(qApp->settings()->value(GROUP(GUI), SETTING(GUI::DefaultSortOrderMessages)).toInt());
@@ -258,7 +319,7 @@ void MessagesView::loadItem(RootItem *item) {
 
 void MessagesView::openSelectedSourceMessagesExternally() {
   foreach (const QModelIndex &index, selectionModel()->selectedRows()) {
-    const QString link = m_sourceModel->messageAt(m_proxyModel->mapToSource(index).row()).m_url;
+    const QString link = m_sourceModel->messageAt(m_proxyModel->mapToSource(index).row(), MessagesCursor::TextColumns).m_url;
 
     if (!WebFactory::instance()->openUrlInExternalBrowser(link)) {
       qApp->showGuiMessage(tr("Problem with starting external web browser"),
@@ -472,14 +533,34 @@ void MessagesView::selectNextUnreadItem() {
 }
 
 void MessagesView::searchMessages(const QString &pattern) {
-  m_proxyModel->setFilterRegExp(pattern);
+  m_searchPattern = pattern;
+  m_searchTimer->start();
+}
 
-  if (selectionModel()->selectedRows().size() == 0) {
+void MessagesView::onSearchTimeout() {
+  const QModelIndex mapped_current_index = m_proxyModel->mapToSource(currentIndex());
+
+  // Archived messages have negative IDs, so ID cannot mark missing message.
+  const bool current_exists = mapped_current_index.isValid();
+  const int current_id = current_exists ? m_sourceModel->messageId(mapped_current_index.row()) : 0;
+
+  // Messages are reloaded, so current message is selected again if it still matches.
+  m_sourceModel->setSearchPattern(m_searchPattern);
+
+  const int current_row = current_exists ? m_sourceModel->messageRow(current_id) : -1;
+  const QModelIndex current_index = current_row < 0 ?
+                                      QModelIndex() :
+                                      m_proxyModel->mapFromSource(m_sourceModel->index(current_row, MSG_DB_TITLE_INDEX));
+
+  if (!current_index.isValid()) {
+    // Message does not match new pattern.
     emit currentMessageRemoved();
   }
   else {
+    setCurrentIndex(current_index);
+
     // Scroll to selected message, it could become scrolled out due to filter change.
-    scrollTo(selectionModel()->selectedRows().at(0));
+    scrollTo(current_index);
   }
 }
 
@@ -27,6 +27,7 @@
 
 
 class MessagesProxyModel;
+class QTimer;
 
 class MessagesView : public QTreeView {
     Q_OBJECT
@@ -90,6 +91,13 @@ class MessagesView : public QTreeView {
     // Saves current sort state.
     void onSortIndicatorChanged(int column, Qt::SortOrder order);
 
+    // Displays current message if selection changed while
+    // previous message was being displayed.
+    void onPreviewTimeout();
+
+    // Applies search pattern once user stops typing.
+    void onSearchTimeout();
+
   signals:
     // Link/message openers.
     void openLinkNewTab(const QString &link);
@@ -100,6 +108,10 @@ class MessagesView : public QTreeView {
     void currentMessageChanged(const Message &message, RootItem *root);
     void currentMessageRemoved();
 
+    // Messages adjacent to current message, which
+    // will probably be displayed next.
+    void adjacentMessagesChanged(const QList<Message> &messages);
+
   private:
     // Creates needed connections.
     void createConnections();
@@ -110,6 +122,9 @@ class MessagesView : public QTreeView {
     // Sets up appearance.
     void setupAppearance();
 
+    // Displays message which is selected now.
+    void displayCurrentMessage();
+
     // Event reimplementations.
     void contextMenuEvent(QContextMenuEvent *event);
     void mousePressEvent(QMouseEvent *event);
@@ -123,6 +138,17 @@ class MessagesView : public QTreeView {
 
     bool m_columnsAdjusted;
     bool m_batchUnreadSwitch;
+
+    // Preview is not updated more often than once per MESSAGES_PREVIEW_DELAY
+    // when user quickly walks through messages.
+    QTimer *m_previewTimer;
+    bool m_previewPending;
+    bool m_previewMarksRead;
+
+    // Messages are searched by the database, so they are
+    // not searched before user stops typing for MESSAGES_SEARCH_DELAY.
+    QTimer *m_searchTimer;
+    QString m_searchPattern;
 };
 
 #endif // MESSAGESVIEW_H
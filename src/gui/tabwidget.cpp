@@ -25,6 +25,7 @@
 #include "gui/tabbar.h"
 #include "gui/feedmessageviewer.h"
 #include "gui/webbrowser.h"
+#include "gui/webviewerpool.h"
 #include "gui/plaintoolbutton.h"
 #include "gui/dialogs/formmain.h"
 
@@ -32,7 +33,7 @@
 #include <QToolButton>
 
 
-TabWidget::TabWidget(QWidget *parent) : QTabWidget(parent), m_menuMain(nullptr) {
+TabWidget::TabWidget(QWidget *parent) : QTabWidget(parent), m_menuMain(nullptr), m_viewerPool(new WebViewerPool(this)) {
   setTabBar(new TabBar(this));
   setupMainMenuButton();
   createConnections();
@@ -158,6 +159,13 @@ void TabWidget::setupIcons() {
 
 bool TabWidget::closeTab(int index) {
   if (tabBar()->tabType(index) == TabBar::Closable) {
+    WebBrowser *browser = qobject_cast<WebBrowser*>(widget(index));
+
+    // Web viewer of closed tab can be reused by next tab.
+    if (browser != nullptr && browser->hasViewer()) {
+      m_viewerPool->releaseViewer(browser->takeViewer());
+    }
+
     removeTab(index, true);
     return true;
   }
@@ -191,12 +199,14 @@ void TabWidget::closeAllTabs() {
   }
 }
 
-int TabWidget::addNewspaperView(RootItem *root, const QList<Message> &messages) {
+int TabWidget::addNewspaperView(RootItem *root, const QList<Message> &messages, const MessagesCursor &more_messages) {
   WebBrowser *prev = new WebBrowser(this);
+  prev->setViewer(m_viewerPool->takeViewer());
+
   int index = addTab(prev, qApp->icons()->fromTheme(QSL("format-justify-fill")), tr("Newspaper view"), TabBar::Closable);
 
   setCurrentIndex(index);
-  prev->loadMessages(messages, root);
+  prev->loadMessages(messages, root, more_messages);
 
   return index;
 }
@@ -218,6 +228,8 @@ int TabWidget::addBrowser(bool move_after_current, bool make_active, const QUrl
   WebBrowser *browser = new WebBrowser(this);
   int final_index;
 
+  browser->setViewer(m_viewerPool->takeViewer());
+
   if (move_after_current) {
     // Insert web browser after current tab.
     final_index = insertTab(currentIndex() + 1, browser, qApp->icons()->fromTheme(QSL("text-html")),
@@ -31,6 +31,7 @@ class QMenu;
 class PlainToolButton;
 class RootItem;
 class FeedMessageViewer;
+class WebViewerPool;
 
 class TabWidget : public QTabWidget {
     Q_OBJECT
@@ -77,6 +78,11 @@ class TabWidget : public QTabWidget {
       return m_feedMessageViewer;
     }
 
+    // Pool of pre-warmed web viewers for newly opened tabs.
+    inline WebViewerPool *viewerPool() const {
+      return m_viewerPool;
+    }
+
   protected:
     // Creates necesary connections.
     void createConnections();
@@ -110,7 +116,8 @@ class TabWidget : public QTabWidget {
     // Displays download manager.
     void showDownloadManager();
 
-    int addNewspaperView(RootItem *root, const QList<Message> &messages);
+    int addNewspaperView(RootItem *root, const QList<Message> &messages,
+                         const MessagesCursor &more_messages = MessagesCursor());
 
     // Adds new WebBrowser tab to global TabWidget.
     int addEmptyBrowser();
@@ -127,6 +134,7 @@ class TabWidget : public QTabWidget {
     PlainToolButton *m_btnMainMenu;
     QMenu *m_menuMain;
     FeedMessageViewer *m_feedMessageViewer;
+    WebViewerPool *m_viewerPool;
 };
 
 #endif // TABWIDGET_H
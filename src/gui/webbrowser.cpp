@@ -36,9 +36,41 @@
 
 
 void WebBrowser::createConnections() {
-  connect(m_webView, &WebViewer::messageStatusChangeRequested, this, &WebBrowser::receiveMessageStatusChangeRequest);
-
   connect(m_txtLocation,SIGNAL(submitted(QString)), this, SLOT(loadUrl(QString)));
+}
+
+void WebBrowser::attachViewer(WebViewer *viewer) {
+  m_webView = viewer;
+  m_actionBack = m_webView->pageAction(QWebEnginePage::Back);
+  m_actionForward = m_webView->pageAction(QWebEnginePage::Forward);
+  m_actionReload = m_webView->pageAction(QWebEnginePage::Reload);
+  m_actionStop = m_webView->pageAction(QWebEnginePage::Stop);
+
+  // Modify action texts.
+  m_actionBack->setText(tr("Back"));
+  m_actionBack->setToolTip(tr("Go back."));
+  m_actionForward->setText(tr("Forward"));
+  m_actionForward->setToolTip(tr("Go forward."));
+  m_actionReload->setText(tr("Reload"));
+  m_actionReload->setToolTip(tr("Reload current web page."));
+  m_actionStop->setText(tr("Stop"));
+  m_actionStop->setToolTip(tr("Stop web page loading."));
+
+  // Add needed actions into toolbar.
+  m_toolBar->insertAction(m_actionDiscover, m_actionBack);
+  m_toolBar->insertAction(m_actionDiscover, m_actionForward);
+  m_toolBar->insertAction(m_actionDiscover, m_actionReload);
+  m_toolBar->insertAction(m_actionDiscover, m_actionStop);
+
+  // Viewer replaces the placeholder.
+  m_placeholder->hide();
+  m_layout->insertWidget(m_layout->indexOf(m_placeholder) + 1, m_webView);
+  m_webView->show();
+
+  setTabOrder(m_toolBar, m_webView);
+
+  connect(m_webView, &WebViewer::messageStatusChangeRequested, this, &WebBrowser::receiveMessageStatusChangeRequest);
+  connect(m_webView, &WebViewer::moreMessagesRequested, this, &WebBrowser::loadMoreMessages);
   connect(m_webView, SIGNAL(urlChanged(QUrl)), this, SLOT(updateUrl(QUrl)));
 
   // Connect this WebBrowser to global TabWidget.
@@ -54,6 +86,54 @@ void WebBrowser::createConnections() {
   // Forward title/icon changes.
   connect(m_webView, SIGNAL(titleChanged(QString)), this, SLOT(onTitleChanged(QString)));
   connect(m_webView, SIGNAL(iconChanged(QIcon)), this, SLOT(onIconChanged(QIcon)));
+
+  reloadFontSettings();
+}
+
+WebViewer *WebBrowser::viewer() {
+  if (m_webView == nullptr) {
+    qDebug("Creating web viewer on demand.");
+    attachViewer(new WebViewer(this));
+  }
+
+  return m_webView;
+}
+
+bool WebBrowser::hasViewer() const {
+  return m_webView != nullptr;
+}
+
+void WebBrowser::setViewer(WebViewer *viewer) {
+  if (m_webView != nullptr) {
+    delete takeViewer();
+  }
+
+  attachViewer(viewer);
+}
+
+WebViewer *WebBrowser::takeViewer() {
+  WebViewer *viewer = m_webView;
+
+  if (viewer != nullptr) {
+    disconnect(viewer, 0, this, 0);
+
+    m_toolBar->removeAction(m_actionBack);
+    m_toolBar->removeAction(m_actionForward);
+    m_toolBar->removeAction(m_actionReload);
+    m_toolBar->removeAction(m_actionStop);
+
+    m_layout->removeWidget(viewer);
+    viewer->setParent(nullptr);
+    m_placeholder->show();
+
+    m_webView = nullptr;
+    m_actionBack = nullptr;
+    m_actionForward = nullptr;
+    m_actionReload = nullptr;
+    m_actionStop = nullptr;
+  }
+
+  return viewer;
 }
 
 void WebBrowser::updateUrl(const QUrl &url) {
@@ -65,29 +145,29 @@ void WebBrowser::updateUrl(const QUrl &url) {
 
 void WebBrowser::loadUrl(const QUrl &url) {
   if (url.isValid()) {
-    m_webView->load(url);
+    viewer()->load(url);
   }
 }
 
 WebBrowser::WebBrowser(QWidget *parent) : TabContent(parent),
   m_layout(new QVBoxLayout(this)),
   m_toolBar(new QToolBar(tr("Navigation panel"), this)),
-  m_webView(new WebViewer(this)),
+  m_placeholder(new QWidget(this)),
+  m_webView(nullptr),
   m_txtLocation(new LocationLineEdit(this)),
   m_btnDiscoverFeeds(new DiscoverFeedsButton(this)),
-  m_actionBack(m_webView->pageAction(QWebEnginePage::Back)),
-  m_actionForward(m_webView->pageAction(QWebEnginePage::Forward)),
-  m_actionReload(m_webView->pageAction(QWebEnginePage::Reload)),
-  m_actionStop(m_webView->pageAction(QWebEnginePage::Stop)) {
+  m_actionDiscover(nullptr),
+  m_actionBack(nullptr),
+  m_actionForward(nullptr),
+  m_actionReload(nullptr),
+  m_actionStop(nullptr) {
 
   // Initialize the components and layout.
   initializeLayout();
 
   setTabOrder(m_txtLocation, m_toolBar);
-  setTabOrder(m_toolBar, m_webView);
 
   createConnections();
-  reloadFontSettings();
 }
 
 WebBrowser::~WebBrowser() {
@@ -105,20 +185,31 @@ void WebBrowser::reloadFontSettings() {
 }
 
 void WebBrowser::increaseZoom() {
-  m_webView->increaseWebPageZoom();
+  if (m_webView != nullptr) {
+    m_webView->increaseWebPageZoom();
+  }
 }
 
 void WebBrowser::decreaseZoom() {
-  m_webView->decreaseWebPageZoom();
+  if (m_webView != nullptr) {
+    m_webView->decreaseWebPageZoom();
+  }
 }
 
 void WebBrowser::resetZoom() {
-  m_webView->resetWebPageZoom();
+  if (m_webView != nullptr) {
+    m_webView->resetWebPageZoom();
+  }
 }
 
 void WebBrowser::clear() {
-  m_webView->clear();
+  if (m_webView != nullptr) {
+    m_webView->clear();
+  }
+
   m_messages.clear();
+  m_pendingMessages.clear();
+  m_messagesCursor = MessagesCursor();
   hide();
 }
 
@@ -126,8 +217,8 @@ void WebBrowser::loadUrl(const QString &url) {
   return loadUrl(QUrl::fromUserInput(url));
 }
 
-void WebBrowser::loadMessages(const QList<Message> &messages, RootItem *root) {
-  if (m_messages.size() == messages.size()) {
+void WebBrowser::loadMessages(const QList<Message> &messages, RootItem *root, const MessagesCursor &more_messages) {
+  if (m_messages.size() == messages.size() && !hasMoreMessages() && more_messages.atEnd()) {
     for (int i = 0; i < messages.size(); i++) {
       if (m_messages.at(i).m_id != messages.at(i).m_id) {
         break;
@@ -140,19 +231,68 @@ void WebBrowser::loadMessages(const QList<Message> &messages, RootItem *root) {
     }
   }
 
-  m_messages = messages;
+  // Only first page of messages is displayed now.
+  const QList<Message> first_page = messages.mid(0, NEWSPAPER_PAGE_SIZE);
+
+  m_messages.clear();
+  m_pendingMessages = messages.mid(first_page.size());
+  m_messagesCursor = more_messages;
   m_root = root;
+  rememberMessages(first_page);
 
   if (!m_root.isNull()) {
-    m_webView->loadMessages(messages);
+    viewer()->loadMessages(first_page, hasMoreMessages());
     show();
   }
 }
 
+void WebBrowser::loadMoreMessages() {
+  if (m_root.isNull() || !hasMoreMessages()) {
+    return;
+  }
+
+  QList<Message> page = m_pendingMessages.mid(0, NEWSPAPER_PAGE_SIZE);
+
+  m_pendingMessages = m_pendingMessages.mid(page.size());
+
+  if (page.size() < NEWSPAPER_PAGE_SIZE && !m_messagesCursor.atEnd()) {
+    page.append(DatabaseQueries::fetchNextMessages(qApp->database()->connection(objectName(), DatabaseFactory::FromSettings),
+                                                   m_messagesCursor, NEWSPAPER_PAGE_SIZE - page.size()));
+  }
+
+  rememberMessages(page);
+  viewer()->appendMessages(page, hasMoreMessages());
+}
+
+bool WebBrowser::hasMoreMessages() const {
+  return !m_pendingMessages.isEmpty() || !m_messagesCursor.atEnd();
+}
+
+void WebBrowser::rememberMessages(const QList<Message> &messages) {
+  foreach (Message message, messages) {
+    // Contents are already rendered, they are not needed anymore.
+    message.m_contents.clear();
+    m_messages.append(message);
+  }
+}
+
 void WebBrowser::loadMessage(const Message &message, RootItem *root) {
   loadMessages(QList<Message>() << message, root);
 }
 
+void WebBrowser::preload() {
+  if (m_webView == nullptr) {
+    // Loading of blank page starts web engine processes.
+    viewer()->clear();
+  }
+}
+
+void WebBrowser::prerenderMessages(const QList<Message> &messages) {
+  if (m_webView != nullptr) {
+    m_webView->prerenderMessages(messages);
+  }
+}
+
 void WebBrowser::receiveMessageStatusChangeRequest(int message_id, WebPage::MessageStatusChange change) {
   switch (change) {
     case WebPage::MarkRead:
@@ -195,38 +335,31 @@ void WebBrowser::initializeLayout() {
   m_toolBar->setMovable(false);
   m_toolBar->setAllowedAreas(Qt::TopToolBarArea);
 
-  // Modify action texts.
-  m_actionBack->setText(tr("Back"));
-  m_actionBack->setToolTip(tr("Go back."));
-  m_actionForward->setText(tr("Forward"));
-  m_actionForward->setToolTip(tr("Go forward."));
-  m_actionReload->setText(tr("Reload"));
-  m_actionReload->setToolTip(tr("Reload current web page."));
-  m_actionStop->setText(tr("Stop"));
-  m_actionStop->setToolTip(tr("Stop web page loading."));
-
   QWidgetAction *act_discover = new QWidgetAction(this);
 
   act_discover->setDefaultWidget(m_btnDiscoverFeeds);
+  m_actionDiscover = act_discover;
 
-  // Add needed actions into toolbar.
-  m_toolBar->addAction(m_actionBack);
-  m_toolBar->addAction(m_actionForward);
-  m_toolBar->addAction(m_actionReload);
-  m_toolBar->addAction(m_actionStop);
-  m_toolBar->addAction(act_discover);
+  // Add needed actions into toolbar, navigation actions
+  // are added when web viewer is created.
+  m_toolBar->addAction(m_actionDiscover);
   m_toolBar->addWidget(m_txtLocation);
 
+  // Placeholder looks like empty web page.
+  m_placeholder->setBackgroundRole(QPalette::Base);
+  m_placeholder->setAutoFillBackground(true);
+
   m_loadingProgress = new QProgressBar(this);
   m_loadingProgress->setFixedHeight(5);
   m_loadingProgress->setMinimum(0);
   m_loadingProgress->setTextVisible(false);
   m_loadingProgress->setMaximum(100);
   m_loadingProgress->setAttribute(Qt::WA_TranslucentBackground);
+  m_loadingProgress->hide();
 
   // Setup layout.
   m_layout->addWidget(m_toolBar);
-  m_layout->addWidget(m_webView);
+  m_layout->addWidget(m_placeholder);
   m_layout->addWidget(m_loadingProgress);
   m_layout->setMargin(0);
   m_layout->setSpacing(0);
@@ -245,8 +378,10 @@ void WebBrowser::onLoadingFinished(bool success) {
   if (success) {
     // Let's check if there are any feeds defined on the web and eventually
     // display "Add feeds" button.
-    m_webView->page()->toHtml([this](const QString &result){
-      this->m_btnDiscoverFeeds->setFeedAddresses(NetworkFactory::extractFeedLinksFromHtmlPage(m_webView->url(), result));
+    const QUrl url = m_webView->url();
+
+    m_webView->page()->toHtml([this, url](const QString &result){
+      this->m_btnDiscoverFeeds->setFeedAddresses(NetworkFactory::extractFeedLinksFromHtmlPage(url, result));
     });
   }
   else {
@@ -261,7 +396,8 @@ void WebBrowser::markMessageAsRead(int id, bool read) {
   if (!m_root.isNull()) {
     Message *msg = findMessage(id);
 
-    if (msg != nullptr && m_root->getParentServiceRoot()->onBeforeSetMessagesRead(m_root.data(),
+    // Archived messages are read-only.
+    if (msg != nullptr && !msg->m_isArchived && m_root->getParentServiceRoot()->onBeforeSetMessagesRead(m_root.data(),
                                                                                   QList<Message>() << *msg,
                                                                                   read ? RootItem::Read : RootItem::Unread)) {
       DatabaseQueries::markMessagesReadUnread(qApp->database()->connection(objectName(), DatabaseFactory::FromSettings),
@@ -281,7 +417,8 @@ void WebBrowser::switchMessageImportance(int id, bool checked) {
   if (!m_root.isNull()) {
     Message *msg = findMessage(id);
 
-    if (msg != nullptr && m_root->getParentServiceRoot()->onBeforeSwitchMessageImportance(m_root.data(),
+    // Archived messages are read-only.
+    if (msg != nullptr && !msg->m_isArchived && m_root->getParentServiceRoot()->onBeforeSwitchMessageImportance(m_root.data(),
                                                                                           QList<ImportanceChange>() << ImportanceChange(*msg,
                                                                                                                                         msg->m_isImportant ?
                                                                                                                                         RootItem::NotImportant :
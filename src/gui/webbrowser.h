@@ -50,9 +50,18 @@ class WebBrowser : public TabContent {
       return const_cast<WebBrowser*>(this);
     }
 
-    WebViewer *viewer() const {
-      return m_webView;
-    }
+    // Returns web viewer, it is created if it does not exist yet.
+    WebViewer *viewer();
+
+    // Web viewer is created lazily, when it is needed for the first time,
+    // placeholder is displayed until then.
+    bool hasViewer() const;
+
+    // Uses given (for example pre-warmed) viewer instead of creating new one.
+    void setViewer(WebViewer *viewer);
+
+    // Detaches web viewer from this browser and returns it.
+    WebViewer *takeViewer();
 
     void reloadFontSettings();
 
@@ -64,9 +73,21 @@ class WebBrowser : public TabContent {
     void clear();
     void loadUrl(const QString &url);
     void loadUrl(const QUrl &url);
-    void loadMessages(const QList<Message> &messages, RootItem *root);
+
+    // Displays given messages in pages, further pages are displayed
+    // as user scrolls. Messages not contained in given list are then
+    // read via given cursor.
+    void loadMessages(const QList<Message> &messages, RootItem *root,
+                      const MessagesCursor &more_messages = MessagesCursor());
     void loadMessage(const Message &message, RootItem *root);
 
+    // Creates web viewer and starts its web page in advance.
+    void preload();
+
+    // Prepares given messages, so that they are displayed
+    // faster if they are loaded.
+    void prerenderMessages(const QList<Message> &messages);
+
     // Switches visibility of navigation bar.
     inline void setNavigationBarVisible(bool visible) {
       m_toolBar->setVisible(visible);
@@ -74,6 +95,7 @@ class WebBrowser : public TabContent {
 
   private slots:
     void updateUrl(const QUrl &url);
+    void loadMoreMessages();
 
     void onLoadingStarted();
     void onLoadingProgress(int progress);
@@ -95,24 +117,31 @@ class WebBrowser : public TabContent {
 
   private:
     void initializeLayout();
+    void attachViewer(WebViewer *viewer);
     Message *findMessage(int id);
+    bool hasMoreMessages() const;
+    void rememberMessages(const QList<Message> &messages);
     void markMessageAsRead(int id, bool read);
     void switchMessageImportance(int id, bool checked);
     void createConnections();
 
     QVBoxLayout *m_layout;
     QToolBar *m_toolBar;
+    QWidget *m_placeholder;
     WebViewer *m_webView;
     LocationLineEdit *m_txtLocation;
     DiscoverFeedsButton *m_btnDiscoverFeeds;
     QProgressBar *m_loadingProgress;
 
+    QAction *m_actionDiscover;
     QAction *m_actionBack;
     QAction *m_actionForward;
     QAction *m_actionReload;
     QAction *m_actionStop;
 
     QList<Message> m_messages;
+    QList<Message> m_pendingMessages;
+    MessagesCursor m_messagesCursor;
     QPointer<RootItem> m_root;
 };
 
@@ -19,6 +19,7 @@
 
 #include "miscellaneous/skinfactory.h"
 #include "miscellaneous/application.h"
+#include "miscellaneous/textfactory.h"
 #include "definitions/definitions.h"
 #include "network-web/webpage.h"
 #include "gui/dialogs/formmain.h"
@@ -26,12 +27,19 @@
 #include "gui/webbrowser.h"
 
 #include <QWheelEvent>
+#include <QJsonDocument>
+#include <QJsonArray>
 
 
-WebViewer::WebViewer(QWidget *parent) : QWebEngineView(parent) {
+WebViewer::WebViewer(QWidget *parent)
+  : QWebEngineView(parent), m_messageContents(QString()), m_appendedMarkup(QStringList()),
+    m_moreMessages(false), m_appending(false), m_restoreAppended(false) {
   WebPage *page = new WebPage(this);
 
   connect(page, &WebPage::messageStatusChangeRequested, this, &WebViewer::messageStatusChangeRequested);
+  connect(page, &WebPage::scrollPositionChanged, this, &WebViewer::checkScrollPosition);
+  connect(page, &WebPage::contentsSizeChanged, this, &WebViewer::checkScrollPosition);
+  connect(this, &WebViewer::loadFinished, this, &WebViewer::onLoadFinished);
   setPage(page);
 }
 
@@ -45,6 +53,10 @@ bool WebViewer::canDecreaseZoom() {
 
 void WebViewer::displayMessage() {
   //load(QUrl(INTERNAL_URL_MESSAGE));
+  // Messages appended so far are not part of contents, append them
+  // again once contents are loaded.
+  m_restoreAppended = !m_appendedMarkup.isEmpty();
+  m_appending = m_restoreAppended;
   setHtml(m_messageContents, QUrl::fromUserInput(INTERNAL_URL_MESSAGE));
 }
 
@@ -80,41 +92,18 @@ bool WebViewer::resetWebPageZoom() {
   }
 }
 
-void WebViewer::loadMessages(const QList<Message> &messages) {
-  Skin skin = qApp->skins()->currentSkin();
-  QString messages_layout;
-  QString single_message_layout = skin.m_layoutMarkup;
-
-  foreach (const Message &message, messages) {
-    QString enclosures;
-    QString enclosure_images;
-
-    foreach (const Enclosure &enclosure, message.m_enclosures) {
-      enclosures += skin.m_enclosureMarkup.arg(enclosure.m_url, tr("Attachment"), enclosure.m_mimeType);
+void WebViewer::loadMessages(const QList<Message> &messages, bool more_messages) {
+  const QString prerender_key = messages.size() == 1 && !more_messages ? prerenderKey(messages.at(0)) : QString();
 
-      if (enclosure.m_mimeType.startsWith(QSL("image/"))) {
-        // Add thumbnail image.
-        enclosure_images += skin.m_enclosureImageMarkup.arg(enclosure.m_url, enclosure.m_mimeType)  ;
-      }
-    }
+  if (m_prerenderedContents.contains(prerender_key)) {
+    m_messageContents = m_prerenderedContents.value(prerender_key);
+  }
+  else {
+    m_messageContents = messagesContents(messages, more_messages);
+  }
+  m_appendedMarkup.clear();
+  m_moreMessages = more_messages;
 
-    messages_layout.append(single_message_layout
-                           .arg(message.m_title,
-                                tr("Written by ") + (message.m_author.isEmpty() ?
-                                                       tr("unknown author") :
-                                                       message.m_author),
-                                message.m_url,
-                                message.m_contents,
-                                message.m_created.toString(Qt::DefaultLocaleShortDate),
-                                enclosures,
-                                message.m_isRead ? "mark-unread" : "mark-read",
-                                message.m_isImportant ? "mark-unstarred" : "mark-starred",
-                                QString::number(message.m_id))
-                           .arg(enclosure_images));
-  }
-
-  m_messageContents = skin.m_layoutMarkupWrapper.arg(messages.size() == 1 ? messages.at(0).m_title : tr("Newspaper view"),
-                                                     messages_layout);
   bool previously_enabled = isEnabled();
 
   setEnabled(false);
@@ -126,7 +115,38 @@ void WebViewer::loadMessage(const Message &message) {
   loadMessages(QList<Message>() << message);
 }
 
+void WebViewer::appendMessages(const QList<Message> &messages, bool more_messages) {
+  m_moreMessages = more_messages;
+
+  if (!messages.isEmpty()) {
+    const QString markup = messagesMarkup(messages);
+
+    m_appendedMarkup.append(markup);
+    appendMarkup(markup);
+  }
+}
+
+void WebViewer::prerenderMessages(const QList<Message> &messages) {
+  QHash<QString,QString> prerendered_contents;
+
+  foreach (const Message &message, messages) {
+    const QString key = prerenderKey(message);
+
+    prerendered_contents.insert(key, m_prerenderedContents.contains(key) ?
+                                       m_prerenderedContents.value(key) :
+                                       messagesContents(QList<Message>() << message, false));
+  }
+
+  m_prerenderedContents = prerendered_contents;
+}
+
 void WebViewer::clear() {
+  m_messageContents.clear();
+  m_appendedMarkup.clear();
+  m_prerenderedContents.clear();
+  m_moreMessages = false;
+  m_restoreAppended = false;
+
   bool previously_enabled = isEnabled();
 
   setEnabled(false);
@@ -134,6 +154,118 @@ void WebViewer::clear() {
   setEnabled(previously_enabled);
 }
 
+void WebViewer::checkScrollPosition() {
+  if (!m_moreMessages || m_appending) {
+    return;
+  }
+
+  // Request more messages when less than one screen of
+  // messages remains below the visible part of the page.
+  const qreal remaining_height = page()->contentsSize().height() - page()->scrollPosition().y() - height();
+
+  if (remaining_height < height()) {
+    emit moreMessagesRequested();
+  }
+}
+
+void WebViewer::onLoadFinished(bool success) {
+  if (m_restoreAppended) {
+    m_restoreAppended = false;
+    m_appending = false;
+
+    if (success) {
+      appendMarkup(m_appendedMarkup.join(QString()));
+    }
+  }
+}
+
+QString WebViewer::prerenderKey(const Message &message) {
+  // Prerendered markup is valid only if message did not change since.
+  return QString(QSL("%1-%2-%3-%4-%5")).arg(QString::number(message.m_id),
+                                            QString::number(message.m_isRead),
+                                            QString::number(message.m_isImportant),
+                                            QString::number(qHash(message.m_title)),
+                                            QString::number(qHash(message.m_contents)));
+}
+
+QString WebViewer::messagesContents(const QList<Message> &messages, bool more_messages) const {
+  QVector<QString> wrapper_values(Skin::WrapperSlotCount);
+
+  wrapper_values[Skin::WrapperTitle - 1] = messages.size() == 1 && !more_messages ?
+                                             messages.at(0).m_title :
+                                             tr("Newspaper view");
+  wrapper_values[Skin::WrapperBody - 1] = messagesMarkup(messages);
+
+  return qApp->skins()->currentSkin().m_layoutTemplateWrapper.render(wrapper_values);
+}
+
+QString WebViewer::messagesMarkup(const QList<Message> &messages) const {
+  const Skin skin = qApp->skins()->currentSkin();
+  const QString attachment_title = tr("Attachment");
+  const QString written_by = tr("Written by ");
+  QVector<QString> values(messages.size() * Skin::MessageSlotCount);
+  QString messages_layout;
+  int messages_layout_length = 0;
+
+  // Prepare values of all messages first, so that whole
+  // markup is then rendered into single buffer.
+  for (int i = 0; i < messages.size(); i++) {
+    const Message &message = messages.at(i);
+    QString *message_values = values.data() + i * Skin::MessageSlotCount;
+
+    foreach (const Enclosure &enclosure, message.m_enclosures) {
+      QString enclosure_values[Skin::EnclosureSlotCount];
+
+      enclosure_values[Skin::EnclosureUrl - 1] = enclosure.m_url;
+      enclosure_values[Skin::EnclosureTitle - 1] = attachment_title;
+      enclosure_values[Skin::EnclosureMimeType - 1] = enclosure.m_mimeType;
+      skin.m_enclosureTemplate.render(message_values[Skin::MessageEnclosures - 1], enclosure_values, Skin::EnclosureSlotCount);
+
+      if (enclosure.m_mimeType.startsWith(QSL("image/"))) {
+        // Add thumbnail image.
+        QString image_values[Skin::EnclosureImageSlotCount];
+
+        image_values[Skin::EnclosureImageUrl - 1] = enclosure.m_url;
+        image_values[Skin::EnclosureImageMimeType - 1] = enclosure.m_mimeType;
+        skin.m_enclosureImageTemplate.render(message_values[Skin::MessageEnclosureImages - 1], image_values, Skin::EnclosureImageSlotCount);
+      }
+    }
+
+    message_values[Skin::MessageTitle - 1] = message.m_title;
+    message_values[Skin::MessageAuthor - 1] = written_by + (message.m_author.isEmpty() ? tr("unknown author") : message.m_author);
+    message_values[Skin::MessageUrl - 1] = message.m_url;
+    message_values[Skin::MessageContents - 1] = message.m_contents;
+    message_values[Skin::MessageCreated - 1] = TextFactory::parseDateTime(message.m_created).toString(Qt::DefaultLocaleShortDate);
+    message_values[Skin::MessageReadAction - 1] = message.m_isRead ? QSL("mark-unread") : QSL("mark-read");
+    message_values[Skin::MessageImportanceAction - 1] = message.m_isImportant ? QSL("mark-unstarred") : QSL("mark-starred");
+    message_values[Skin::MessageId - 1] = QString::number(message.m_id);
+
+    messages_layout_length += skin.m_layoutTemplate.renderedLength(message_values, Skin::MessageSlotCount);
+  }
+
+  messages_layout.reserve(messages_layout_length);
+
+  for (int i = 0; i < messages.size(); i++) {
+    skin.m_layoutTemplate.render(messages_layout, values.constData() + i * Skin::MessageSlotCount, Skin::MessageSlotCount);
+  }
+
+  return messages_layout;
+}
+
+void WebViewer::appendMarkup(const QString &markup) {
+  // Markup is passed to the script as JSON string, so it does not need any escaping.
+  const QString script = QSL("document.body.insertAdjacentHTML('beforeend', %1[0]);")
+                         .arg(QString::fromUtf8(QJsonDocument(QJsonArray() << markup).toJson(QJsonDocument::Compact)));
+
+  m_appending = true;
+  page()->runJavaScript(script, [this](const QVariant &result) {
+    Q_UNUSED(result)
+
+    m_appending = false;
+    checkScrollPosition();
+  });
+}
+
 QWebEngineView *WebViewer::createWindow(QWebEnginePage::WebWindowType type) {
   Q_UNUSED(type)
 
@@ -23,6 +23,8 @@
 #include "core/message.h"
 #include "network-web/webpage.h"
 
+#include <QHash>
+
 
 class WebViewer : public QWebEngineView {
     Q_OBJECT
@@ -44,8 +46,18 @@ class WebViewer : public QWebEngineView {
     bool resetWebPageZoom();
 
     void displayMessage();
-    void loadMessages(const QList<Message> &messages);
+
+    // Displays given messages, if more messages are available, they
+    // are requested when user scrolls near the end of displayed ones.
+    void loadMessages(const QList<Message> &messages, bool more_messages = false);
     void loadMessage(const Message &message);
+
+    // Appends messages to the end of displayed messages.
+    void appendMessages(const QList<Message> &messages, bool more_messages);
+
+    // Renders markup of given single messages in advance, it is
+    // used if any of them is loaded later.
+    void prerenderMessages(const QList<Message> &messages);
     void clear();
 
   protected:
@@ -55,8 +67,25 @@ class WebViewer : public QWebEngineView {
   signals:
     void messageStatusChangeRequested(int message_id, WebPage::MessageStatusChange change);
 
+    // Emitted when more messages should be appended.
+    void moreMessagesRequested();
+
+  private slots:
+    void checkScrollPosition();
+    void onLoadFinished(bool success);
+
   private:
+    static QString prerenderKey(const Message &message);
+    QString messagesContents(const QList<Message> &messages, bool more_messages) const;
+    QString messagesMarkup(const QList<Message> &messages) const;
+    void appendMarkup(const QString &markup);
+
     QString m_messageContents;
+    QStringList m_appendedMarkup;
+    QHash<QString,QString> m_prerenderedContents;
+    bool m_moreMessages;
+    bool m_appending;
+    bool m_restoreAppended;
 };
 
 #endif // WEBVIEWER_H
@@ -0,0 +1,85 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gui/webviewerpool.h"
+
+#include "definitions/definitions.h"
+#include "gui/webviewer.h"
+
+#include <QTimer>
+#include <QWebEngineHistory>
+
+
+WebViewerPool::WebViewerPool(QObject *parent) : QObject(parent), m_refillScheduled(false) {
+}
+
+WebViewerPool::~WebViewerPool() {
+  qDebug("Destroying WebViewerPool instance.");
+
+  // Pooled viewers do not have any parent.
+  qDeleteAll(m_viewers);
+}
+
+WebViewer *WebViewerPool::takeViewer() {
+  if (!m_refillScheduled) {
+    // Refill the pool when new viewer is displayed.
+    m_refillScheduled = true;
+    QTimer::singleShot(WEB_VIEWER_POOL_REFILL_DELAY, this, SLOT(prewarm()));
+  }
+
+  if (m_viewers.isEmpty()) {
+    qDebug("Web viewer pool is empty, creating new viewer.");
+    return createViewer();
+  }
+  else {
+    return m_viewers.takeFirst();
+  }
+}
+
+void WebViewerPool::releaseViewer(WebViewer *viewer) {
+  if (viewer == nullptr) {
+    return;
+  }
+  else if (m_viewers.size() >= WEB_VIEWER_POOL_SIZE) {
+    viewer->deleteLater();
+  }
+  else {
+    // Viewer must not remember anything from its previous tab.
+    viewer->setParent(nullptr);
+    viewer->clear();
+    viewer->history()->clear();
+    viewer->resetWebPageZoom();
+
+    m_viewers.append(viewer);
+  }
+}
+
+void WebViewerPool::prewarm() {
+  m_refillScheduled = false;
+
+  while (m_viewers.size() < WEB_VIEWER_POOL_SIZE) {
+    m_viewers.append(createViewer());
+  }
+}
+
+WebViewer *WebViewerPool::createViewer() const {
+  WebViewer *viewer = new WebViewer();
+
+  // Loading of blank page starts web engine processes.
+  viewer->clear();
+  return viewer;
+}
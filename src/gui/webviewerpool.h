@@ -0,0 +1,57 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef WEBVIEWERPOOL_H
+#define WEBVIEWERPOOL_H
+
+#include <QObject>
+
+#include <QList>
+
+
+class WebViewer;
+
+// Keeps pre-warmed web viewers, so that new newspaper views and
+// browser tabs do not have to start their web engine page from scratch.
+// Viewers of closed tabs are returned into the pool and reused.
+class WebViewerPool : public QObject {
+    Q_OBJECT
+
+  public:
+    // Constructors and destructors.
+    explicit WebViewerPool(QObject *parent = 0);
+    virtual ~WebViewerPool();
+
+    // Returns pre-warmed viewer or new viewer if pool is empty.
+    // Pool is refilled later.
+    WebViewer *takeViewer();
+
+    // Returns viewer into the pool, viewer is deleted if pool is full.
+    void releaseViewer(WebViewer *viewer);
+
+  public slots:
+    // Fills the pool with pre-warmed viewers.
+    void prewarm();
+
+  private:
+    WebViewer *createViewer() const;
+
+    QList<WebViewer*> m_viewers;
+    bool m_refillScheduled;
+};
+
+#endif // WEBVIEWERPOOL_H
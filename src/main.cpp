@@ -20,6 +20,8 @@
 #include "miscellaneous/databasefactory.h"
 #include "miscellaneous/debugging.h"
 #include "miscellaneous/iconfactory.h"
+#include "miscellaneous/startupprofiler.h"
+#include "core/parsingfactory.h"
 #include "dynamic-shortcuts/dynamicshortcuts.h"
 #include "gui/dialogs/formmain.h"
 #include "gui/feedmessageviewer.h"
@@ -52,9 +54,13 @@ int main(int argc, char *argv[]) {
   // Setup debug output system.
   qInstallMessageHandler(Debugging::debugHandler);
 
+  // Measure duration of all startup phases.
+  StartupProfiler startup_profiler;
+
   // Instantiate base application object.
   Application application(APP_LOW_NAME, argc, argv);
   qDebug("Instantiated Application class.");
+  startup_profiler.processArguments(application.arguments().mid(1));
 
   // Check if another instance is running.
   if (application.sendMessage((QStringList() << APP_IS_RUNNING << application.arguments().mid(1)).join(ARGUMENTS_LIST_SEPARATOR))) {
@@ -65,15 +71,33 @@ int main(int argc, char *argv[]) {
   // Register needed metatypes.
   qRegisterMetaType<QList<Message> >("QList<Message>");
   qRegisterMetaType<QList<RootItem*> >("QList<RootItem*>");
+  startup_profiler.finishPhase(QSL("application"));
 
   // Add an extra path for non-system icon themes and set current icon theme
   // and skin.
   qApp->icons()->setupSearchPaths();
   qApp->icons()->loadCurrentIconTheme();
+  startup_profiler.finishPhase(QSL("icon-theme"));
+
   qApp->skins()->loadCurrentSkin();
+  startup_profiler.finishPhase(QSL("skin"));
+
+  foreach (const QString &argument, application.arguments()) {
+    if (argument.startsWith(QL1S(APP_BENCHMARK_RENDERING))) {
+      // Just measure rendering of messages with current skin and quit.
+      qApp->skins()->benchmarkRendering(argument.mid(QString(APP_BENCHMARK_RENDERING).size()).toInt());
+      return EXIT_SUCCESS;
+    }
+    else if (argument.startsWith(QL1S(APP_BENCHMARK_PARSING))) {
+      // Just measure parsing of generated feed and quit.
+      ParsingFactory::benchmarkParsing(argument.mid(QString(APP_BENCHMARK_PARSING).size()).toInt());
+      return EXIT_SUCCESS;
+    }
+  }
 
   // Load localization and setup locale before any widget is constructed.
   qApp->localization()->loadActiveLanguage();
+  startup_profiler.finishPhase(QSL("localization"));
 
   // These settings needs to be set before any QSettings object.
   Application::setApplicationName(APP_NAME);
@@ -92,6 +116,7 @@ int main(int argc, char *argv[]) {
 
   // Now is a good time to initialize dynamic keyboard shortcuts.
   DynamicShortcuts::load(qApp->userActions());
+  startup_profiler.finishPhase(QSL("main-window"));
 
   // Display main window.
   if (qApp->settings()->value(GROUP(GUI), SETTING(GUI::MainWindowStartsHidden)).toBool() && SystemTrayIcon::isSystemTrayActivated()) {
@@ -108,9 +133,14 @@ int main(int argc, char *argv[]) {
     qApp->showTrayIcon();
   }
 
+  startup_profiler.finishPhase(QSL("show-window"));
+
   // Load activated accounts.
   qApp->mainForm()->tabWidget()->feedMessageViewer()->feedsView()->sourceModel()->loadActivatedServiceAccounts();
+  startup_profiler.finishPhase(QSL("accounts"));
+
   qApp->mainForm()->tabWidget()->feedMessageViewer()->feedsView()->loadAllExpandStates();
+  startup_profiler.finishPhase(QSL("expand-states"));
 
   // Setup single-instance behavior.
   QObject::connect(&application, &Application::messageReceived, &application, &Application::processExecutionMessage);
@@ -124,7 +154,15 @@ int main(int argc, char *argv[]) {
     qApp->showGuiMessage(QSL(APP_NAME), QObject::tr("Welcome to %1.").arg(APP_NAME), QSystemTrayIcon::NoIcon);
   }
 
-  if (qApp->settings()->value(GROUP(General), SETTING(General::UpdateOnStartup)).toBool()) {
+  // Startup ends when first frame of main window is painted.
+  startup_profiler.waitForFirstFrame(&main_window);
+
+  if (qApp->settings()->value(GROUP(Messages), SETTING(Messages::PreloadPreviewer)).toBool()) {
+    QObject::connect(&startup_profiler, SIGNAL(finished()),
+                     qApp->mainForm()->tabWidget()->feedMessageViewer(), SLOT(preloadMessagePreviewer()));
+  }
+
+  if (qApp->settings()->value(GROUP(General), SETTING(General::UpdateOnStartup)).toBool() && !startup_profiler.quitsAfterStartup()) {
     QTimer::singleShot(STARTUP_UPDATE_DELAY, application.system(), SLOT(checkForUpdatesOnStartup()));
   }
 
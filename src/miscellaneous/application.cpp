@@ -18,6 +18,7 @@
 #include "miscellaneous/application.h"
 
 #include "miscellaneous/iconfactory.h"
+#include "network-web/iconcache.h"
 #include "miscellaneous/iofactory.h"
 #include "miscellaneous/mutex.h"
 #include "gui/feedsview.h"
@@ -42,9 +43,9 @@
 
 Application::Application(const QString &id, int &argc, char **argv)
   : QtSingleApplication(id, argc, argv),
-    m_updateFeedsLock(nullptr), m_feedServices(QList<ServiceEntryPoint*>()), m_userActions(QList<QAction*>()), m_mainForm(nullptr),
+    m_updateFeedsLock(nullptr), m_pendingChangesLock(nullptr), m_feedServices(QList<ServiceEntryPoint*>()), m_userActions(QList<QAction*>()), m_mainForm(nullptr),
     m_trayIcon(nullptr), m_settings(nullptr), m_system(nullptr), m_skins(nullptr),
-    m_localization(nullptr), m_icons(nullptr), m_database(nullptr), m_downloadManager(nullptr) {
+    m_localization(nullptr), m_icons(nullptr), m_iconCache(nullptr), m_database(nullptr), m_downloadManager(nullptr) {
   connect(this, SIGNAL(aboutToQuit()), this, SLOT(onAboutToQuit()));
   connect(this, SIGNAL(commitDataRequest(QSessionManager&)), this, SLOT(onCommitData(QSessionManager&)));
   connect(this, SIGNAL(saveStateRequest(QSessionManager&)), this, SLOT(onSaveState(QSessionManager&)));
@@ -106,6 +107,14 @@ IconFactory *Application::icons() {
   return m_icons;
 }
 
+IconCache *Application::iconCache() {
+  if (m_iconCache == nullptr) {
+    m_iconCache = new IconCache(this);
+  }
+
+  return m_iconCache;
+}
+
 DownloadManager *Application::downloadManager() {
   if (m_downloadManager == nullptr) {
     m_downloadManager = new DownloadManager();
@@ -127,6 +136,14 @@ Mutex *Application::feedUpdateLock() {
   return m_updateFeedsLock.data();
 }
 
+Mutex *Application::pendingChangesLock() {
+  if (m_pendingChangesLock.isNull()) {
+    m_pendingChangesLock.reset(new Mutex());
+  }
+
+  return m_pendingChangesLock.data();
+}
+
 void Application::backupDatabaseSettings(bool backup_database, bool backup_settings,
                                          const QString &target_path, const QString &backup_name) {
   if (!QFileInfo(target_path).isWritable()) {
@@ -272,6 +289,10 @@ void Application::onAboutToQuit() {
   database()->saveDatabase();
   mainForm()->saveSize();
 
+  if (m_iconCache != nullptr) {
+    m_iconCache->saveIndex();
+  }
+
   if (locked_safely) {
     // Application obtained permission to close in a safe way.
     qDebug("Close lock was obtained safely.");
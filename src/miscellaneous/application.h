@@ -43,6 +43,7 @@
 
 class FormMain;
 class IconFactory;
+class IconCache;
 class QAction;
 class Mutex;
 class QWebEngineDownloadItem;
@@ -101,6 +102,7 @@ class Application : public QtSingleApplication {
     }
 
     IconFactory *icons();
+    IconCache *iconCache();
     DownloadManager *downloadManager();
 
     inline Settings *settings() {
@@ -114,6 +116,9 @@ class Application : public QtSingleApplication {
     // Access to application-wide close lock.
     Mutex *feedUpdateLock();
 
+    // Locked while pending changes are pushed to online services.
+    Mutex *pendingChangesLock();
+
     inline FormMain *mainForm() {
       return m_mainForm;
     }
@@ -186,6 +191,7 @@ class Application : public QtSingleApplication {
     // tries to lock the lock for writing), then no other
     // action will be allowed to lock for reading.
     QScopedPointer<Mutex> m_updateFeedsLock;
+    QScopedPointer<Mutex> m_pendingChangesLock;
 
     QList<ServiceEntryPoint*> m_feedServices;
     QList<QAction*> m_userActions;
@@ -196,6 +202,7 @@ class Application : public QtSingleApplication {
     SkinFactory *m_skins;
     Localization *m_localization;
     IconFactory *m_icons;
+    IconCache *m_iconCache;
     DatabaseFactory *m_database;
     DownloadManager *m_downloadManager;
 };
@@ -37,7 +37,7 @@ void DatabaseCleaner::purgeDatabaseData(const CleanerOrders &which_data) {
   emit purgeStarted();
 
   bool result = true;
-  const int difference = 99 / 8;
+  const int difference = 99 / 10;
   int progress = 0;
   QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
 
@@ -63,6 +63,17 @@ void DatabaseCleaner::purgeDatabaseData(const CleanerOrders &which_data) {
     emit purgeProgress(progress, tr("Recycle bin purged..."));
   }
 
+  if (which_data.m_archiveOldMessages) {
+    progress += difference;
+    emit purgeProgress(progress, tr("Moving old messages to archive..."));
+
+    // Move old read messages to archive database.
+    result &= archiveOldMessages(database, which_data.m_barrierForArchivingOldMessagesInDays);
+
+    progress += difference;
+    emit purgeProgress(progress, tr("Old messages archived..."));
+  }
+
   if (which_data.m_removeOldMessages) {
     progress += difference;
     emit purgeProgress(progress, tr("Removing old messages..."));
@@ -88,6 +99,30 @@ void DatabaseCleaner::purgeDatabaseData(const CleanerOrders &which_data) {
   emit purgeFinished(result);
 }
 
+void DatabaseCleaner::compressMessageContents() {
+  qDebug().nospace() << "Compressing contents of messages in thread: \'" << QThread::currentThreadId() << "\'.";
+
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  qint64 saved_bytes = 0;
+  int last_id = 0;
+  int processed_messages;
+  bool result;
+
+  do {
+    processed_messages = DatabaseQueries::compressMessageContents(database, &last_id, &saved_bytes, &result);
+  } while (result && processed_messages > 0 && !QThread::currentThread()->isInterruptionRequested());
+
+  qDebug("Compression of message contents stopped at message %d, %lld bytes saved.", last_id, saved_bytes);
+  emit compressionFinished(result && processed_messages == 0, saved_bytes);
+}
+
+void DatabaseCleaner::archiveMessages(int days) {
+  qDebug().nospace() << "Archiving messages older than " << days << " days in thread: \'" << QThread::currentThreadId() << "\'.";
+
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  emit archivingFinished(archiveOldMessages(database, days));
+}
+
 bool DatabaseCleaner::purgeStarredMessages(const QSqlDatabase &database) {  
   return DatabaseQueries::purgeImportantMessages(database);
 }
@@ -103,3 +138,7 @@ bool DatabaseCleaner::purgeOldMessages(const QSqlDatabase &database, int days) {
 bool DatabaseCleaner::purgeRecycleBin(const QSqlDatabase &database) {
   return DatabaseQueries::purgeRecycleBin(database);
 }
+
+bool DatabaseCleaner::archiveOldMessages(const QSqlDatabase &database, int days) {
+  return DatabaseQueries::archiveOldMessages(database, days);
+}
@@ -29,7 +29,9 @@ struct CleanerOrders {
   bool m_removeOldMessages;
   bool m_removeRecycleBin;
   bool m_removeStarredMessages;
+  bool m_archiveOldMessages;
   int m_barrierForRemovingOldMessagesInDays;
+  int m_barrierForArchivingOldMessagesInDays;
 };
 
 class DatabaseCleaner : public QObject {
@@ -44,15 +46,24 @@ class DatabaseCleaner : public QObject {
     void purgeStarted();
     void purgeProgress(int progress, const QString &description);
     void purgeFinished(bool result);
+    void compressionFinished(bool result, qint64 saved_bytes);
+    void archivingFinished(bool result);
 
   public slots:
     void purgeDatabaseData(const CleanerOrders &which_data);
 
+    // Compresses contents of all stored messages, batch after batch.
+    void compressMessageContents();
+
+    // Moves read messages older than given count of days to archive database.
+    void archiveMessages(int days);
+
   private:
     bool purgeStarredMessages(const QSqlDatabase &database);
     bool purgeReadMessages(const QSqlDatabase &database);
     bool purgeOldMessages(const QSqlDatabase &database, int days);
     bool purgeRecycleBin(const QSqlDatabase &database);
+    bool archiveOldMessages(const QSqlDatabase &database, int days);
 };
 
 #endif // DATABASECLEANER_H
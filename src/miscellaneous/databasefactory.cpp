@@ -25,19 +25,50 @@
 #include <QDir>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlDriver>
 #include <QVariant>
+#include <QTimer>
+
+#if defined(USE_SYSTEM_SQLITE)
+#include <sqlite3.h>
+#endif
 
 
 DatabaseFactory::DatabaseFactory(QObject *parent)
   : QObject(parent),
     m_mysqlDatabaseInitialized(false),
     m_sqliteFileBasedDatabaseinitialized(false),
-    m_sqliteInMemoryDatabaseInitialized(false) {
+    m_sqliteInMemoryDatabaseInitialized(false),
+    m_sqliteSnapshotTimer(new QTimer(this)),
+    m_sqliteSnapshot(nullptr) {
   setObjectName(QSL("DatabaseFactory"));
   determineDriver();
+
+  connect(m_sqliteSnapshotTimer, &QTimer::timeout, this, &DatabaseFactory::sqliteStartMemoryDatabaseSnapshot);
+
+  const int snapshot_interval = qApp->settings()->value(GROUP(Database), SETTING(Database::InMemorySnapshotInterval)).toInt();
+
+  // NOTE: Periodic snapshots need backup API, copying whole
+  // database at once would block GUI thread.
+  if (m_activeDatabaseDriver == SQLITE_MEMORY && snapshot_interval > 0 && supportsMemoryDatabaseSnapshots()) {
+    m_sqliteSnapshotTimer->start(snapshot_interval * 60 * 1000);
+  }
+}
+
+bool DatabaseFactory::supportsMemoryDatabaseSnapshots() {
+#if defined(USE_SYSTEM_SQLITE)
+  return true;
+#else
+  return false;
+#endif
 }
 
 DatabaseFactory::~DatabaseFactory() {
+#if defined(USE_SYSTEM_SQLITE)
+  if (m_sqliteSnapshot != nullptr) {
+    sqlite3_backup_finish(m_sqliteSnapshot);
+  }
+#endif
 }
 
 qint64 DatabaseFactory::getDatabaseFileSize() const {
@@ -206,6 +237,10 @@ QSqlDatabase DatabaseFactory::sqliteInitializeInMemoryDatabase() {
     qFatal("In-memory SQLite database was NOT opened. Delivered error message: '%s'", qPrintable(database.lastError().text()));
   }
   else {
+    // Load data from file-based database. Try to use SQLite backup API, which copies
+    // whole database file page by page, fall back to copying table by table.
+    QSqlDatabase file_database = sqliteConnection(objectName(), StrictlyFileBased);
+    const bool loaded_via_backup = sqliteBackupDatabase(file_database, database);
     QSqlQuery query_db(database);
 
     query_db.setForwardOnly(true);
@@ -253,35 +288,41 @@ QSqlDatabase DatabaseFactory::sqliteInitializeInMemoryDatabase() {
       qDebug("In-memory SQLite database has version '%s'.", qPrintable(query_db.value(0).toString()));
     }
 
-    // Loading messages from file-based database.
-    QSqlDatabase file_database = sqliteConnection(objectName(), StrictlyFileBased);
-    QSqlQuery copy_contents(database);
+    if (loaded_via_backup) {
+      qDebug("Data from file-based database were copied into working in-memory database via backup API.");
+    }
+    else {
+      QSqlQuery copy_contents(database);
 
-    // Attach database.
-    copy_contents.exec(QString("ATTACH DATABASE '%1' AS 'storage';").arg(file_database.databaseName()));
+      // Attach database.
+      copy_contents.exec(QString("ATTACH DATABASE '%1' AS 'storage';").arg(file_database.databaseName()));
 
-    // Copy all stuff.
-    // WARNING: All tables belong here.
-    QStringList tables;
+      // Copy all stuff.
+      // WARNING: All tables belong here.
+      QStringList tables;
 
-    if (copy_contents.exec(QSL("SELECT name FROM storage.sqlite_master WHERE type='table';"))) {
-      while (copy_contents.next()) {
-        tables.append(copy_contents.value(0).toString());
+      if (copy_contents.exec(QSL("SELECT name FROM storage.sqlite_master WHERE type='table';"))) {
+        while (copy_contents.next()) {
+          tables.append(copy_contents.value(0).toString());
+        }
+      }
+      else {
+        qFatal("Cannot obtain list of table names from file-base SQLite database.");
       }
-    }
-    else {
-      qFatal("Cannot obtain list of table names from file-base SQLite database.");
-    }
 
-    foreach (const QString &table, tables) {
-      copy_contents.exec(QString("INSERT INTO main.%1 SELECT * FROM storage.%1;").arg(table));
-    }
+      database.transaction();
+
+      foreach (const QString &table, tables) {
+        copy_contents.exec(QString("INSERT INTO main.%1 SELECT * FROM storage.%1;").arg(table));
+      }
 
-    qDebug("Copying data from file-based database into working in-memory database.");
+      database.commit();
+      qDebug("Copying data from file-based database into working in-memory database.");
 
-    // Detach database and finish.
-    copy_contents.exec(QSL("DETACH 'storage'"));
-    copy_contents.finish();
+      // Detach database and finish.
+      copy_contents.exec(QSL("DETACH 'storage'"));
+      copy_contents.finish();
+    }
 
     query_db.finish();
   }
@@ -326,8 +367,12 @@ QSqlDatabase DatabaseFactory::sqliteInitializeFileBasedDatabase(const QString &c
     query_db.setForwardOnly(true);
     query_db.exec(QSL("PRAGMA encoding = \"UTF-8\""));
     query_db.exec(QSL("PRAGMA synchronous = OFF"));
-    query_db.exec(QSL("PRAGMA journal_mode = MEMORY"));
     query_db.exec(QSL("PRAGMA page_size = 4096"));
+
+    // Readers do not block writers in WAL mode, so that message list, which
+    // keeps its statement open while rows are fetched, does not block writes
+    // done by other connections. Mode is persistent, all connections use it.
+    query_db.exec(QSL("PRAGMA journal_mode = WAL"));
     query_db.exec(QSL("PRAGMA cache_size = 16384"));
     query_db.exec(QSL("PRAGMA count_changes = OFF"));
     query_db.exec(QSL("PRAGMA temp_store = MEMORY"));
@@ -396,6 +441,71 @@ QString DatabaseFactory::sqliteDatabaseFilePath() const {
   return m_sqliteDatabaseFilePath + QDir::separator() + APP_DB_SQLITE_FILE;
 }
 
+QString DatabaseFactory::sqliteArchiveFilePath() const {
+  return m_sqliteDatabaseFilePath + QDir::separator() + APP_DB_SQLITE_ARCHIVE_FILE;
+}
+
+bool DatabaseFactory::attachArchiveDatabase(QSqlDatabase database, bool create_if_missing) {
+  if (m_activeDatabaseDriver == MYSQL) {
+    return false;
+  }
+
+  QSqlQuery query_db(database);
+  query_db.setForwardOnly(true);
+
+  if (query_db.exec(QSL("PRAGMA database_list"))) {
+    while (query_db.next()) {
+      if (query_db.value(1).toString() == QL1S("archive")) {
+        // Archive is already attached to this connection.
+        return true;
+      }
+    }
+  }
+
+  const QString archive_file_path = sqliteArchiveFilePath();
+
+  if (!create_if_missing && !QFile::exists(archive_file_path)) {
+    return false;
+  }
+
+  query_db.prepare(QSL("ATTACH DATABASE :file AS 'archive';"));
+  query_db.bindValue(QSL(":file"), archive_file_path);
+
+  if (!query_db.exec()) {
+    qWarning("Archive database '%s' was NOT attached. Delivered error message: '%s'.",
+             qPrintable(QDir::toNativeSeparators(archive_file_path)),
+             qPrintable(query_db.lastError().text()));
+    return false;
+  }
+
+  QFile file_init(APP_MISC_PATH + QDir::separator() + APP_DB_SQLITE_ARCHIVE_INIT);
+
+  if (!file_init.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qCritical("SQLite archive initialization file '%s' from directory '%s' was not found.",
+              APP_DB_SQLITE_ARCHIVE_INIT,
+              qPrintable(APP_MISC_PATH));
+    query_db.exec(QSL("DETACH DATABASE 'archive';"));
+    return false;
+  }
+
+  const QStringList statements = QString(file_init.readAll()).split(APP_DB_COMMENT_SPLIT, QString::SkipEmptyParts);
+
+  foreach(const QString &statement, statements) {
+    if (!query_db.exec(statement)) {
+      qCritical("SQLite archive initialization failed. Delivered error message: '%s'.",
+                qPrintable(query_db.lastError().text()));
+      query_db.exec(QSL("DETACH DATABASE 'archive';"));
+      return false;
+    }
+  }
+
+  // Archive is searched by message list, it must not block archiving either.
+  query_db.exec(QSL("PRAGMA archive.journal_mode = WAL"));
+
+  qDebug("Archive database '%s' attached.", qPrintable(QDir::toNativeSeparators(archive_file_path)));
+  return true;
+}
+
 bool DatabaseFactory::sqliteUpdateDatabaseSchema(QSqlDatabase database, const QString &source_db_schema_version) {
   int working_version = QString(source_db_schema_version).remove('.').toInt();
   const int current_version = QString(APP_DB_SCHEMA_VERSION).remove('.').toInt();
@@ -524,8 +634,22 @@ void DatabaseFactory::removeConnection(const QString &connection_name) {
 void DatabaseFactory::sqliteSaveMemoryDatabase() {
   qDebug("Saving in-memory working database back to persistent file-based storage.");
 
+#if defined(USE_SYSTEM_SQLITE)
+  if (m_sqliteSnapshot != nullptr) {
+    // Periodic snapshot is running, cancel it, we save everything now anyway.
+    sqlite3_backup_finish(m_sqliteSnapshot);
+    m_sqliteSnapshot = nullptr;
+  }
+#endif
+
   QSqlDatabase database = sqliteConnection(objectName(), StrictlyInMemory);
   QSqlDatabase file_database = sqliteConnection(objectName(), StrictlyFileBased);
+
+  if (sqliteBackupDatabase(database, file_database)) {
+    qDebug("In-memory database was saved via backup API.");
+    return;
+  }
+
   QSqlQuery copy_contents(database);
 
   // Attach database.
@@ -544,16 +668,134 @@ void DatabaseFactory::sqliteSaveMemoryDatabase() {
     qFatal("Cannot obtain list of table names from file-base SQLite database.");
   }
 
+  database.transaction();
+
   foreach (const QString &table, tables) {
     copy_contents.exec(QString(QSL("DELETE FROM storage.%1;")).arg(table));
     copy_contents.exec(QString(QSL("INSERT INTO storage.%1 SELECT * FROM main.%1;")).arg(table));
   }
 
+  database.commit();
+
   // Detach database and finish.
   copy_contents.exec(QSL("DETACH 'storage'"));
   copy_contents.finish();
 }
 
+bool DatabaseFactory::sqliteBackupDatabase(QSqlDatabase source, QSqlDatabase destination) {
+#if defined(USE_SYSTEM_SQLITE)
+  sqlite3 *source_handle = sqliteHandle(source);
+  sqlite3 *destination_handle = sqliteHandle(destination);
+
+  if (source_handle == nullptr || destination_handle == nullptr) {
+    return false;
+  }
+
+  sqlite3_backup *backup = sqlite3_backup_init(destination_handle, "main", source_handle, "main");
+
+  if (backup == nullptr) {
+    qWarning("SQLite backup cannot be started: '%s'.", sqlite3_errmsg(destination_handle));
+    return false;
+  }
+
+  int result;
+
+  do {
+    result = sqlite3_backup_step(backup, APP_DB_SQLITE_BACKUP_PAGES);
+
+    if (result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+      sqlite3_sleep(APP_DB_SQLITE_BACKUP_DELAY);
+    }
+  } while (result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED);
+
+  sqlite3_backup_finish(backup);
+
+  if (result != SQLITE_DONE) {
+    qWarning("SQLite backup failed: '%s'.", sqlite3_errstr(result));
+    return false;
+  }
+  else {
+    return true;
+  }
+#else
+  Q_UNUSED(source)
+  Q_UNUSED(destination)
+
+  return false;
+#endif
+}
+
+sqlite3 *DatabaseFactory::sqliteHandle(const QSqlDatabase &database) {
+#if defined(USE_SYSTEM_SQLITE)
+  const QVariant handle = database.driver()->handle();
+
+  if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+    return *static_cast<sqlite3* const*>(handle.data());
+  }
+#else
+  Q_UNUSED(database)
+#endif
+
+  return nullptr;
+}
+
+void DatabaseFactory::sqliteStartMemoryDatabaseSnapshot() {
+  if (!m_sqliteInMemoryDatabaseInitialized || m_sqliteSnapshot != nullptr) {
+    // Database is not loaded yet or previous snapshot is still running.
+    return;
+  }
+
+#if defined(USE_SYSTEM_SQLITE)
+  sqlite3 *source_handle = sqliteHandle(sqliteConnection(objectName(), StrictlyInMemory));
+  sqlite3 *destination_handle = sqliteHandle(sqliteConnection(objectName(), StrictlyFileBased));
+
+  if (source_handle != nullptr && destination_handle != nullptr) {
+    m_sqliteSnapshot = sqlite3_backup_init(destination_handle, "main", source_handle, "main");
+
+    if (m_sqliteSnapshot != nullptr) {
+      // Copy database in small steps, so that GUI and
+      // feed updates are not blocked.
+      qDebug("Starting snapshot of in-memory database.");
+      QTimer::singleShot(0, this, SLOT(sqliteContinueMemoryDatabaseSnapshot()));
+      return;
+    }
+    else {
+      qWarning("Snapshot of in-memory database cannot be started: '%s'.", sqlite3_errmsg(destination_handle));
+    }
+  }
+#endif
+
+  // Whole database is not saved at once here, it would block GUI thread,
+  // it is saved when application quits.
+  qWarning("Skipping snapshot of in-memory database, backup API is not available.");
+}
+
+void DatabaseFactory::sqliteContinueMemoryDatabaseSnapshot() {
+#if defined(USE_SYSTEM_SQLITE)
+  if (m_sqliteSnapshot == nullptr) {
+    return;
+  }
+
+  const int result = sqlite3_backup_step(m_sqliteSnapshot, APP_DB_SQLITE_BACKUP_PAGES);
+
+  if (result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+    // There are still some pages left to copy.
+    QTimer::singleShot(APP_DB_SQLITE_BACKUP_DELAY, this, SLOT(sqliteContinueMemoryDatabaseSnapshot()));
+  }
+  else {
+    sqlite3_backup_finish(m_sqliteSnapshot);
+    m_sqliteSnapshot = nullptr;
+
+    if (result == SQLITE_DONE) {
+      qDebug("Snapshot of in-memory database was saved.");
+    }
+    else {
+      qWarning("Snapshot of in-memory database failed: '%s'.", sqlite3_errstr(result));
+    }
+  }
+#endif
+}
+
 void DatabaseFactory::determineDriver() {
   const QString db_driver = qApp->settings()->value(GROUP(Database), SETTING(Database::ActiveDriver)).toString();
 
@@ -22,6 +22,10 @@
 #include <QSqlDatabase>
 
 
+class QTimer;
+struct sqlite3;
+struct sqlite3_backup;
+
 class DatabaseFactory : public QObject {
     Q_OBJECT
 
@@ -98,6 +102,16 @@ class DatabaseFactory : public QObject {
     // SQLITE stuff.
     //
     QString sqliteDatabaseFilePath() const;
+    QString sqliteArchiveFilePath() const;
+
+    // Returns true if in-memory database can be periodically
+    // saved in background, this requires SQLite backup API.
+    static bool supportsMemoryDatabaseSnapshots();
+
+    // Attaches archive database (as "archive" schema) to given connection
+    // and initializes it if needed. Archive database is available only
+    // for SQLite backends, false is returned otherwise.
+    bool attachArchiveDatabase(QSqlDatabase database, bool create_if_missing = true);
 
     //
     // MySQL stuff.
@@ -112,6 +126,12 @@ class DatabaseFactory : public QObject {
     // Interprets MySQL error code.
     QString mysqlInterpretErrorCode(MySQLError error_code) const;
 
+  private slots:
+    // Starts/continues incremental saving of in-memory
+    // database into file-based database.
+    void sqliteStartMemoryDatabaseSnapshot();
+    void sqliteContinueMemoryDatabaseSnapshot();
+
   private:
     //
     // GENERAL stuff.
@@ -157,6 +177,15 @@ class DatabaseFactory : public QObject {
     // to file-based database.
     void sqliteSaveMemoryDatabase();
 
+    // Copies whole "source" database into "destination" database via
+    // SQLite online backup API. Returns false if backup API
+    // is not available or if copying fails.
+    bool sqliteBackupDatabase(QSqlDatabase source, QSqlDatabase destination);
+
+    // Returns native SQLite handle of given connection or NULL
+    // if SQLite online backup API is not available.
+    static sqlite3 *sqliteHandle(const QSqlDatabase &database);
+
     // Assemblies database file path.
     void sqliteAssemblyDatabaseFilePath();
 
@@ -174,6 +203,10 @@ class DatabaseFactory : public QObject {
     // Is database file initialized?
     bool m_sqliteFileBasedDatabaseinitialized;
     bool m_sqliteInMemoryDatabaseInitialized;
+
+    // Periodic snapshots of in-memory database.
+    QTimer *m_sqliteSnapshotTimer;
+    sqlite3_backup *m_sqliteSnapshot;
 };
 
 #endif // DATABASEFACTORY_H
@@ -32,18 +32,30 @@
 #include "miscellaneous/textfactory.h"
 #include "miscellaneous/application.h"
 #include "miscellaneous/iconfactory.h"
+#include "network-web/iconcache.h"
 
 #include <QVariant>
-#include <QUrl>
 #include <QSqlError>
+#include <QSqlRecord>
+#include <QThread>
 
 
+QAtomicInt DatabaseQueries::s_messageStateGeneration = 0;
+QHash<QString,int> DatabaseQueries::s_messageStateGenerations;
+QMutex DatabaseQueries::s_messageStateMutex;
+
 bool DatabaseQueries::markMessagesReadUnread(QSqlDatabase db, const QStringList &ids, RootItem::ReadStatus read) {
   QSqlQuery q(db);
   q.setForwardOnly(true);
 
-  return q.exec(QString(QSL("UPDATE Messages SET is_read = %2 WHERE id IN (%1);"))
-                .arg(ids.join(QSL(", ")), read == RootItem::Read ? QSL("1") : QSL("0")));
+  if (q.exec(QString(QSL("UPDATE Messages SET is_read = %2 WHERE id IN (%1);"))
+            .arg(ids.join(QSL(", ")), read == RootItem::Read ? QSL("1") : QSL("0")))) {
+    notifyMessageStateChanged(db, ids);
+    return true;
+  }
+  else {
+    return false;
+  }
 }
 
 bool DatabaseQueries::markMessageImportant(QSqlDatabase db, int id, RootItem::Importance importance) {
@@ -59,7 +71,13 @@ bool DatabaseQueries::markMessageImportant(QSqlDatabase db, int id, RootItem::Im
   q.bindValue(QSL(":important"), (int) importance);
 
   // Commit changes.
-  return q.exec();
+  if (q.exec()) {
+    notifyMessageStateChanged(db, QStringList() << QString::number(id));
+    return true;
+  }
+  else {
+    return false;
+  }
 }
 
 bool DatabaseQueries::markFeedsReadUnread(QSqlDatabase db, const QStringList &ids, int account_id, RootItem::ReadStatus read) {
@@ -71,7 +89,13 @@ bool DatabaseQueries::markFeedsReadUnread(QSqlDatabase db, const QStringList &id
   q.bindValue(QSL(":read"), read == RootItem::Read ? 1 : 0);
   q.bindValue(QSL(":account_id"), account_id);
 
-  return q.exec();
+  if (q.exec()) {
+    notifyMessageStateChanged(account_id, ids);
+    return true;
+  }
+  else {
+    return false;
+  }
 }
 
 bool DatabaseQueries::markBinReadUnread(QSqlDatabase db, int account_id, RootItem::ReadStatus read) {
@@ -83,7 +107,13 @@ bool DatabaseQueries::markBinReadUnread(QSqlDatabase db, int account_id, RootIte
   q.bindValue(QSL(":read"), read == RootItem::Read ? 1 : 0);
   q.bindValue(QSL(":account_id"), account_id);
 
-  return q.exec();
+  if (q.exec()) {
+    notifyMessageStateChanged(account_id);
+    return true;
+  }
+  else {
+    return false;
+  }
 }
 
 bool DatabaseQueries::markAccountReadUnread(QSqlDatabase db, int account_id, RootItem::ReadStatus read) {
@@ -94,14 +124,26 @@ bool DatabaseQueries::markAccountReadUnread(QSqlDatabase db, int account_id, Roo
   q.bindValue(QSL(":account_id"), account_id);
   q.bindValue(QSL(":read"), read == RootItem::Read ? 1 : 0);
 
-  return q.exec();
+  if (q.exec()) {
+    notifyMessageStateChanged(account_id);
+    return true;
+  }
+  else {
+    return false;
+  }
 }
 
 bool DatabaseQueries::switchMessagesImportance(QSqlDatabase db, const QStringList &ids) {
   QSqlQuery q(db);
   q.setForwardOnly(true);
 
-  return q.exec(QString(QSL("UPDATE Messages SET is_important = NOT is_important WHERE id IN (%1);")).arg(ids.join(QSL(", "))));
+  if (q.exec(QString(QSL("UPDATE Messages SET is_important = NOT is_important WHERE id IN (%1);")).arg(ids.join(QSL(", "))))) {
+    notifyMessageStateChanged(db, ids);
+    return true;
+  }
+  else {
+    return false;
+  }
 }
 
 bool DatabaseQueries::permanentlyDeleteMessages(QSqlDatabase db, const QStringList &ids) {
@@ -129,12 +171,166 @@ bool DatabaseQueries::restoreBin(QSqlDatabase db, int account_id) {
   return q.exec();
 }
 
+bool DatabaseQueries::recordPendingChanges(QSqlDatabase db, int account_id, const QList<PendingChange> &changes,
+                                           const QSet<int> &pushed_ids) {
+  QSqlQuery q_select(db);
+  QSqlQuery q_delete(db);
+  QSqlQuery q_insert(db);
+
+  q_select.setForwardOnly(true);
+  q_select.prepare(QSL("SELECT id, change_value FROM PendingChanges "
+                       "WHERE account_id = :account_id AND change_type = :change_type AND custom_id = :custom_id "
+                       "ORDER BY id DESC LIMIT 1;"));
+  q_delete.setForwardOnly(true);
+  q_delete.prepare(QSL("DELETE FROM PendingChanges WHERE id = :id;"));
+  q_insert.setForwardOnly(true);
+  q_insert.prepare(QSL("INSERT INTO PendingChanges (account_id, change_type, change_value, custom_id, feed, custom_hash) "
+                       "VALUES (:account_id, :change_type, :change_value, :custom_id, :feed, :custom_hash);"));
+
+  if (!db.transaction()) {
+    qWarning("Starting transaction for recording of pending changes failed: '%s'.", qPrintable(db.lastError().text()));
+    return false;
+  }
+
+  foreach (const PendingChange &change, changes) {
+    q_select.bindValue(QSL(":account_id"), account_id);
+    q_select.bindValue(QSL(":change_type"), (int) change.m_type);
+    q_select.bindValue(QSL(":custom_id"), change.m_customId);
+
+    if (!q_select.exec()) {
+      qWarning("Selecting of pending change failed: '%s'.", qPrintable(q_select.lastError().text()));
+      db.rollback();
+      return false;
+    }
+
+    bool succeeded = true;
+    bool insert = true;
+
+    // Only the latest recorded change of the message matters.
+    if (q_select.next()) {
+      const int recorded_id = q_select.value(0).toInt();
+      const int recorded_value = q_select.value(1).toInt();
+
+      q_select.finish();
+
+      if (recorded_value == change.m_value) {
+        // The same change is already waiting for push.
+        continue;
+      }
+      else if (!pushed_ids.contains(recorded_id)) {
+        // Change reverts change which was not pushed yet, so both
+        // changes cancel each other out.
+        q_delete.bindValue(QSL(":id"), recorded_id);
+        succeeded = q_delete.exec();
+        insert = false;
+      }
+
+      // Otherwise reverted change is just being pushed,
+      // so this one must be pushed after it.
+    }
+    else {
+      q_select.finish();
+    }
+
+    if (insert) {
+      q_insert.bindValue(QSL(":account_id"), account_id);
+      q_insert.bindValue(QSL(":change_type"), (int) change.m_type);
+      q_insert.bindValue(QSL(":change_value"), change.m_value);
+      q_insert.bindValue(QSL(":custom_id"), change.m_customId);
+      q_insert.bindValue(QSL(":feed"), change.m_feedId);
+      q_insert.bindValue(QSL(":custom_hash"), change.m_customHash);
+      succeeded = q_insert.exec();
+    }
+
+    if (!succeeded) {
+      qWarning("Recording of pending change failed: '%s'.", qPrintable(db.lastError().text()));
+      db.rollback();
+      return false;
+    }
+  }
+
+  if (!db.commit()) {
+    qWarning("Committing pending changes failed: '%s'.", qPrintable(db.lastError().text()));
+    db.rollback();
+    return false;
+  }
+
+  return true;
+}
+
+QList<PendingChange> DatabaseQueries::getPendingChanges(QSqlDatabase db, int account_id, int limit, bool *ok) {
+  QList<PendingChange> changes;
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QString("SELECT id, change_type, change_value, custom_id, feed, custom_hash FROM PendingChanges "
+                    "WHERE account_id = :account_id ORDER BY id LIMIT %1;").arg(limit));
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (q.exec()) {
+    while (q.next()) {
+      PendingChange change;
+
+      change.m_id = q.value(0).toInt();
+      change.m_type = (PendingChange::Type) q.value(1).toInt();
+      change.m_value = q.value(2).toInt();
+      change.m_customId = q.value(3).toString();
+      change.m_feedId = q.value(4).toString();
+      change.m_customHash = q.value(5).toString();
+      changes.append(change);
+    }
+
+    if (ok != nullptr) {
+      *ok = true;
+    }
+  }
+  else {
+    qWarning("Loading of pending changes failed: '%s'.", qPrintable(q.lastError().text()));
+
+    if (ok != nullptr) {
+      *ok = false;
+    }
+  }
+
+  return changes;
+}
+
+bool DatabaseQueries::removePendingChanges(QSqlDatabase db, const QList<PendingChange> &changes) {
+  if (changes.isEmpty()) {
+    return true;
+  }
+
+  QStringList ids;
+  ids.reserve(changes.size());
+
+  foreach (const PendingChange &change, changes) {
+    ids.append(QString::number(change.m_id));
+  }
+
+  QSqlQuery q(db);
+  q.setForwardOnly(true);
+
+  if (q.exec(QString("DELETE FROM PendingChanges WHERE id IN (%1);").arg(ids.join(QSL(", "))))) {
+    return true;
+  }
+  else {
+    qWarning("Removing of pending changes failed: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+}
+
 bool DatabaseQueries::purgeImportantMessages(QSqlDatabase db) {
   QSqlQuery q(db);
   q.setForwardOnly(true);
   q.prepare(QSL("DELETE FROM Messages WHERE is_important = 1;"));
 
-  return q.exec();
+  if (q.exec()) {
+    notifyMessageStateChanged();
+    return true;
+  }
+  else {
+    return false;
+  }
 }
 
 bool DatabaseQueries::purgeReadMessages(QSqlDatabase db) {
@@ -149,7 +345,13 @@ bool DatabaseQueries::purgeReadMessages(QSqlDatabase db) {
   // Remove only messages which are NOT starred.
   q.bindValue(QSL(":is_important"), 0);
 
-  return q.exec();
+  if (q.exec()) {
+    notifyMessageStateChanged();
+    return true;
+  }
+  else {
+    return false;
+  }
 }
 
 bool DatabaseQueries::purgeOldMessages(QSqlDatabase db, int older_than_days) {
@@ -163,7 +365,224 @@ bool DatabaseQueries::purgeOldMessages(QSqlDatabase db, int older_than_days) {
   // Remove only messages which are NOT starred.
   q.bindValue(QSL(":is_important"), 0);
 
-  return q.exec();
+  if (q.exec()) {
+    notifyMessageStateChanged();
+    return true;
+  }
+  else {
+    return false;
+  }
+}
+
+bool DatabaseQueries::archiveOldMessages(QSqlDatabase db, int older_than_days) {
+  if (!qApp->database()->attachArchiveDatabase(db)) {
+    return false;
+  }
+
+  const qint64 since_epoch = QDateTime::currentDateTimeUtc().addDays(-older_than_days).toMSecsSinceEpoch();
+  QSqlQuery q_select(db);
+  QSqlQuery q_insert(db);
+  QSqlQuery q_delete(db);
+  int archived_messages = 0;
+
+  // Messages are moved in batches, each in its own transaction, so that
+  // main database is not locked for too long.
+  q_select.setForwardOnly(true);
+  q_select.prepare(QString("SELECT * FROM main.Messages "
+                           "WHERE is_read = 1 AND is_important = 0 AND is_deleted = 0 AND is_pdeleted = 0 AND date_created < :date_created "
+                           "ORDER BY account_id, feed, date_created LIMIT %1;").arg(APP_DB_ARCHIVE_BATCH_SIZE));
+  q_insert.setForwardOnly(true);
+  q_insert.prepare(QSL("INSERT INTO archive.Messages "
+                       "(is_read, is_deleted, is_important, feed, title, url, author, date_created, contents, "
+                       "is_pdeleted, enclosures, account_id, custom_id, custom_hash) "
+                       "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);"));
+  q_delete.setForwardOnly(true);
+  q_delete.prepare(QSL("DELETE FROM main.Messages WHERE id = :id;"));
+
+  forever {
+    QList<QSqlRecord> records;
+
+    q_select.bindValue(QSL(":date_created"), since_epoch);
+
+    if (!q_select.exec()) {
+      qWarning("Selecting messages for archiving failed: '%s'.", qPrintable(q_select.lastError().text()));
+      return false;
+    }
+
+    while (q_select.next()) {
+      records.append(q_select.record());
+    }
+
+    q_select.finish();
+
+    if (records.isEmpty()) {
+      break;
+    }
+
+    if (!db.transaction()) {
+      qWarning("Starting transaction for archiving of messages failed: '%s'.", qPrintable(db.lastError().text()));
+      return false;
+    }
+
+    foreach (const QSqlRecord &record, records) {
+      for (int i = MSG_DB_READ_INDEX; i <= MSG_DB_CUSTOM_HASH_INDEX; i++) {
+        if (i == MSG_DB_CONTENTS_INDEX) {
+          q_insert.addBindValue(qCompress(Message::decompressContents(record.value(i).toString()).toUtf8()));
+        }
+        else {
+          q_insert.addBindValue(record.value(i));
+        }
+      }
+
+      q_delete.bindValue(QSL(":id"), record.value(MSG_DB_ID_INDEX));
+
+      if (!q_insert.exec() || !q_delete.exec()) {
+        qWarning("Moving message to archive failed: '%s'.",
+                 qPrintable(q_insert.lastError().isValid() ? q_insert.lastError().text() : q_delete.lastError().text()));
+        db.rollback();
+        return false;
+      }
+    }
+
+    if (!db.commit()) {
+      qWarning("Committing archived messages failed: '%s'.", qPrintable(db.lastError().text()));
+      db.rollback();
+      return false;
+    }
+
+    archived_messages += records.size();
+    notifyMessageStateChanged();
+
+    if (records.size() < APP_DB_ARCHIVE_BATCH_SIZE || QThread::currentThread()->isInterruptionRequested()) {
+      // All messages are archived or application is quitting,
+      // remaining messages are archived next time.
+      break;
+    }
+  }
+
+  qDebug("Moved %d messages to archive database.", archived_messages);
+  return true;
+}
+
+int DatabaseQueries::compressMessageContents(QSqlDatabase db, int *last_id, qint64 *saved_bytes, bool *ok) {
+  QSqlQuery q_select(db);
+  QSqlQuery q_update(db);
+  QList<QPair<int,QString> > compressed_contents;
+  int processed_messages = 0;
+  qint64 batch_saved_bytes = 0;
+
+  q_select.setForwardOnly(true);
+  q_select.prepare(QString("SELECT id, contents FROM Messages WHERE id > :id AND LENGTH(contents) >= :threshold "
+                           "ORDER BY id LIMIT %1;").arg(CONTENTS_COMPRESSION_BATCH_SIZE));
+  q_select.bindValue(QSL(":id"), *last_id);
+  q_select.bindValue(QSL(":threshold"), CONTENTS_COMPRESSION_THRESHOLD);
+
+  // Messages are selected and updated within single transaction, so that
+  // contents changed by concurrent feed update are not overwritten.
+  if (!db.transaction()) {
+    qWarning("Starting transaction for compression of messages failed: '%s'.", qPrintable(db.lastError().text()));
+
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    return 0;
+  }
+
+  if (!q_select.exec()) {
+    qWarning("Selecting messages for compression failed: '%s'.", qPrintable(q_select.lastError().text()));
+    db.rollback();
+
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    return 0;
+  }
+
+  while (q_select.next()) {
+    const QString contents = q_select.value(1).toString();
+    const QString compressed = Message::compressContents(contents);
+
+    *last_id = q_select.value(0).toInt();
+    processed_messages++;
+
+    if (compressed.size() < contents.size()) {
+      compressed_contents.append(QPair<int,QString>(*last_id, compressed));
+      batch_saved_bytes += contents.toUtf8().size() - compressed.size();
+    }
+  }
+
+  q_select.finish();
+
+  q_update.setForwardOnly(true);
+  q_update.prepare(QSL("UPDATE Messages SET contents = :contents WHERE id = :id;"));
+
+  for (int i = 0; i < compressed_contents.size(); i++) {
+    q_update.bindValue(QSL(":contents"), compressed_contents.at(i).second);
+    q_update.bindValue(QSL(":id"), compressed_contents.at(i).first);
+
+    if (!q_update.exec()) {
+      qWarning("Storing compressed contents of message failed: '%s'.", qPrintable(q_update.lastError().text()));
+      db.rollback();
+
+      if (ok != nullptr) {
+        *ok = false;
+      }
+
+      return 0;
+    }
+  }
+
+  if (!db.commit()) {
+    qWarning("Committing compressed messages failed: '%s'.", qPrintable(db.lastError().text()));
+    db.rollback();
+
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    return 0;
+  }
+
+  *saved_bytes += batch_saved_bytes;
+
+  if (ok != nullptr) {
+    *ok = true;
+  }
+
+  return processed_messages;
+}
+
+bool DatabaseQueries::getContentsCompressionStats(QSqlDatabase db, int *compressed_messages, qint64 *saved_bytes) {
+  const int prefix_length = int(qstrlen(CONTENTS_COMPRESSED_PREFIX));
+  QSqlQuery q(db);
+
+  // Only beginning of stored contents is needed to get original size of contents.
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT SUBSTR(contents, 1, :header_length), LENGTH(contents) FROM Messages "
+                "WHERE SUBSTR(contents, 1, :prefix_length) = :prefix;"));
+  q.bindValue(QSL(":header_length"), prefix_length + 8);
+  q.bindValue(QSL(":prefix_length"), prefix_length);
+  q.bindValue(QSL(":prefix"), QSL(CONTENTS_COMPRESSED_PREFIX));
+
+  *compressed_messages = 0;
+  *saved_bytes = 0;
+
+  if (!q.exec()) {
+    return false;
+  }
+
+  while (q.next()) {
+    const int original_size = Message::uncompressedContentsSize(q.value(0).toString());
+
+    if (original_size >= 0) {
+      (*compressed_messages)++;
+      *saved_bytes += original_size - q.value(1).toLongLong();
+    }
+  }
+
+  return true;
 }
 
 bool DatabaseQueries::purgeRecycleBin(QSqlDatabase db) {
@@ -176,7 +595,13 @@ bool DatabaseQueries::purgeRecycleBin(QSqlDatabase db) {
   // Remove only messages which are NOT starred.
   q.bindValue(QSL(":is_important"), 0);
 
-  return q.exec();
+  if (q.exec()) {
+    notifyMessageStateChanged();
+    return true;
+  }
+  else {
+    return false;
+  }
 }
 
 QMap<int,QPair<int,int> > DatabaseQueries::getMessageCountsForCategory(QSqlDatabase db, int custom_id, int account_id,
@@ -338,99 +763,145 @@ int DatabaseQueries::getMessageCountsForBin(QSqlDatabase db, int account_id, boo
   }
 }
 
-QList<Message> DatabaseQueries::getUndeletedMessagesForFeed(QSqlDatabase db, int feed_custom_id, int account_id, bool *ok) {
-  QList<Message> messages;
-  QSqlQuery q(db);
-  q.setForwardOnly(true);
-  q.prepare("SELECT * "
-            "FROM Messages "
-            "WHERE is_deleted = 0 AND is_pdeleted = 0 AND feed = :feed AND account_id = :account_id;");
+MessagesCursor DatabaseQueries::getUndeletedMessagesCursorForFeeds(const QList<int> &feed_custom_ids, int account_id,
+                                                                   bool include_archived, MessagesCursor::Columns columns) {
+  if (feed_custom_ids.isEmpty()) {
+    return MessagesCursor();
+  }
 
-  q.bindValue(QSL(":feed"), feed_custom_id);
-  q.bindValue(QSL(":account_id"), account_id);
+  QStringList textual_ids;
+  QVariantHash bindings;
 
-  if (q.exec()) {
-    while (q.next()) {
-      bool decoded;
-      Message message = Message::fromSqlRecord(q.record(), &decoded);
+  foreach (int feed_custom_id, feed_custom_ids) {
+    textual_ids.append(QString(QSL("'%1'")).arg(feed_custom_id));
+  }
 
-      if (decoded) {
-        messages.append(message);
-      }
-    }
+  bindings.insert(QSL(":account_id"), account_id);
 
-    if (ok != nullptr) {
-      *ok = true;
-    }
-  }
-  else {
-    if (ok != nullptr) {
-      *ok = false;
-    }
-  }
+  return MessagesCursor(QString(QSL("is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id AND feed IN (%1)")).arg(textual_ids.join(QSL(", "))),
+                        bindings, include_archived, columns);
+}
 
-  return messages;
+MessagesCursor DatabaseQueries::getUndeletedMessagesCursorForBin(int account_id, MessagesCursor::Columns columns) {
+  QVariantHash bindings;
+
+  bindings.insert(QSL(":account_id"), account_id);
+  return MessagesCursor(QSL("is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id"), bindings, false, columns);
 }
 
-QList<Message> DatabaseQueries::getUndeletedMessagesForBin(QSqlDatabase db, int account_id, bool *ok) {
-  QList<Message> messages;
-  QSqlQuery q(db);
-  q.setForwardOnly(true);
-  q.prepare("SELECT * "
-            "FROM Messages "
-            "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;");
+MessagesCursor DatabaseQueries::getUndeletedMessagesCursorForAccount(int account_id, bool include_archived,
+                                                                     MessagesCursor::Columns columns) {
+  QVariantHash bindings;
 
-  q.bindValue(QSL(":account_id"), account_id);
+  bindings.insert(QSL(":account_id"), account_id);
+  return MessagesCursor(QSL("is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id"), bindings, include_archived, columns);
+}
 
-  if (q.exec()) {
-    while (q.next()) {
-      bool decoded;
-      Message message = Message::fromSqlRecord(q.record(), &decoded);
+QList<Message> DatabaseQueries::fetchNextMessages(QSqlDatabase db, MessagesCursor &cursor, int count, bool *ok) {
+  QList<Message> messages;
 
-      if (decoded) {
-        messages.append(message);
-      }
+  if (ok != nullptr) {
+    *ok = true;
+  }
+
+  // Columns which were not requested are selected as NULLs, so
+  // that records still have layout expected by Message::fromSqlRecord().
+  const bool with_contents = cursor.m_columns.testFlag(MessagesCursor::ContentsColumn);
+  const QString selected_columns = QString(QSL("id, is_read, is_deleted, is_important, feed, %1, date_created, %2, "
+                                               "is_pdeleted, %3, account_id, custom_id, custom_hash")).arg(
+                                     cursor.m_columns.testFlag(MessagesCursor::TextColumns) ?
+                                       QSL("title, url, author") :
+                                       QSL("NULL AS title, NULL AS url, NULL AS author"),
+                                     with_contents ? QSL("contents") : QSL("NULL AS contents"),
+                                     cursor.m_columns.testFlag(MessagesCursor::EnclosuresColumn) ?
+                                       QSL("enclosures") :
+                                       QSL("NULL AS enclosures"));
+
+  while (!cursor.m_atEnd && messages.size() < count) {
+    if (cursor.m_inArchive && !qApp->database()->attachArchiveDatabase(db, false)) {
+      // There are no archived messages.
+      cursor.m_atEnd = true;
+      break;
     }
 
-    if (ok != nullptr) {
-      *ok = true;
+    // Keyset pagination, next chunk starts right after last returned message,
+    // so that reading of each chunk uses index and does not skip any rows.
+    const QString position_condition = cursor.m_lastId < 0 ?
+                                         QString() :
+                                         QSL(" AND (date_created < :last_created OR (date_created = :last_created_same AND id < :last_id))");
+    const int chunk_size = count - messages.size();
+    QSqlQuery q(db);
+
+    q.setForwardOnly(true);
+    q.prepare(QString(QSL("SELECT %1 FROM %2 WHERE %3%4 ORDER BY date_created DESC, id DESC LIMIT %5;"))
+              .arg(selected_columns,
+                   cursor.m_inArchive ? QSL("archive.Messages") : QSL("Messages"),
+                   cursor.m_condition,
+                   position_condition,
+                   QString::number(chunk_size)));
+
+    foreach (const QString &placeholder, cursor.m_bindings.keys()) {
+      q.bindValue(placeholder, cursor.m_bindings.value(placeholder));
     }
-  }
-  else {
-    if (ok != nullptr) {
-      *ok = false;
+
+    if (cursor.m_lastId >= 0) {
+      q.bindValue(QSL(":last_created"), cursor.m_lastCreated);
+      q.bindValue(QSL(":last_created_same"), cursor.m_lastCreated);
+      q.bindValue(QSL(":last_id"), cursor.m_lastId);
     }
-  }
 
-  return messages;
-}
+    if (!q.exec()) {
+      qWarning("Reading of messages chunk failed: '%s'.", qPrintable(q.lastError().text()));
+      cursor.m_atEnd = true;
 
-QList<Message> DatabaseQueries::getUndeletedMessagesForAccount(QSqlDatabase db, int account_id, bool *ok) {
-  QList<Message> messages;
-  QSqlQuery q(db);
-  q.setForwardOnly(true);
-  q.prepare("SELECT * "
-            "FROM Messages "
-            "WHERE is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id;");
-  q.bindValue(QSL(":account_id"), account_id);
+      if (ok != nullptr) {
+        *ok = false;
+      }
+
+      break;
+    }
+
+    int rows = 0;
 
-  if (q.exec()) {
     while (q.next()) {
+      QSqlRecord record = q.record();
+
+      rows++;
+      cursor.m_lastCreated = record.value(MSG_DB_DCREATED_INDEX).value<qint64>();
+      cursor.m_lastId = record.value(MSG_DB_ID_INDEX).toInt();
+
+      if (cursor.m_inArchive && with_contents) {
+        // Contents of archived messages are stored compressed.
+        record.setValue(MSG_DB_CONTENTS_INDEX,
+                        QString::fromUtf8(qUncompress(record.value(MSG_DB_CONTENTS_INDEX).toByteArray())));
+      }
+
       bool decoded;
-      Message message = Message::fromSqlRecord(q.record(), &decoded);
+      Message message = Message::fromSqlRecord(record, &decoded);
 
       if (decoded) {
+        if (cursor.m_inArchive) {
+          // Archive database has its own IDs, which can equal IDs of live
+          // messages, so archived messages get negated IDs, thus they
+          // are never mistaken for live ones.
+          message.m_id = -message.m_id;
+          message.m_isArchived = true;
+        }
+
         messages.append(message);
       }
     }
 
-    if (ok != nullptr) {
-      *ok = true;
-    }
-  }
-  else {
-    if (ok != nullptr) {
-      *ok = false;
+    if (rows < chunk_size) {
+      // Current table is read completely, continue with archive if desired.
+      if (!cursor.m_inArchive && cursor.m_includeArchived) {
+        cursor.m_inArchive = true;
+        cursor.m_lastCreated = 0;
+        cursor.m_lastId = -1;
+      }
+      else {
+        cursor.m_atEnd = true;
+      }
     }
   }
 
@@ -441,7 +912,7 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
                                     const QList<Message> &messages,
                                     int feed_custom_id,
                                     int account_id,
-                                    const QString &url,
+                                    QHash<quint64,quint64> *known_fingerprints,
                                     bool *any_message_changed,
                                     bool *ok) {
   if (messages.isEmpty()) {
@@ -454,10 +925,23 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
   // its own "custom ID" (standard feeds have their custom ID equal to primary key ID).
   int updated_messages = 0;
 
+  // Fingerprints of messages which were inserted/updated/verified here, they
+  // are merged with "known" fingerprints when transaction is committed.
+  QHash<quint64,quint64> new_fingerprints;
+
+  const bool compress_contents = qApp->settings()->value(GROUP(Database), SETTING(Database::CompressMessageContents)).toBool();
+
+  // Archive must be attached before transaction is started. Messages which were
+  // moved there must not be added again as new ones.
+  const bool archive_attached = qApp->database()->attachArchiveDatabase(db, false);
+
   // Prepare queries.
   QSqlQuery query_select_with_url(db);
   QSqlQuery query_select_with_id(db);
+  QSqlQuery query_select_archived_with_url(db);
+  QSqlQuery query_select_archived_with_id(db);
   QSqlQuery query_update(db);
+  QSqlQuery query_update_hash(db);
   QSqlQuery query_insert(db);
 
   // Here we have query which will check for existence of the "same" message in given feed.
@@ -466,15 +950,26 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
   //   2) they have same URL AND,
   //   3) they have same AUTHOR.
   query_select_with_url.setForwardOnly(true);
-  query_select_with_url.prepare("SELECT id, date_created, is_read, is_important FROM Messages "
+  query_select_with_url.prepare("SELECT id, date_created, is_read, is_important, custom_hash FROM Messages "
                                 "WHERE feed = :feed AND title = :title AND url = :url AND author = :author AND account_id = :account_id;");
 
   // When we have custom ID of the message, we can check directly for existence
   // of that particular message.
   query_select_with_id.setForwardOnly(true);
-  query_select_with_id.prepare("SELECT id, date_created, is_read, is_important FROM Messages "
+  query_select_with_id.prepare("SELECT id, date_created, is_read, is_important, custom_hash FROM Messages "
                                "WHERE custom_id = :custom_id AND account_id = :account_id;");
 
+  // The same checks are done against archived messages.
+  if (archive_attached) {
+    query_select_archived_with_url.setForwardOnly(true);
+    query_select_archived_with_url.prepare("SELECT id FROM archive.Messages "
+                                           "WHERE feed = :feed AND title = :title AND url = :url AND author = :author AND account_id = :account_id;");
+
+    query_select_archived_with_id.setForwardOnly(true);
+    query_select_archived_with_id.prepare("SELECT id FROM archive.Messages "
+                                          "WHERE custom_id = :custom_id AND account_id = :account_id;");
+  }
+
   // Used to insert new messages.
   query_insert.setForwardOnly(true);
   query_insert.prepare("INSERT INTO Messages "
@@ -484,35 +979,42 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
   // Used to update existing messages.
   query_update.setForwardOnly(true);
   query_update.prepare("UPDATE Messages "
-                       "SET title = :title, is_read = :is_read, is_important = :is_important, url = :url, author = :author, date_created = :date_created, contents = :contents, enclosures = :enclosures "
+                       "SET title = :title, is_read = :is_read, is_important = :is_important, url = :url, author = :author, date_created = :date_created, contents = :contents, enclosures = :enclosures, custom_hash = :custom_hash "
                        "WHERE id = :id;");
 
+  // Used to store fingerprints of existing messages which do not have them yet.
+  query_update_hash.setForwardOnly(true);
+  query_update_hash.prepare("UPDATE Messages SET custom_hash = :custom_hash WHERE id = :id;");
+
   if (!db.transaction()) {
     db.rollback();
     qDebug("Transaction start for message downloader failed: '%s'.", qPrintable(db.lastError().text()));
     return updated_messages;
   }
 
-  foreach (Message message, messages) {
-    // Check if messages contain relative URLs and if they do, then replace them.
-    if (message.m_url.startsWith(QL1S("//"))) {
-      message.m_url = QString(URI_SCHEME_HTTP) + message.m_url.mid(2);
-    }
-    else if (message.m_url.startsWith(QL1S("/"))) {
-      QString new_message_url = QUrl(url).toString(QUrl::RemoveUserInfo |
-                                                   QUrl::RemovePath |
-                                                   QUrl::RemoveQuery |
-                                                   QUrl::RemoveFilename |
-                                                   QUrl::StripTrailingSlash);
+  // Messages are only read here, so they are not copied.
+  foreach (const Message &message, messages) {
+    const quint64 identity_hash = message.identityHash();
+    const quint64 fingerprint = message.fingerprint();
 
-      new_message_url += message.m_url;
-      message.m_url = new_message_url;
+    if (known_fingerprints != nullptr && known_fingerprints->contains(identity_hash) &&
+        known_fingerprints->value(identity_hash) == fingerprint) {
+      // This message is already stored and none of its
+      // relevant attributes changed, no need to touch DB.
+      continue;
     }
 
+    // Messages which have their hash assigned by their service keep
+    // that hash, otherwise we store the fingerprint there.
+    const QString custom_hash = message.m_customHash.isEmpty() ?
+                                  fingerprintToString(identity_hash, fingerprint) :
+                                  message.m_customHash;
+
     int id_existing_message = -1;
     qint64 date_existing_message;
     bool is_read_existing_message;
     bool is_important_existing_message;
+    QString custom_hash_existing_message;
 
     if (message.m_customId.isEmpty()) {
       // We need to recognize existing messages according URL & AUTHOR.
@@ -528,6 +1030,7 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
         date_existing_message = query_select_with_url.value(1).value<qint64>();
         is_read_existing_message = query_select_with_url.value(2).toBool();
         is_important_existing_message = query_select_with_url.value(3).toBool();
+        custom_hash_existing_message = query_select_with_url.value(4).toString();
       }
 
       query_select_with_url.finish();
@@ -543,11 +1046,41 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
         date_existing_message = query_select_with_id.value(1).value<qint64>();
         is_read_existing_message = query_select_with_id.value(2).toBool();
         is_important_existing_message = query_select_with_id.value(3).toBool();
+        custom_hash_existing_message = query_select_with_id.value(4).toString();
       }
 
       query_select_with_id.finish();
     }
 
+    if (id_existing_message < 0 && archive_attached) {
+      bool is_archived;
+
+      if (message.m_customId.isEmpty()) {
+        query_select_archived_with_url.bindValue(QSL(":feed"), feed_custom_id);
+        query_select_archived_with_url.bindValue(QSL(":title"), message.m_title);
+        query_select_archived_with_url.bindValue(QSL(":url"), message.m_url);
+        query_select_archived_with_url.bindValue(QSL(":author"), message.m_author);
+        query_select_archived_with_url.bindValue(QSL(":account_id"), account_id);
+
+        is_archived = query_select_archived_with_url.exec() && query_select_archived_with_url.next();
+        query_select_archived_with_url.finish();
+      }
+      else {
+        query_select_archived_with_id.bindValue(QSL(":account_id"), account_id);
+        query_select_archived_with_id.bindValue(QSL(":custom_id"), message.m_customId);
+
+        is_archived = query_select_archived_with_id.exec() && query_select_archived_with_id.next();
+        query_select_archived_with_id.finish();
+      }
+
+      if (is_archived) {
+        // Message was moved to archive, archived messages are read-only,
+        // so it is neither updated nor added again.
+        new_fingerprints.insert(identity_hash, fingerprint);
+        continue;
+      }
+    }
+
     // Now, check if this message is already in the DB.
     if (id_existing_message >= 0) {
       // Message is already in the DB.
@@ -555,28 +1088,47 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
       // Now, we update it if at least one of next conditions is true:
       //   1) Message has custom ID AND (its date OR read status OR starred status are changed).
       //   2) Message has its date fetched from feed AND its date is different from date in DB.
-      if (/* 1 */ (!message.m_customId.isEmpty() && (message.m_created.toMSecsSinceEpoch() != date_existing_message || message.m_isRead != is_read_existing_message || message.m_isImportant != is_important_existing_message)) ||
-          /* 2 */ (message.m_createdFromFeed && message.m_created.toMSecsSinceEpoch() != date_existing_message)) {
+      if (/* 1 */ (!message.m_customId.isEmpty() && (message.m_created != date_existing_message || message.m_isRead != is_read_existing_message || message.m_isImportant != is_important_existing_message)) ||
+          /* 2 */ (message.m_createdFromFeed && message.m_created != date_existing_message)) {
         // Message exists, it is changed, update it.
         query_update.bindValue(QSL(":title"), message.m_title);
         query_update.bindValue(QSL(":is_read"), (int) message.m_isRead);
         query_update.bindValue(QSL(":is_important"), (int) message.m_isImportant);
         query_update.bindValue(QSL(":url"), message.m_url);
         query_update.bindValue(QSL(":author"), message.m_author);
-        query_update.bindValue(QSL(":date_created"), message.m_created.toMSecsSinceEpoch());
-        query_update.bindValue(QSL(":contents"), message.m_contents);
+        query_update.bindValue(QSL(":date_created"), message.m_created);
+        query_update.bindValue(QSL(":contents"), compress_contents ? Message::compressContents(message.m_contents) : message.m_contents);
         query_update.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(message.m_enclosures));
+        query_update.bindValue(QSL(":custom_hash"), custom_hash);
         query_update.bindValue(QSL(":id"), id_existing_message);
 
         *any_message_changed = true;
 
-        if (query_update.exec() && !message.m_isRead) {
-          updated_messages++;
+        if (query_update.exec()) {
+          new_fingerprints.insert(identity_hash, fingerprint);
+
+          if (!message.m_isRead) {
+            updated_messages++;
+          }
         }
 
         query_update.finish();
         qDebug("Updating message '%s' in DB.", qPrintable(message.m_title));
       }
+      else if (custom_hash != custom_hash_existing_message) {
+        // Message is not changed, but it does not have its fingerprint stored yet.
+        query_update_hash.bindValue(QSL(":custom_hash"), custom_hash);
+        query_update_hash.bindValue(QSL(":id"), id_existing_message);
+
+        if (query_update_hash.exec()) {
+          new_fingerprints.insert(identity_hash, fingerprint);
+        }
+
+        query_update_hash.finish();
+      }
+      else {
+        new_fingerprints.insert(identity_hash, fingerprint);
+      }
     }
     else {
       // Message with this URL is not fetched in this feed yet.
@@ -586,14 +1138,15 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
       query_insert.bindValue(QSL(":is_important"), (int) message.m_isImportant);
       query_insert.bindValue(QSL(":url"), message.m_url);
       query_insert.bindValue(QSL(":author"), message.m_author);
-      query_insert.bindValue(QSL(":date_created"), message.m_created.toMSecsSinceEpoch());
-      query_insert.bindValue(QSL(":contents"), message.m_contents);
+      query_insert.bindValue(QSL(":date_created"), message.m_created);
+      query_insert.bindValue(QSL(":contents"), compress_contents ? Message::compressContents(message.m_contents) : message.m_contents);
       query_insert.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(message.m_enclosures));
       query_insert.bindValue(QSL(":custom_id"), message.m_customId);
-      query_insert.bindValue(QSL(":custom_hash"), message.m_customHash);
+      query_insert.bindValue(QSL(":custom_hash"), custom_hash);
       query_insert.bindValue(QSL(":account_id"), account_id);
 
       if (query_insert.exec() && query_insert.numRowsAffected() == 1) {
+        new_fingerprints.insert(identity_hash, fingerprint);
         updated_messages++;
       }
 
@@ -619,6 +1172,12 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
     }
   }
   else {
+    if (known_fingerprints != nullptr) {
+      for (QHash<quint64,quint64>::const_iterator i = new_fingerprints.constBegin(); i != new_fingerprints.constEnd(); i++) {
+        known_fingerprints->insert(i.key(), i.value());
+      }
+    }
+
     if (ok != nullptr) {
       *ok = true;
     }
@@ -652,8 +1211,13 @@ bool DatabaseQueries::deleteAccount(QSqlDatabase db, int account_id) {
   queries << QSL("DELETE FROM Messages WHERE account_id = :account_id;") <<
              QSL("DELETE FROM Feeds WHERE account_id = :account_id;") <<
              QSL("DELETE FROM Categories WHERE account_id = :account_id;") <<
+             QSL("DELETE FROM PendingChanges WHERE account_id = :account_id;") <<
              QSL("DELETE FROM Accounts WHERE id = :account_id;");
 
+  if (qApp->database()->attachArchiveDatabase(db, false)) {
+    queries.prepend(QSL("DELETE FROM archive.Messages WHERE account_id = :account_id;"));
+  }
+
   foreach (const QString &q, queries) {
     query.prepare(q);
     query.bindValue(QSL(":account_id"), account_id);
@@ -664,6 +1228,7 @@ bool DatabaseQueries::deleteAccount(QSqlDatabase db, int account_id) {
     }
     else {
       query.finish();
+      notifyMessageStateChanged(account_id);
     }
   }
 
@@ -679,7 +1244,19 @@ bool DatabaseQueries::deleteAccountData(QSqlDatabase db, int account_id, bool de
     q.prepare(QSL("DELETE FROM Messages WHERE account_id = :account_id;"));
     q.bindValue(QSL(":account_id"), account_id);
 
-    result &= q.exec();
+    if (q.exec()) {
+      notifyMessageStateChanged(account_id);
+    }
+    else {
+      result = false;
+    }
+
+    if (qApp->database()->attachArchiveDatabase(db, false)) {
+      q.prepare(QSL("DELETE FROM archive.Messages WHERE account_id = :account_id;"));
+      q.bindValue(QSL(":account_id"), account_id);
+
+      result &= q.exec();
+    }
   }
 
   q.prepare(QSL("DELETE FROM Feeds WHERE account_id = :account_id;"));
@@ -734,59 +1311,294 @@ bool DatabaseQueries::purgeLeftoverMessages(QSqlDatabase db, int account_id) {
     return false;
   }
   else {
+    notifyMessageStateChanged(account_id);
     return true;
   }
 }
 
-bool DatabaseQueries::storeAccountTree(QSqlDatabase db, RootItem *tree_root, int account_id) {
-  QSqlQuery query_category(db);
-  QSqlQuery query_feed(db);
-  query_category.setForwardOnly(true);
-  query_feed.setForwardOnly(true);
-  query_category.prepare("INSERT INTO Categories (parent_id, title, account_id, custom_id) "
-                         "VALUES (:parent_id, :title, :account_id, :custom_id);");
-  query_feed.prepare("INSERT INTO Feeds (title, icon, category, protected, update_type, update_interval, account_id, custom_id) "
-                     "VALUES (:title, :icon, :category, :protected, :update_type, :update_interval, :account_id, :custom_id);");
+bool DatabaseQueries::storeSyncedCategory(QSqlDatabase db, RootItem *category, int parent_id, int account_id) {
+  QSqlQuery q(db);
 
-  // Iterate all children.
-  foreach (RootItem *child, tree_root->getSubTree()) {
-    if (child->kind() == RootItemKind::Category) {
-      query_category.bindValue(QSL(":parent_id"), child->parent()->id());
-      query_category.bindValue(QSL(":title"), child->title());
-      query_category.bindValue(QSL(":account_id"), account_id);
-      query_category.bindValue(QSL(":custom_id"), QString::number(child->toCategory()->customId()));
+  q.setForwardOnly(true);
+  q.prepare("INSERT INTO Categories (parent_id, title, account_id, custom_id) "
+            "VALUES (:parent_id, :title, :account_id, :custom_id);");
+  q.bindValue(QSL(":parent_id"), parent_id);
+  q.bindValue(QSL(":title"), category->title());
+  q.bindValue(QSL(":account_id"), account_id);
+  q.bindValue(QSL(":custom_id"), QString::number(category->customId()));
 
-      if (query_category.exec()) {
-        child->setId(query_category.lastInsertId().toInt());
-      }
-      else {
-        return false;
-      }
+  if (q.exec()) {
+    category->setId(q.lastInsertId().toInt());
+    return true;
+  }
+  else {
+    qWarning("Failed to store synchronized category '%s': '%s'.", qPrintable(category->title()), qPrintable(q.lastError().text()));
+    return false;
+  }
+}
+
+bool DatabaseQueries::storeSyncedFeed(QSqlDatabase db, Feed *feed, int parent_custom_id, int account_id) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare("INSERT INTO Feeds (title, icon, category, protected, update_type, update_interval, account_id, custom_id) "
+            "VALUES (:title, :icon, :category, :protected, :update_type, :update_interval, :account_id, :custom_id);");
+  q.bindValue(QSL(":title"), feed->title());
+  q.bindValue(QSL(":icon"), qApp->iconCache()->storeIcon(feed->icon()));
+  q.bindValue(QSL(":category"), parent_custom_id);
+  q.bindValue(QSL(":protected"), 0);
+  q.bindValue(QSL(":update_type"), (int) feed->autoUpdateType());
+  q.bindValue(QSL(":update_interval"), feed->autoUpdateInitialInterval());
+  q.bindValue(QSL(":account_id"), account_id);
+  q.bindValue(QSL(":custom_id"), feed->customId());
+
+  if (q.exec()) {
+    feed->setId(q.lastInsertId().toInt());
+    return true;
+  }
+  else {
+    qWarning("Failed to store synchronized feed '%s': '%s'.", qPrintable(feed->title()), qPrintable(q.lastError().text()));
+    return false;
+  }
+}
+
+bool DatabaseQueries::updateSyncedCategory(QSqlDatabase db, int category_id, int parent_id, const QString &title) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("UPDATE Categories SET parent_id = :parent_id, title = :title WHERE id = :id;"));
+  q.bindValue(QSL(":parent_id"), parent_id);
+  q.bindValue(QSL(":title"), title);
+  q.bindValue(QSL(":id"), category_id);
+
+  return q.exec();
+}
+
+bool DatabaseQueries::updateSyncedFeed(QSqlDatabase db, int feed_id, int parent_custom_id, const QString &title) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("UPDATE Feeds SET category = :category, title = :title WHERE id = :id;"));
+  q.bindValue(QSL(":category"), parent_custom_id);
+  q.bindValue(QSL(":title"), title);
+  q.bindValue(QSL(":id"), feed_id);
+
+  return q.exec();
+}
+
+bool DatabaseQueries::updateFeedIcon(QSqlDatabase db, int feed_id, const QIcon &icon) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("UPDATE Feeds SET icon = :icon WHERE id = :id;"));
+  q.bindValue(QSL(":icon"), qApp->iconCache()->storeIcon(icon));
+  q.bindValue(QSL(":id"), feed_id);
+
+  return q.exec();
+}
+
+bool DatabaseQueries::moveIconsToStore(QSqlDatabase db, int *moved_icons) {
+  QSqlQuery q(db);
+  int moved = 0;
+
+  q.setForwardOnly(true);
+
+  if (moved_icons != nullptr) {
+    *moved_icons = 0;
+  }
+
+  if (!q.exec(QSL("SELECT inf_value FROM Information WHERE inf_key = 'icons_in_store';"))) {
+    qWarning("Cannot check whether icons were moved to icon store: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+  else if (q.next()) {
+    // Icons of this database were already moved.
+    return true;
+  }
+
+  q.finish();
+
+  foreach (const QString &table, QStringList() << QSL("Feeds") << QSL("Categories")) {
+    QList<QPair<int,QByteArray> > embedded_icons;
+
+    // Icons embedded by older versions are not references into icon store.
+    if (!q.exec(QString("SELECT id, icon FROM %1 WHERE icon IS NOT NULL AND icon != '' AND icon NOT LIKE '%2%';").arg(table,
+                                                                                                                     ICON_REFERENCE_PREFIX))) {
+      qWarning("Cannot obtain embedded icons from table '%s': '%s'.", qPrintable(table), qPrintable(q.lastError().text()));
+      return false;
     }
-    else if (child->kind() == RootItemKind::Feed) {
-      Feed *feed = child->toFeed();
 
-      query_feed.bindValue(QSL(":title"), feed->title());
-      query_feed.bindValue(QSL(":icon"), qApp->icons()->toByteArray(feed->icon()));
-      query_feed.bindValue(QSL(":category"), feed->parent()->customId());
-      query_feed.bindValue(QSL(":protected"), 0);
-      query_feed.bindValue(QSL(":update_type"), (int) feed->autoUpdateType());
-      query_feed.bindValue(QSL(":update_interval"), feed->autoUpdateInitialInterval());
-      query_feed.bindValue(QSL(":account_id"), account_id);
-      query_feed.bindValue(QSL(":custom_id"), feed->customId());
+    while (q.next()) {
+      embedded_icons.append(QPair<int,QByteArray>(q.value(0).toInt(), q.value(1).toByteArray()));
+    }
 
-      if (query_feed.exec()) {
-        feed->setId(query_feed.lastInsertId().toInt());
-      }
-      else {
+    q.finish();
+
+    if (embedded_icons.isEmpty()) {
+      continue;
+    }
+
+    if (!db.transaction()) {
+      return false;
+    }
+
+    q.prepare(QString("UPDATE %1 SET icon = :icon WHERE id = :id;").arg(table));
+
+    for (int i = 0; i < embedded_icons.size(); i++) {
+      q.bindValue(QSL(":icon"), qApp->iconCache()->storeIcon(qApp->icons()->fromByteArray(embedded_icons.at(i).second)));
+      q.bindValue(QSL(":id"), embedded_icons.at(i).first);
+
+      if (!q.exec()) {
+        qWarning("Cannot move embedded icon to icon store: '%s'.", qPrintable(q.lastError().text()));
+        db.rollback();
         return false;
       }
     }
+
+    if (!db.commit()) {
+      db.rollback();
+      return false;
+    }
+
+    moved += embedded_icons.size();
+  }
+
+  // Mark database, so that feeds/categories are not scanned on each startup.
+  if (!q.exec(QSL("INSERT INTO Information (inf_key, inf_value) VALUES ('icons_in_store', '1');"))) {
+    qWarning("Cannot mark icons as moved to icon store: '%s'.", qPrintable(q.lastError().text()));
+  }
+
+  if (moved_icons != nullptr) {
+    *moved_icons = moved;
   }
 
   return true;
 }
 
+QHash<quint64,quint64> DatabaseQueries::getMessageFingerprintsForFeed(QSqlDatabase db, int feed_custom_id, int account_id, bool *ok) {
+  QHash<quint64,quint64> fingerprints;
+  QSqlQuery q(db);
+  q.setForwardOnly(true);
+
+  // Archived messages are included too, so that they are not downloaded again.
+  if (qApp->database()->attachArchiveDatabase(db, false)) {
+    q.prepare(QSL("SELECT custom_hash, custom_id, date_created, is_read, is_important FROM main.Messages "
+                  "WHERE account_id = :account_id AND feed = :feed "
+                  "UNION ALL "
+                  "SELECT custom_hash, custom_id, date_created, is_read, is_important FROM archive.Messages "
+                  "WHERE account_id = :archive_account_id AND feed = :archive_feed;"));
+    q.bindValue(QSL(":archive_account_id"), account_id);
+    q.bindValue(QSL(":archive_feed"), feed_custom_id);
+  }
+  else {
+    q.prepare(QSL("SELECT custom_hash, custom_id, date_created, is_read, is_important FROM Messages "
+                  "WHERE account_id = :account_id AND feed = :feed;"));
+  }
+
+  q.bindValue(QSL(":account_id"), account_id);
+  q.bindValue(QSL(":feed"), feed_custom_id);
+
+  if (q.exec()) {
+    quint64 identity_hash, fingerprint;
+
+    while (q.next()) {
+      // NOTE: Messages whose hash was assigned by their service, or messages which
+      // were stored before fingerprinting was introduced, are skipped here.
+      if (fingerprintFromString(q.value(0).toString(), &identity_hash, &fingerprint)) {
+        Message message;
+        message.m_customId = q.value(1).toString();
+
+        if (identity_hash == message.identityHash()) {
+          // Message is identified by its custom ID, so its fingerprint contains its state
+          // too. Stored fingerprint describes state obtained from service, but the state
+          // could be changed locally since then, so fingerprint of current state is used.
+          message.m_created = q.value(2).value<qint64>();
+          message.m_isRead = q.value(3).toBool();
+          message.m_isImportant = q.value(4).toBool();
+          fingerprint = message.fingerprint();
+        }
+
+        fingerprints.insert(identity_hash, fingerprint);
+      }
+    }
+
+    if (ok != nullptr) {
+      *ok = true;
+    }
+  }
+  else {
+    if (ok != nullptr) {
+      *ok = false;
+    }
+  }
+
+  return fingerprints;
+}
+
+int DatabaseQueries::messageStateGeneration(int account_id, int feed_custom_id) {
+  QMutexLocker locker(&s_messageStateMutex);
+
+  // Generations only grow, so their sum changes whenever any of them changes.
+  return s_messageStateGeneration.load() +
+         s_messageStateGenerations.value(QString::number(account_id)) +
+         s_messageStateGenerations.value(QString::number(account_id) + QL1C('/') + QString::number(feed_custom_id));
+}
+
+void DatabaseQueries::notifyMessageStateChanged() {
+  s_messageStateGeneration.ref();
+}
+
+void DatabaseQueries::notifyMessageStateChanged(int account_id) {
+  QMutexLocker locker(&s_messageStateMutex);
+  s_messageStateGenerations[QString::number(account_id)]++;
+}
+
+void DatabaseQueries::notifyMessageStateChanged(int account_id, const QStringList &feed_ids) {
+  QMutexLocker locker(&s_messageStateMutex);
+
+  foreach (QString feed_id, feed_ids) {
+    // Feed IDs may be quoted for use in SQL.
+    s_messageStateGenerations[QString::number(account_id) + QL1C('/') + feed_id.remove(QL1C('\''))]++;
+  }
+}
+
+void DatabaseQueries::notifyMessageStateChanged(QSqlDatabase db, const QStringList &message_ids) {
+  QSqlQuery q(db);
+  QHash<int,QStringList> feeds_of_accounts;
+
+  q.setForwardOnly(true);
+
+  if (!q.exec(QString(QSL("SELECT DISTINCT account_id, feed FROM Messages WHERE id IN (%1);")).arg(message_ids.join(QSL(", "))))) {
+    // Feeds of messages are not known, so all cached data are outdated.
+    notifyMessageStateChanged();
+    return;
+  }
+
+  while (q.next()) {
+    feeds_of_accounts[q.value(0).toInt()].append(q.value(1).toString());
+  }
+
+  foreach (int account_id, feeds_of_accounts.keys()) {
+    notifyMessageStateChanged(account_id, feeds_of_accounts.value(account_id));
+  }
+}
+
+QString DatabaseQueries::fingerprintToString(quint64 identity_hash, quint64 fingerprint) {
+  return QString::number(identity_hash, 16) + QL1C(':') + QString::number(fingerprint, 16);
+}
+
+bool DatabaseQueries::fingerprintFromString(const QString &string, quint64 *identity_hash, quint64 *fingerprint) {
+  const int separator = string.indexOf(QL1C(':'));
+  bool identity_ok = false, fingerprint_ok = false;
+
+  if (separator > 0) {
+    *identity_hash = string.left(separator).toULongLong(&identity_ok, 16);
+    *fingerprint = string.mid(separator + 1).toULongLong(&fingerprint_ok, 16);
+  }
+
+  return identity_ok && fingerprint_ok;
+}
+
 QStringList DatabaseQueries::customIdsOfMessagesFromAccount(QSqlDatabase db, int account_id, bool *ok) {
   QSqlQuery q(db);
   QStringList ids;
@@ -1087,6 +1899,19 @@ bool DatabaseQueries::deleteFeed(QSqlDatabase db, int feed_custom_id, int accoun
     return false;
   }
 
+  notifyMessageStateChanged(account_id, QStringList() << QString::number(feed_custom_id));
+
+  // Remove archived messages of this feed too.
+  if (qApp->database()->attachArchiveDatabase(db, false)) {
+    q.prepare(QSL("DELETE FROM archive.Messages WHERE feed = :feed AND account_id = :account_id;"));
+    q.bindValue(QSL(":feed"), feed_custom_id);
+    q.bindValue(QSL(":account_id"), account_id);
+
+    if (!q.exec()) {
+      return false;
+    }
+  }
+
   // Remove feed itself.
   q.prepare(QSL("DELETE FROM Feeds WHERE custom_id = :feed AND account_id = :account_id;"));
   q.bindValue(QSL(":feed"), feed_custom_id);
@@ -1119,7 +1944,7 @@ int DatabaseQueries::addCategory(QSqlDatabase db, int parent_id, int account_id,
   q.bindValue(QSL(":title"), title);
   q.bindValue(QSL(":description"), description);
   q.bindValue(QSL(":date_created"), creation_date.toMSecsSinceEpoch());
-  q.bindValue(QSL(":icon"), qApp->icons()->toByteArray(icon));
+  q.bindValue(QSL(":icon"), qApp->iconCache()->storeIcon(icon));
   q.bindValue(QSL(":account_id"), account_id);
 
   if (!q.exec()) {
@@ -1159,7 +1984,7 @@ bool DatabaseQueries::editCategory(QSqlDatabase db, int parent_id, int category_
             "WHERE id = :id;");
   q.bindValue(QSL(":title"), title);
   q.bindValue(QSL(":description"), description);
-  q.bindValue(QSL(":icon"), qApp->icons()->toByteArray(icon));
+  q.bindValue(QSL(":icon"), qApp->iconCache()->storeIcon(icon));
   q.bindValue(QSL(":parent_id"), parent_id);
   q.bindValue(QSL(":id"), category_id);
 
@@ -1181,7 +2006,7 @@ int DatabaseQueries::addFeed(QSqlDatabase db, int parent_id, int account_id, con
   q.bindValue(QSL(":title"), title);
   q.bindValue(QSL(":description"), description);
   q.bindValue(QSL(":date_created"), creation_date.toMSecsSinceEpoch());
-  q.bindValue(QSL(":icon"), qApp->icons()->toByteArray(icon));
+  q.bindValue(QSL(":icon"), qApp->iconCache()->storeIcon(icon));
   q.bindValue(QSL(":category"), parent_id);
   q.bindValue(QSL(":encoding"), encoding);
   q.bindValue(QSL(":url"), url);
@@ -1239,7 +2064,7 @@ bool DatabaseQueries::editFeed(QSqlDatabase db, int parent_id, int feed_id, cons
             "WHERE id = :id;");
   q.bindValue(QSL(":title"), title);
   q.bindValue(QSL(":description"), description);
-  q.bindValue(QSL(":icon"), qApp->icons()->toByteArray(icon));
+  q.bindValue(QSL(":icon"), qApp->iconCache()->storeIcon(icon));
   q.bindValue(QSL(":category"), parent_id);
   q.bindValue(QSL(":encoding"), encoding);
   q.bindValue(QSL(":url"), url);
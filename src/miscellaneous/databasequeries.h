@@ -24,6 +24,10 @@
 #include "services/standard/standardfeed.h"
 
 #include <QSqlQuery>
+#include <QAtomicInt>
+#include <QSet>
+#include <QHash>
+#include <QMutex>
 
 
 class DatabaseQueries {
@@ -39,6 +43,14 @@ class DatabaseQueries {
     static bool deleteOrRestoreMessagesToFromBin(QSqlDatabase db, const QStringList &ids, bool deleted);
     static bool restoreBin(QSqlDatabase db, int account_id);
 
+    // Journal of changes of messages, which are not yet pushed to online services.
+    // Recorded change which reverts not yet pushed change removes it from the journal,
+    // unless that change is just being pushed (its ID is in "pushed_ids").
+    static bool recordPendingChanges(QSqlDatabase db, int account_id, const QList<PendingChange> &changes,
+                                     const QSet<int> &pushed_ids);
+    static QList<PendingChange> getPendingChanges(QSqlDatabase db, int account_id, int limit, bool *ok = NULL);
+    static bool removePendingChanges(QSqlDatabase db, const QList<PendingChange> &changes);
+
     // Purge database.
     static bool purgeImportantMessages(QSqlDatabase db);
     static bool purgeReadMessages(QSqlDatabase db);
@@ -47,6 +59,19 @@ class DatabaseQueries {
     static bool purgeMessagesFromBin(QSqlDatabase db, bool clear_only_read, int account_id);
     static bool purgeLeftoverMessages(QSqlDatabase db, int account_id);
 
+    // Moves read, not starred messages older than given number of days
+    // from main database to (compressed) archive database.
+    static bool archiveOldMessages(QSqlDatabase db, int older_than_days);
+
+    // Compresses contents of next batch of stored messages with ID greater than "last_id",
+    // which is then moved forward. Returns number of messages processed in the batch,
+    // thus zero is returned when all messages were processed.
+    static int compressMessageContents(QSqlDatabase db, int *last_id, qint64 *saved_bytes, bool *ok = NULL);
+
+    // Obtains count of messages with compressed contents and
+    // number of bytes saved by compression.
+    static bool getContentsCompressionStats(QSqlDatabase db, int *compressed_messages, qint64 *saved_bytes);
+
     // Obtain counts of unread/all messages.
     static QMap<int,QPair<int,int> > getMessageCountsForCategory(QSqlDatabase db, int custom_id, int account_id,
                                                                  bool including_total_counts, bool *ok = NULL);
@@ -56,10 +81,25 @@ class DatabaseQueries {
                                        bool including_total_counts, bool *ok = NULL);
     static int getMessageCountsForBin(QSqlDatabase db, int account_id, bool including_total_counts, bool *ok = NULL);
 
-    // Get messages (for newspaper view for example).
-    static QList<Message> getUndeletedMessagesForFeed(QSqlDatabase db, int feed_custom_id, int account_id, bool *ok = NULL);
-    static QList<Message> getUndeletedMessagesForBin(QSqlDatabase db, int account_id, bool *ok = NULL);
-    static QList<Message> getUndeletedMessagesForAccount(QSqlDatabase db, int account_id, bool *ok = NULL);
+    // Get cursors for reading of undeleted messages in chunks (for newspaper view for example).
+    // Only given columns of messages are read, see MessagesCursor::Column.
+    static MessagesCursor getUndeletedMessagesCursorForFeeds(const QList<int> &feed_custom_ids, int account_id, bool include_archived,
+                                                             MessagesCursor::Columns columns = MessagesCursor::AllColumns);
+    static MessagesCursor getUndeletedMessagesCursorForBin(int account_id,
+                                                           MessagesCursor::Columns columns = MessagesCursor::AllColumns);
+    static MessagesCursor getUndeletedMessagesCursorForAccount(int account_id, bool include_archived,
+                                                               MessagesCursor::Columns columns = MessagesCursor::AllColumns);
+
+    // Returns at most "count" next messages of given cursor and moves the cursor after them.
+    static QList<Message> fetchNextMessages(QSqlDatabase db, MessagesCursor &cursor, int count, bool *ok = NULL);
+
+    // Obtain fingerprints of messages stored in given feed, keyed by identity hashes of those messages.
+    static QHash<quint64,quint64> getMessageFingerprintsForFeed(QSqlDatabase db, int feed_custom_id, int account_id, bool *ok = NULL);
+
+    // Returns number which changes each time any messages of given feed are physically
+    // removed from database or their state is changed locally, thus cached data about
+    // stored messages of the feed become outdated.
+    static int messageStateGeneration(int account_id, int feed_custom_id);
 
     // Custom ID accumulators.
     static QStringList customIdsOfMessagesFromAccount(QSqlDatabase db, int account_id, bool *ok = NULL);
@@ -67,13 +107,25 @@ class DatabaseQueries {
     static QStringList customIdsOfMessagesFromFeed(QSqlDatabase db, int feed_custom_id, int account_id, bool *ok = NULL);
 
     // Common accounts methods.
+    // NOTE: Messages must have absolute URLs, see Feed::resolveRelativeUrls().
     static int updateMessages(QSqlDatabase db, const QList<Message> &messages, int feed_custom_id,
-                              int account_id, const QString &url, bool *any_message_changed, bool *ok = NULL);
+                              int account_id, QHash<quint64,quint64> *known_fingerprints,
+                              bool *any_message_changed, bool *ok = NULL);
     static bool deleteAccount(QSqlDatabase db, int account_id);
     static bool deleteAccountData(QSqlDatabase db, int account_id, bool delete_messages_too);
     static bool cleanFeeds(QSqlDatabase db, const QStringList &ids, bool clean_read_only, int account_id);
 
-    static bool storeAccountTree(QSqlDatabase db, RootItem *tree_root, int account_id);
+    // Store/update categories and feeds obtained during synchronization of account feed tree.
+    // Newly stored items get their primary IDs assigned.
+    static bool storeSyncedCategory(QSqlDatabase db, RootItem *category, int parent_id, int account_id);
+    static bool storeSyncedFeed(QSqlDatabase db, Feed *feed, int parent_custom_id, int account_id);
+    static bool updateSyncedCategory(QSqlDatabase db, int category_id, int parent_id, const QString &title);
+    static bool updateSyncedFeed(QSqlDatabase db, int feed_id, int parent_custom_id, const QString &title);
+    static bool updateFeedIcon(QSqlDatabase db, int feed_id, const QIcon &icon);
+
+    // Moves icons which are embedded in feeds/categories into icon store.
+    // This is done only once per database, which is then marked as migrated.
+    static bool moveIconsToStore(QSqlDatabase db, int *moved_icons = NULL);
     static bool editBaseFeed(QSqlDatabase db, int feed_id, Feed::AutoUpdateType auto_update_type,
                              int auto_update_interval);
 
@@ -125,6 +177,20 @@ class DatabaseQueries {
 
   private:
     explicit DatabaseQueries();
+
+    // Marks cached data about all messages, messages of given account,
+    // messages of given feeds or given messages as outdated.
+    static void notifyMessageStateChanged();
+    static void notifyMessageStateChanged(int account_id);
+    static void notifyMessageStateChanged(int account_id, const QStringList &feed_ids);
+    static void notifyMessageStateChanged(QSqlDatabase db, const QStringList &message_ids);
+
+    static QString fingerprintToString(quint64 identity_hash, quint64 fingerprint);
+    static bool fingerprintFromString(const QString &string, quint64 *identity_hash, quint64 *fingerprint);
+
+    static QAtomicInt s_messageStateGeneration;
+    static QHash<QString,int> s_messageStateGenerations;
+    static QMutex s_messageStateMutex;
 };
 
 #endif // DATABASEQUERIES_H
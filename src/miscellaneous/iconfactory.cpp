@@ -18,6 +18,7 @@
 #include "miscellaneous/iconfactory.h"
 
 #include "miscellaneous/settings.h"
+#include "network-web/iconcache.h"
 
 #include <QBuffer>
 
@@ -30,6 +31,11 @@ IconFactory::~IconFactory() {
 }
 
 QIcon IconFactory::fromByteArray(QByteArray array) {
+  if (IconCache::isReference(array)) {
+    // Icon is not embedded, it is kept in icon store.
+    return qApp->iconCache()->iconForReference(array);
+  }
+
   array = QByteArray::fromBase64(array);
 
   QIcon icon;
@@ -51,7 +57,16 @@ QByteArray IconFactory::toByteArray(const QIcon &icon) {
 
   QDataStream out(&buffer);
   out.setVersion(QDataStream::Qt_4_7);
-  out << icon;
+
+  if (IconCache::isReference(icon.name().toLocal8Bit())) {
+    // Icons from icon store cannot be serialized directly.
+    const QList<QSize> sizes = icon.availableSizes();
+
+    out << (sizes.isEmpty() ? QIcon() : QIcon(icon.pixmap(sizes.first())));
+  }
+  else {
+    out << icon;
+  }
 
   buffer.close();
   return array.toBase64();
@@ -40,7 +40,7 @@ class IconFactory : public QObject {
     virtual ~IconFactory();
 
     // Used to store/retrieve QIcons from/to Base64-encoded
-    // byte array.
+    // byte array. References to icon store are accepted too.
     static QIcon fromByteArray(QByteArray array);
     static QByteArray toByteArray(const QIcon &icon);
 
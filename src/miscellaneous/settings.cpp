@@ -46,6 +46,9 @@ DVALUE(bool) Feeds::FeedsUpdateOnStartupDef = false;
 DKEY Feeds::ShowOnlyUnreadFeeds               = "show_only_unread_feeds";
 DVALUE(bool) Feeds::ShowOnlyUnreadFeedsDef    = false;
 
+DKEY Feeds::ContentHashItemsOnly              = "content_hash_items_only";
+DVALUE(bool) Feeds::ContentHashItemsOnlyDef   = false;
+
 // Messages.
 DKEY Messages::ID                            = "messages";
 
@@ -61,6 +64,12 @@ DVALUE(bool) Messages::ClearReadOnExitDef    = false;
 DKEY Messages::KeepCursorInCenter               = "keep_cursor_center";
 DVALUE(bool) Messages::KeepCursorInCenterDef    = false;
 
+DKEY Messages::ShowArchivedMessages             = "show_archived_messages";
+DVALUE(bool) Messages::ShowArchivedMessagesDef  = false;
+
+DKEY Messages::PreloadPreviewer                 = "preload_previewer";
+DVALUE(bool) Messages::PreloadPreviewerDef      = false;
+
 DKEY Messages::PreviewerFontStandard                                    = "previewer_font_standard";
 NON_CONST_DVALUE(QString) Messages::PreviewerFontStandardDef            = QFont(QFont().family(), 12).toString();
 
@@ -209,6 +218,18 @@ DKEY Database::ID                       = "database";
 DKEY Database::UseInMemory              = "use_in_memory_db";
 DVALUE(bool) Database::UseInMemoryDef   = false;
 
+DKEY Database::InMemorySnapshotInterval             = "in_memory_db_snapshot_interval";
+DVALUE(int) Database::InMemorySnapshotIntervalDef   = 15;
+
+DKEY Database::CompressMessageContents              = "compress_message_contents";
+DVALUE(bool) Database::CompressMessageContentsDef   = false;
+
+DKEY Database::ArchiveMessagesOlderThan             = "archive_messages_older_than";
+DVALUE(int) Database::ArchiveMessagesOlderThanDef   = 0;
+
+DKEY Database::MessageContentsCompressed            = "message_contents_compressed";
+DVALUE(bool) Database::MessageContentsCompressedDef = false;
+
 DKEY Database::MySQLHostname              = "mysql_hostname";
 DVALUE(QString) Database::MySQLHostnameDef  = QString();
 
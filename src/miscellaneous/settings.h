@@ -60,6 +60,9 @@ namespace Feeds {
 
   KEY ShowOnlyUnreadFeeds;
   VALUE(bool) ShowOnlyUnreadFeedsDef;
+
+  KEY ContentHashItemsOnly;
+  VALUE(bool) ContentHashItemsOnlyDef;
 }
 
 // Messages.
@@ -78,6 +81,12 @@ namespace Messages {
   KEY KeepCursorInCenter;
   VALUE(bool) KeepCursorInCenterDef;
 
+  KEY ShowArchivedMessages;
+  VALUE(bool) ShowArchivedMessagesDef;
+
+  KEY PreloadPreviewer;
+  VALUE(bool) PreloadPreviewerDef;
+
   KEY PreviewerFontStandard;
   NON_CONST_VALUE(QString) PreviewerFontStandardDef;
 }
@@ -236,6 +245,18 @@ namespace Database {
   KEY UseInMemory;
   VALUE(bool) UseInMemoryDef;
 
+  KEY InMemorySnapshotInterval;
+  VALUE(int) InMemorySnapshotIntervalDef;
+
+  KEY CompressMessageContents;
+  VALUE(bool) CompressMessageContentsDef;
+
+  KEY ArchiveMessagesOlderThan;
+  VALUE(int) ArchiveMessagesOlderThanDef;
+
+  KEY MessageContentsCompressed;
+  VALUE(bool) MessageContentsCompressedDef;
+
   KEY MySQLHostname;
   VALUE(QString) MySQLHostnameDef;
 
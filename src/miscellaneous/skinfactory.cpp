@@ -23,6 +23,8 @@
 #include <QStyleFactory>
 #include <QDomDocument>
 #include <QDomElement>
+#include <QElapsedTimer>
+#include <QDateTime>
 
 
 SkinFactory::SkinFactory(QObject *parent) : QObject(parent) {
@@ -151,6 +153,12 @@ Skin SkinFactory::skinInfo(const QString &skin_name, bool *ok) const {
   skin.m_enclosureMarkup = QByteArray::fromBase64(skin.m_enclosureMarkup.toLocal8Bit());
   skin.m_enclosureMarkup = skin.m_enclosureMarkup.replace(QSL("##"), APP_SKIN_PATH + QL1S("/") + base_folder);
 
+  // Compile markups so that messages are rendered without parsing them again.
+  skin.m_layoutTemplateWrapper = SkinTemplate(skin.m_layoutMarkupWrapper);
+  skin.m_enclosureImageTemplate = SkinTemplate(skin.m_enclosureImageMarkup);
+  skin.m_layoutTemplate = SkinTemplate(skin.m_layoutMarkup);
+  skin.m_enclosureTemplate = SkinTemplate(skin.m_enclosureMarkup);
+
   // Obtain skin raw data.
   skin.m_rawData = skin_node.namedItem(QSL("data")).toElement().text();
   skin.m_rawData = QByteArray::fromBase64(skin.m_rawData.toLocal8Bit());
@@ -169,6 +177,59 @@ Skin SkinFactory::skinInfo(const QString &skin_name, bool *ok) const {
   return skin;
 }
 
+void SkinFactory::benchmarkRendering(int message_count) const {
+  if (message_count <= 0) {
+    message_count = SKIN_BENCHMARK_MESSAGES;
+  }
+
+  // Generated message contains some "%N" sequences, just like
+  // contents of some real messages.
+  QVector<QString> values(Skin::MessageSlotCount);
+
+  values[Skin::MessageTitle - 1] = QSL("Benchmark message with 100% generated title");
+  values[Skin::MessageAuthor - 1] = QSL("Written by benchmark");
+  values[Skin::MessageUrl - 1] = QSL("http://example.com/articles/2016/benchmark-message%201.html");
+  values[Skin::MessageContents - 1] = QSL("<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit, "
+                                          "prices dropped by 50% %3 days ago.</p>").repeated(30);
+  values[Skin::MessageCreated - 1] = QDateTime::currentDateTime().toString(Qt::DefaultLocaleShortDate);
+  values[Skin::MessageReadAction - 1] = QSL("mark-read");
+  values[Skin::MessageImportanceAction - 1] = QSL("mark-starred");
+  values[Skin::MessageId - 1] = QSL("123456");
+
+  QElapsedTimer timer;
+  QString arg_output;
+  QString template_output;
+
+  // Chained QString::arg() calls, which were used before skin templates.
+  timer.start();
+
+  for (int i = 0; i < message_count; i++) {
+    arg_output.append(m_currentSkin.m_layoutMarkup.arg(values.at(0), values.at(1), values.at(2), values.at(3), values.at(4),
+                                                       values.at(5), values.at(6), values.at(7), values.at(8)).arg(values.at(9)));
+  }
+
+  const qint64 arg_time = qMax(timer.nsecsElapsed(), Q_INT64_C(1));
+
+  timer.restart();
+  template_output.reserve(m_currentSkin.m_layoutTemplate.renderedLength(values.constData(), values.size()) * message_count);
+
+  for (int i = 0; i < message_count; i++) {
+    m_currentSkin.m_layoutTemplate.render(template_output, values.constData(), values.size());
+  }
+
+  const qint64 template_time = qMax(timer.nsecsElapsed(), Q_INT64_C(1));
+
+  qDebug("Rendering of %d messages with skin '%s':", message_count, qPrintable(m_currentSkin.m_baseName));
+  qDebug("  QString::arg(): %.2f ms, %.0f messages/s, %.1f MB/s.",
+         arg_time / 1e6, message_count * 1e9 / arg_time, arg_output.size() * sizeof(QChar) * 1e3 / arg_time);
+  qDebug("  skin template: %.2f ms, %.0f messages/s, %.1f MB/s.",
+         template_time / 1e6, message_count * 1e9 / template_time, template_output.size() * sizeof(QChar) * 1e3 / template_time);
+
+  if (arg_output != template_output) {
+    qDebug("  Outputs differ, QString::arg() replaced placeholders contained in message contents.");
+  }
+}
+
 QList<Skin> SkinFactory::installedSkins() const {
   QList<Skin> skins;
   bool skin_load_ok;
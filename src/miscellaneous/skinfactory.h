@@ -20,11 +20,50 @@
 
 #include <QObject>
 
+#include "miscellaneous/skintemplate.h"
+
 #include <QStringList>
 #include <QMetaType>
 
 
 struct Skin {
+    // Slots of markup wrapper.
+    enum WrapperSlot {
+      WrapperTitle = 1,
+      WrapperBody,
+      WrapperSlotCount = WrapperBody
+    };
+
+    // Slots of single message markup.
+    enum MessageSlot {
+      MessageTitle = 1,
+      MessageAuthor,
+      MessageUrl,
+      MessageContents,
+      MessageCreated,
+      MessageEnclosures,
+      MessageReadAction,
+      MessageImportanceAction,
+      MessageId,
+      MessageEnclosureImages,
+      MessageSlotCount = MessageEnclosureImages
+    };
+
+    // Slots of enclosure markup.
+    enum EnclosureSlot {
+      EnclosureUrl = 1,
+      EnclosureTitle,
+      EnclosureMimeType,
+      EnclosureSlotCount = EnclosureMimeType
+    };
+
+    // Slots of enclosure image markup.
+    enum EnclosureImageSlot {
+      EnclosureImageUrl = 1,
+      EnclosureImageMimeType,
+      EnclosureImageSlotCount = EnclosureImageMimeType
+    };
+
     QString m_baseName;
     QString m_visibleName;
     QStringList m_stylesNames;
@@ -36,6 +75,12 @@ struct Skin {
     QString m_enclosureImageMarkup;
     QString m_layoutMarkup;
     QString m_enclosureMarkup;
+
+    // Markups above, compiled when skin is loaded.
+    SkinTemplate m_layoutTemplateWrapper;
+    SkinTemplate m_enclosureImageTemplate;
+    SkinTemplate m_layoutTemplate;
+    SkinTemplate m_enclosureTemplate;
 };
 
 Q_DECLARE_METATYPE(Skin)
@@ -64,6 +109,10 @@ class SkinFactory : public QObject {
     // Gets skin about a particular skin.
     Skin skinInfo(const QString &skin_name, bool *ok = NULL) const;
 
+    // Renders given count of generated messages with current skin
+    // and logs rendering throughput.
+    void benchmarkRendering(int message_count) const;
+
     // Returns list of installed skins.
     QList<Skin> installedSkins() const;
 
@@ -0,0 +1,100 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "miscellaneous/skintemplate.h"
+
+
+SkinTemplate::SkinTemplate(const QString &markup)
+  : m_markup(markup), m_segments(QVector<Segment>()), m_literalLength(0) {
+  const int length = markup.size();
+  int literal_start = 0;
+  int position = 0;
+
+  while ((position = markup.indexOf(QLatin1Char('%'), position)) >= 0) {
+    int slot = 0;
+    int digits = 0;
+
+    // Slot numbers have at most two digits, exactly like in QString::arg().
+    while (digits < 2 && position + 1 + digits < length && markup.at(position + 1 + digits).isDigit()) {
+      slot = slot * 10 + markup.at(position + 1 + digits).digitValue();
+      digits++;
+    }
+
+    if (slot == 0) {
+      // This is not a slot, just plain percent sign.
+      position++;
+      continue;
+    }
+
+    if (position > literal_start) {
+      Segment literal = { literal_start, position - literal_start, 0 };
+
+      m_segments.append(literal);
+      m_literalLength += literal.m_length;
+    }
+
+    Segment slot_segment = { position, 1 + digits, slot };
+
+    m_segments.append(slot_segment);
+
+    position += 1 + digits;
+    literal_start = position;
+  }
+
+  if (length > literal_start) {
+    Segment literal = { literal_start, length - literal_start, 0 };
+
+    m_segments.append(literal);
+    m_literalLength += literal.m_length;
+  }
+
+  m_segments.squeeze();
+}
+
+int SkinTemplate::renderedLength(const QString *values, int value_count) const {
+  int length = m_literalLength;
+
+  foreach (const Segment &segment, m_segments) {
+    if (segment.m_slot > 0) {
+      length += segment.m_slot <= value_count ? values[segment.m_slot - 1].size() : segment.m_length;
+    }
+  }
+
+  return length;
+}
+
+void SkinTemplate::render(QString &output, const QString *values, int value_count) const {
+  const QChar *markup = m_markup.constData();
+
+  foreach (const Segment &segment, m_segments) {
+    if (segment.m_slot == 0 || segment.m_slot > value_count) {
+      output.append(markup + segment.m_start, segment.m_length);
+    }
+    else {
+      output.append(values[segment.m_slot - 1]);
+    }
+  }
+}
+
+QString SkinTemplate::render(const QVector<QString> &values) const {
+  QString output;
+
+  output.reserve(renderedLength(values.constData(), values.size()));
+  render(output, values.constData(), values.size());
+  return output;
+}
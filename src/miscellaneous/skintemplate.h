@@ -0,0 +1,66 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SKINTEMPLATE_H
+#define SKINTEMPLATE_H
+
+#include <QString>
+#include <QVector>
+
+
+// Markup template of skin, which is parsed once into literal
+// segments and slots. Slots are written as "%1" to "%99" in the
+// markup, just like placeholders of QString::arg(). Slots without
+// value are kept in the output as they are (markup contains things like
+// "%23" in URL-encoded data).
+//
+// Unlike chained QString::arg() calls, rendering does not rescan
+// the markup and values of slots are never scanned for placeholders, so
+// values containing "%N" sequences are inserted as they are.
+class SkinTemplate {
+  public:
+    explicit SkinTemplate(const QString &markup = QString());
+
+    inline bool isEmpty() const {
+      return m_segments.isEmpty();
+    }
+
+    // Returns length of the markup rendered with given values,
+    // useful for reserving output buffer in advance.
+    int renderedLength(const QString *values, int value_count) const;
+
+    // Appends the markup to output, slot "%N" is replaced with
+    // value with index N - 1.
+    void render(QString &output, const QString *values, int value_count) const;
+    QString render(const QVector<QString> &values) const;
+
+  private:
+    struct Segment {
+      // Position of the segment in the markup, slots
+      // have non-zero number.
+      int m_start;
+      int m_length;
+      int m_slot;
+    };
+
+    QString m_markup;
+    QVector<Segment> m_segments;
+    int m_literalLength;
+};
+
+#endif // SKINTEMPLATE_H
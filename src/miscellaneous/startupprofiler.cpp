@@ -0,0 +1,157 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#include "miscellaneous/startupprofiler.h"
+
+#include "definitions/definitions.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QEvent>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QWidget>
+
+
+StartupProfiler::StartupProfiler(QObject *parent)
+  : QObject(parent), m_phaseStart(0), m_window(nullptr), m_quitAfterStartup(false), m_finished(false) {
+  m_timer.start();
+}
+
+StartupProfiler::~StartupProfiler() {
+}
+
+void StartupProfiler::processArguments(const QStringList &arguments) {
+  foreach (const QString &argument, arguments) {
+    if (argument.startsWith(QL1S(APP_STARTUP_TIMINGS))) {
+      m_reportFilePath = QDir::fromNativeSeparators(argument.mid(QString(APP_STARTUP_TIMINGS).size()));
+    }
+    else if (argument == QL1S(APP_QUIT_AFTER_STARTUP)) {
+      m_quitAfterStartup = true;
+    }
+  }
+}
+
+void StartupProfiler::finishPhase(const QString &name) {
+  if (m_finished) {
+    return;
+  }
+
+  Phase phase;
+  const qint64 now = m_timer.elapsed();
+
+  phase.m_name = name;
+  phase.m_start = m_phaseStart;
+  phase.m_duration = now - m_phaseStart;
+
+  m_phases.append(phase);
+  m_phaseStart = now;
+}
+
+void StartupProfiler::waitForFirstFrame(QWidget *window) {
+  if (window != nullptr && window->isVisible()) {
+    m_window = window;
+    m_window->installEventFilter(this);
+  }
+  else {
+    // Nothing will be painted, startup ends with first iteration of event loop.
+    QTimer::singleShot(0, this, SLOT(finish()));
+  }
+}
+
+bool StartupProfiler::quitsAfterStartup() const {
+  return m_quitAfterStartup;
+}
+
+bool StartupProfiler::eventFilter(QObject *watched, QEvent *event) {
+  if (watched == m_window && event->type() == QEvent::Paint) {
+    // Window itself is painted first, let its children finish the frame.
+    m_window->removeEventFilter(this);
+    m_window = nullptr;
+    QTimer::singleShot(0, this, SLOT(finish()));
+  }
+
+  return QObject::eventFilter(watched, event);
+}
+
+void StartupProfiler::finish() {
+  if (m_finished) {
+    return;
+  }
+
+  finishPhase(QSL("first-frame"));
+  m_finished = true;
+
+  foreach (const Phase &phase, m_phases) {
+    qDebug("Startup phase '%s' took %lld ms.", qPrintable(phase.m_name), phase.m_duration);
+  }
+
+  qDebug("Application started in %lld ms.", m_phaseStart);
+
+  if (!m_reportFilePath.isEmpty()) {
+    if (writeReport(m_reportFilePath)) {
+      qDebug("Startup timings were written to '%s'.", qPrintable(QDir::toNativeSeparators(m_reportFilePath)));
+    }
+    else {
+      qWarning("Startup timings were not written to '%s'.", qPrintable(QDir::toNativeSeparators(m_reportFilePath)));
+    }
+  }
+
+  emit finished();
+
+  if (m_quitAfterStartup) {
+    qDebug("Quitting because application was started with '%s' argument.", APP_QUIT_AFTER_STARTUP);
+    QTimer::singleShot(0, qApp, SLOT(quit()));
+  }
+}
+
+bool StartupProfiler::writeReport(const QString &file_path) const {
+  QJsonObject report;
+  QJsonArray phases;
+
+  foreach (const Phase &phase, m_phases) {
+    QJsonObject json_phase;
+
+    json_phase[QSL("name")] = phase.m_name;
+    json_phase[QSL("start")] = phase.m_start;
+    json_phase[QSL("duration")] = phase.m_duration;
+    phases.append(json_phase);
+  }
+
+  report[QSL("version")] = QSL(APP_VERSION);
+  report[QSL("total")] = m_phaseStart;
+  report[QSL("phases")] = phases;
+
+  QDir().mkpath(QFileInfo(file_path).absolutePath());
+
+  QFile file(file_path);
+
+  if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    const QByteArray data = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    const bool written = file.write(data) == data.size();
+
+    file.close();
+    return written;
+  }
+  else {
+    return false;
+  }
+}
@@ -0,0 +1,84 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QObject>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QStringList>
+
+
+class QWidget;
+
+// Measures duration of individual phases of application startup.
+//
+// Each phase ends when next one is finished, last phase ends when
+// first frame of main window is painted. Timings are then written to log
+// and optionally to JSON file given via "--startup-timings=<file>" argument.
+// With "--quit-after-startup" argument, application quits right after that,
+// which is used for startup benchmarking.
+class StartupProfiler : public QObject {
+    Q_OBJECT
+
+  public:
+    // Constructors and destructors.
+    explicit StartupProfiler(QObject *parent = 0);
+    virtual ~StartupProfiler();
+
+    // Reads startup-related options from command line arguments.
+    void processArguments(const QStringList &arguments);
+
+    // Ends currently measured phase and starts next one.
+    void finishPhase(const QString &name);
+
+    // Finishes measuring when given window paints its first frame
+    // or when event loop starts if the window is hidden.
+    void waitForFirstFrame(QWidget *window);
+
+    bool quitsAfterStartup() const;
+
+  protected:
+    bool eventFilter(QObject *watched, QEvent *event);
+
+  signals:
+    void finished();
+
+  private slots:
+    void finish();
+
+  private:
+    struct Phase {
+      QString m_name;
+      qint64 m_start;
+      qint64 m_duration;
+    };
+
+    bool writeReport(const QString &file_path) const;
+
+    QElapsedTimer m_timer;
+    qint64 m_phaseStart;
+    QList<Phase> m_phases;
+    QWidget *m_window;
+    QString m_reportFilePath;
+    bool m_quitAfterStartup;
+    bool m_finished;
+};
+
+#endif // STARTUPPROFILER_H
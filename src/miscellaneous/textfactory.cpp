@@ -27,6 +27,7 @@
 #include <QStringList>
 #include <QLocale>
 #include <QDir>
+#include <QtEndian>
 
 
 quint64 TextFactory::s_encryptionKey = 0x0;
@@ -132,6 +133,77 @@ QString TextFactory::shorten(const QString &input, int text_length_limit) {
   }
 }
 
+quint64 TextFactory::hash64(const char *data, int length, quint64 seed) {
+  static const quint64 prime_1 = Q_UINT64_C(11400714785074694791);
+  static const quint64 prime_2 = Q_UINT64_C(14029467366897019727);
+  static const quint64 prime_3 = Q_UINT64_C(1609587929392839161);
+  static const quint64 prime_4 = Q_UINT64_C(9650029242287828579);
+  static const quint64 prime_5 = Q_UINT64_C(2870177450012600261);
+
+  const uchar *input = reinterpret_cast<const uchar*>(data);
+  const uchar *end = input + length;
+  quint64 hash;
+
+  if (length >= 32) {
+    const uchar *limit = end - 32;
+    quint64 v1 = seed + prime_1 + prime_2;
+    quint64 v2 = seed + prime_2;
+    quint64 v3 = seed;
+    quint64 v4 = seed - prime_1;
+
+    do {
+      v1 = hash64Round(v1, qFromLittleEndian<quint64>(input)); input += 8;
+      v2 = hash64Round(v2, qFromLittleEndian<quint64>(input)); input += 8;
+      v3 = hash64Round(v3, qFromLittleEndian<quint64>(input)); input += 8;
+      v4 = hash64Round(v4, qFromLittleEndian<quint64>(input)); input += 8;
+    } while (input <= limit);
+
+    hash = hash64Rotate(v1, 1) + hash64Rotate(v2, 7) + hash64Rotate(v3, 12) + hash64Rotate(v4, 18);
+    hash = (hash ^ hash64Round(0, v1)) * prime_1 + prime_4;
+    hash = (hash ^ hash64Round(0, v2)) * prime_1 + prime_4;
+    hash = (hash ^ hash64Round(0, v3)) * prime_1 + prime_4;
+    hash = (hash ^ hash64Round(0, v4)) * prime_1 + prime_4;
+  }
+  else {
+    hash = seed + prime_5;
+  }
+
+  hash += (quint64) length;
+
+  while (input + 8 <= end) {
+    hash ^= hash64Round(0, qFromLittleEndian<quint64>(input));
+    hash = hash64Rotate(hash, 27) * prime_1 + prime_4;
+    input += 8;
+  }
+
+  if (input + 4 <= end) {
+    hash ^= (quint64) qFromLittleEndian<quint32>(input) * prime_1;
+    hash = hash64Rotate(hash, 23) * prime_2 + prime_3;
+    input += 4;
+  }
+
+  while (input < end) {
+    hash ^= (*input) * prime_5;
+    hash = hash64Rotate(hash, 11) * prime_1;
+    input++;
+  }
+
+  // Final avalanche.
+  hash ^= hash >> 33;
+  hash *= prime_2;
+  hash ^= hash >> 29;
+  hash *= prime_3;
+  hash ^= hash >> 32;
+
+  return hash;
+}
+
+quint64 TextFactory::hash64Round(quint64 accumulator, quint64 lane) {
+  accumulator += lane * Q_UINT64_C(14029467366897019727);
+  accumulator = hash64Rotate(accumulator, 31);
+  return accumulator * Q_UINT64_C(11400714785074694791);
+}
+
 quint64 TextFactory::initializeSecretEncryptionKey() {
   if (s_encryptionKey == 0x0) {
     // Check if file with encryption key exists.
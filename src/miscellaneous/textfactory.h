@@ -53,7 +53,21 @@ class TextFactory {
     // Shortens input string according to given length limit.
     static QString shorten(const QString &input, int text_length_limit = TEXT_TITLE_LIMIT);
 
+    // Calculates fast non-cryptographic 64bit hash (XXH64) of given data.
+    // NOTE: Result is stable across platforms and application runs.
+    static quint64 hash64(const char *data, int length, quint64 seed = 0);
+
+    static inline quint64 hash64(const QByteArray &data, quint64 seed = 0) {
+      return hash64(data.constData(), data.size(), seed);
+    }
+
   private:
+    static quint64 hash64Round(quint64 accumulator, quint64 lane);
+
+    static inline quint64 hash64Rotate(quint64 value, int bits) {
+      return (value << bits) | (value >> (64 - bits));
+    }
+
     static quint64 initializeSecretEncryptionKey();
     static quint64 generateSecretEncryptionKey();
 
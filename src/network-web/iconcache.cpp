@@ -0,0 +1,425 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#include "network-web/iconcache.h"
+
+#include "miscellaneous/application.h"
+#include "miscellaneous/iconfactory.h"
+#include "network-web/silentnetworkaccessmanager.h"
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QEventLoop>
+#include <QPixmap>
+#include <QTimer>
+#include <QFile>
+#include <QDir>
+#include <QSet>
+#include <QBuffer>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QApplication>
+#include <QStyle>
+#include <QStyleOption>
+
+
+IconCache::IconCache(QObject *parent)
+  : QObject(parent), m_network(new SilentNetworkAccessManager(this)), m_indexLoaded(false), m_indexChanged(false),
+    m_entries(QHash<QString,CacheEntry>()), m_icons(QHash<QString,QIcon>()),
+    m_pendingDownloads(QStringList()), m_runningDownloads(QHash<QNetworkReply*,QString>()), m_downloadTimeout(DOWNLOAD_TIMEOUT) {
+  if (qApp->settings()->type() == SettingsProperties::Portable) {
+    m_folder = qApp->applicationDirPath() + QDir::separator() + QString(APP_ICON_CACHE_PATH);
+  }
+  else {
+    m_folder = qApp->homeFolderPath() + QDir::separator() + QString(APP_LOW_H_NAME) +
+               QDir::separator() + QString(APP_ICON_CACHE_PATH);
+  }
+}
+
+IconCache::~IconCache() {
+  saveIndex();
+  qDebug("Destroying IconCache instance.");
+}
+
+QHash<QString,QIcon> IconCache::obtainIcons(const QStringList &urls, int timeout) {
+  QHash<QString,QIcon> icons;
+  QSet<QString> to_download;
+
+  foreach (const QString &url, urls) {
+    QIcon icon;
+
+    if (url.isEmpty() || icons.contains(url) || to_download.contains(url)) {
+      continue;
+    }
+    else if (cachedIcon(url, icon)) {
+      if (!icon.isNull()) {
+        icons.insert(url, icon);
+      }
+    }
+    else {
+      to_download.insert(url);
+    }
+  }
+
+  if (!to_download.isEmpty()) {
+    QEventLoop loop;
+
+    qDebug("Downloading %d icons, %d icons were cached.", to_download.size(), icons.size());
+
+    connect(this, SIGNAL(downloadsFinished()), &loop, SLOT(quit()));
+
+    m_downloadTimeout = timeout;
+    m_pendingDownloads.append(to_download.toList());
+    startPendingDownloads();
+    loop.exec();
+
+    foreach (const QString &url, to_download) {
+      QIcon icon;
+
+      if (cachedIcon(url, icon) && !icon.isNull()) {
+        icons.insert(url, icon);
+      }
+    }
+
+    saveIndex();
+  }
+
+  return icons;
+}
+
+bool IconCache::cachedIcon(const QString &url, QIcon &icon) {
+  loadIndex();
+
+  if (!m_entries.contains(url)) {
+    return false;
+  }
+
+  const CacheEntry entry = m_entries.value(url);
+  const int validity = entry.m_iconId.isEmpty() ? ICON_CACHE_NEGATIVE_VALIDITY : ICON_CACHE_VALIDITY;
+
+  if (entry.m_checked.secsTo(QDateTime::currentDateTimeUtc()) > validity) {
+    // Entry expired, icon should be obtained again.
+    return false;
+  }
+  else if (entry.m_iconId.isEmpty()) {
+    icon = QIcon();
+    return true;
+  }
+  else if (QFile::exists(iconFilePath(entry.m_iconId))) {
+    icon = iconForReference(QByteArray(ICON_REFERENCE_PREFIX) + entry.m_iconId.toLocal8Bit());
+    return true;
+  }
+  else {
+    // Icon file was removed from the store.
+    return false;
+  }
+}
+
+void IconCache::insertIcon(const QString &url, const QIcon &icon) {
+  const QByteArray reference = storeIcon(icon);
+  CacheEntry entry;
+
+  loadIndex();
+
+  entry.m_iconId = isReference(reference) ? QString::fromLocal8Bit(reference.mid(QByteArray(ICON_REFERENCE_PREFIX).size())) : QString();
+  entry.m_checked = QDateTime::currentDateTimeUtc();
+
+  m_entries.insert(url, entry);
+  m_indexChanged = true;
+}
+
+QByteArray IconCache::storeIcon(const QIcon &icon) {
+  if (icon.isNull()) {
+    return QByteArray();
+  }
+
+  const QByteArray icon_name = icon.name().toLocal8Bit();
+
+  if (isReference(icon_name)) {
+    // Icon was loaded from the store, no need to store it again.
+    return icon_name;
+  }
+
+  // Largest available pixmap is stored in PNG format,
+  // identifier of icon is derived from its data.
+  QSize icon_size(ICON_SIZE_SETTINGS, ICON_SIZE_SETTINGS);
+
+  foreach (const QSize &size, icon.availableSizes()) {
+    if (size.width() * size.height() > icon_size.width() * icon_size.height()) {
+      icon_size = size;
+    }
+  }
+
+  QByteArray icon_data;
+  QBuffer buffer(&icon_data);
+
+  buffer.open(QIODevice::WriteOnly);
+
+  if (!icon.pixmap(icon_size).save(&buffer, "PNG")) {
+    return QByteArray();
+  }
+
+  buffer.close();
+
+  const QString icon_id = QString::fromLatin1(QCryptographicHash::hash(icon_data, QCryptographicHash::Sha1).toHex());
+  const QString file_path = iconFilePath(icon_id);
+
+  if (!QFile::exists(file_path)) {
+    QDir().mkpath(m_folder);
+
+    if (!writeFile(file_path, icon_data)) {
+      qWarning("Icon '%s' cannot be stored, it will be embedded.", qPrintable(icon_id));
+      return IconFactory::toByteArray(icon);
+    }
+  }
+
+  return QByteArray(ICON_REFERENCE_PREFIX) + icon_id.toLocal8Bit();
+}
+
+QIcon IconCache::iconForReference(const QByteArray &reference) {
+  const QString icon_id = QString::fromLocal8Bit(reference.mid(QByteArray(ICON_REFERENCE_PREFIX).size()));
+
+  if (!m_icons.contains(icon_id)) {
+    // Icon is not decoded now, all feeds with the same
+    // icon share single instance of it.
+    m_icons.insert(icon_id, QIcon(new StoredIconEngine(icon_id, iconFilePath(icon_id))));
+  }
+
+  return m_icons.value(icon_id);
+}
+
+bool IconCache::isReference(const QByteArray &data) {
+  return data.startsWith(ICON_REFERENCE_PREFIX);
+}
+
+void IconCache::saveIndex() {
+  if (!m_indexChanged) {
+    return;
+  }
+
+  QJsonObject index;
+
+  foreach (const QString &url, m_entries.keys()) {
+    QJsonObject json_entry;
+    const CacheEntry entry = m_entries.value(url);
+
+    json_entry[QSL("icon")] = entry.m_iconId;
+    json_entry[QSL("checked")] = entry.m_checked.toMSecsSinceEpoch();
+    index[url] = json_entry;
+  }
+
+  QDir().mkpath(m_folder);
+
+  if (writeFile(m_folder + QDir::separator() + APP_ICON_CACHE_INDEX, QJsonDocument(index).toJson(QJsonDocument::Compact))) {
+    m_indexChanged = false;
+  }
+  else {
+    qWarning("Index of icon cache was not saved.");
+  }
+}
+
+void IconCache::onDownloadFinished() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+  const QString url = m_runningDownloads.take(reply);
+  const QUrl redirection_url = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+
+  reply->deleteLater();
+
+  if (redirection_url.isValid() && reply->error() == QNetworkReply::NoError) {
+    // Follow the redirection, cache entry is still created for original URL.
+    QNetworkReply *redirected_reply = m_network->get(QNetworkRequest(reply->url().resolved(redirection_url)));
+
+    m_runningDownloads.insert(redirected_reply, url);
+    connect(redirected_reply, SIGNAL(finished()), this, SLOT(onDownloadFinished()));
+    QTimer::singleShot(m_downloadTimeout, redirected_reply, SLOT(abort()));
+    return;
+  }
+
+  QPixmap icon_pixmap;
+
+  if (reply->error() == QNetworkReply::NoError && icon_pixmap.loadFromData(reply->readAll())) {
+    insertIcon(url, QIcon(icon_pixmap));
+  }
+  else {
+    // Remember that icon is not available.
+    qDebug("Icon '%s' was not obtained.", qPrintable(url));
+    insertIcon(url, QIcon());
+  }
+
+  startPendingDownloads();
+}
+
+void IconCache::startPendingDownloads() {
+  while (!m_pendingDownloads.isEmpty() && m_runningDownloads.size() < ICON_CACHE_PARALLEL_DOWNLOADS) {
+    const QString url = m_pendingDownloads.takeFirst();
+    QNetworkReply *reply = m_network->get(QNetworkRequest(QUrl(url)));
+
+    m_runningDownloads.insert(reply, url);
+    connect(reply, SIGNAL(finished()), this, SLOT(onDownloadFinished()));
+    QTimer::singleShot(m_downloadTimeout, reply, SLOT(abort()));
+  }
+
+  if (m_pendingDownloads.isEmpty() && m_runningDownloads.isEmpty()) {
+    emit downloadsFinished();
+  }
+}
+
+void IconCache::loadIndex() {
+  if (m_indexLoaded) {
+    return;
+  }
+
+  m_indexLoaded = true;
+
+  QFile index_file(m_folder + QDir::separator() + APP_ICON_CACHE_INDEX);
+
+  if (!index_file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+
+  const QJsonObject index = QJsonDocument::fromJson(index_file.readAll()).object();
+
+  index_file.close();
+
+  foreach (const QString &url, index.keys()) {
+    const QJsonObject json_entry = index.value(url).toObject();
+    CacheEntry entry;
+
+    entry.m_iconId = json_entry[QSL("icon")].toString();
+    entry.m_checked = QDateTime::fromMSecsSinceEpoch((qint64) json_entry[QSL("checked")].toDouble()).toUTC();
+    m_entries.insert(url, entry);
+  }
+
+  qDebug("Loaded %d entries of icon cache.", m_entries.size());
+}
+
+bool IconCache::writeFile(const QString &file_path, const QByteArray &data) {
+  QFile file(file_path);
+
+  if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    const bool written = file.write(data) == data.size();
+
+    file.close();
+    return written;
+  }
+  else {
+    return false;
+  }
+}
+
+QString IconCache::iconFilePath(const QString &icon_id) const {
+  return m_folder + QDir::separator() + icon_id;
+}
+
+StoredIconEngine::StoredIconEngine(const QString &icon_id, const QString &file_path)
+  : QIconEngine(), m_iconId(icon_id), m_filePath(file_path) {
+}
+
+StoredIconEngine::~StoredIconEngine() {
+}
+
+void StoredIconEngine::paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state) {
+  const QPixmap icon_pixmap = pixmap(rect.size(), mode, state);
+  QRect target_rect(QPoint(0, 0), icon_pixmap.size());
+
+  target_rect.moveCenter(rect.center());
+  painter->drawPixmap(target_rect, icon_pixmap);
+}
+
+QSize StoredIconEngine::actualSize(const QSize &size, QIcon::Mode mode, QIcon::State state) {
+  Q_UNUSED(mode)
+  Q_UNUSED(state)
+
+  const QSize original_size = originalPixmap().size();
+
+  if (original_size.width() > size.width() || original_size.height() > size.height()) {
+    return original_size.scaled(size, Qt::KeepAspectRatio);
+  }
+  else {
+    return original_size;
+  }
+}
+
+QPixmap StoredIconEngine::pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state) {
+  Q_UNUSED(state)
+
+  QPixmap icon_pixmap = originalPixmap();
+
+  if (icon_pixmap.width() > size.width() || icon_pixmap.height() > size.height()) {
+    const QString cache_key = QSL("%1%2_%3x%4").arg(QSL(ICON_REFERENCE_PREFIX), m_iconId,
+                                                  QString::number(size.width()), QString::number(size.height()));
+    QPixmap scaled_pixmap;
+
+    if (!QPixmapCache::find(cache_key, &scaled_pixmap)) {
+      scaled_pixmap = icon_pixmap.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+      QPixmapCache::insert(cache_key, scaled_pixmap);
+    }
+
+    icon_pixmap = scaled_pixmap;
+  }
+
+  if (mode != QIcon::Normal && !icon_pixmap.isNull()) {
+    QStyleOption option(0);
+
+    option.palette = QApplication::palette();
+    icon_pixmap = QApplication::style()->generatedIconPixmap(mode, icon_pixmap, &option);
+  }
+
+  return icon_pixmap;
+}
+
+QString StoredIconEngine::key() const {
+  return QSL("StoredIconEngine");
+}
+
+QIconEngine *StoredIconEngine::clone() const {
+  return new StoredIconEngine(m_iconId, m_filePath);
+}
+
+QList<QSize> StoredIconEngine::availableSizes(QIcon::Mode mode, QIcon::State state) const {
+  Q_UNUSED(mode)
+  Q_UNUSED(state)
+
+  const QPixmap icon_pixmap = originalPixmap();
+
+  return icon_pixmap.isNull() ? QList<QSize>() : QList<QSize>() << icon_pixmap.size();
+}
+
+QString StoredIconEngine::iconName() const {
+  return QString(ICON_REFERENCE_PREFIX) + m_iconId;
+}
+
+QPixmap StoredIconEngine::originalPixmap() const {
+  const QString cache_key = QString(ICON_REFERENCE_PREFIX) + m_iconId;
+  QPixmap icon_pixmap;
+
+  // Pixmaps are kept in shared cache which drops least recently
+  // used pixmaps, so they are decoded only when really needed.
+  if (!QPixmapCache::find(cache_key, &icon_pixmap)) {
+    if (icon_pixmap.load(m_filePath, "PNG")) {
+      QPixmapCache::insert(cache_key, icon_pixmap);
+    }
+    else {
+      qWarning("Icon '%s' cannot be loaded from icon store.", qPrintable(m_iconId));
+    }
+  }
+
+  return icon_pixmap;
+}
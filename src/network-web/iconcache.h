@@ -0,0 +1,129 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <QObject>
+
+#include "definitions/definitions.h"
+
+#include <QIcon>
+#include <QIconEngine>
+#include <QHash>
+#include <QDateTime>
+#include <QStringList>
+
+
+class SilentNetworkAccessManager;
+class QNetworkReply;
+
+// Downloads and caches icons of feeds.
+//
+// Downloaded icons are remembered on disk per their URL, including
+// failed downloads, so that the same icon is not downloaded again until its
+// cache entry expires. Icons themselves are kept in content-addressed store
+// as PNG files, so identical icons are stored only once and feeds refer them
+// via short references instead of embedding whole icons.
+class IconCache : public QObject {
+    Q_OBJECT
+
+  public:
+    // Constructors and destructors.
+    explicit IconCache(QObject *parent = 0);
+    virtual ~IconCache();
+
+    // Returns icons for given URLs. Icons which are not cached
+    // are downloaded in parallel. URLs whose icons cannot be obtained
+    // are not contained in returned hash.
+    // NOTE: This method blocks until all downloads are finished.
+    QHash<QString,QIcon> obtainIcons(const QStringList &urls, int timeout = DOWNLOAD_TIMEOUT);
+
+    // Returns true if there is valid cache entry for given URL, icon
+    // is null if icon was not available when it was cached.
+    bool cachedIcon(const QString &url, QIcon &icon);
+
+    // Caches icon for given URL, null icon marks icon as unavailable.
+    void insertIcon(const QString &url, const QIcon &icon);
+
+    // Puts icon into the store and returns reference to it
+    // or empty array for null icon.
+    QByteArray storeIcon(const QIcon &icon);
+
+    // Returns icon referenced by given reference. Icon
+    // is not decoded until it is painted.
+    QIcon iconForReference(const QByteArray &reference);
+
+    static bool isReference(const QByteArray &data);
+
+    // Saves list of cached URLs to disk if it changed.
+    void saveIndex();
+
+  signals:
+    void downloadsFinished();
+
+  private slots:
+    void onDownloadFinished();
+
+  private:
+    struct CacheEntry {
+      QString m_iconId;
+      QDateTime m_checked;
+    };
+
+    void startPendingDownloads();
+    void loadIndex();
+    QString iconFilePath(const QString &icon_id) const;
+
+    static bool writeFile(const QString &file_path, const QByteArray &data);
+
+    SilentNetworkAccessManager *m_network;
+    QString m_folder;
+    bool m_indexLoaded;
+    bool m_indexChanged;
+
+    QHash<QString,CacheEntry> m_entries;
+    QHash<QString,QIcon> m_icons;
+
+    QStringList m_pendingDownloads;
+    QHash<QNetworkReply*,QString> m_runningDownloads;
+    int m_downloadTimeout;
+};
+
+// Icon engine for icons from icon store. Pixmaps are decoded
+// on first use and kept in QPixmapCache.
+class StoredIconEngine : public QIconEngine {
+  public:
+    explicit StoredIconEngine(const QString &icon_id, const QString &file_path);
+    virtual ~StoredIconEngine();
+
+    void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state);
+    QSize actualSize(const QSize &size, QIcon::Mode mode, QIcon::State state);
+    QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state);
+    QString key() const;
+    QIconEngine *clone() const;
+    QList<QSize> availableSizes(QIcon::Mode mode = QIcon::Normal, QIcon::State state = QIcon::Off) const;
+    QString iconName() const;
+
+  private:
+    QPixmap originalPixmap() const;
+
+    QString m_iconId;
+    QString m_filePath;
+};
+
+#endif // ICONCACHE_H
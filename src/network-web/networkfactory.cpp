@@ -18,9 +18,11 @@
 #include "network-web/networkfactory.h"
 
 #include "definitions/definitions.h"
+#include "miscellaneous/application.h"
 #include "miscellaneous/settings.h"
 #include "network-web/silentnetworkaccessmanager.h"
 #include "network-web/downloader.h"
+#include "network-web/iconcache.h"
 
 #include <QEventLoop>
 #include <QTimer>
@@ -128,24 +130,32 @@ QString NetworkFactory::networkErrorText(QNetworkReply::NetworkError error_code)
   }
 }
 
+QString NetworkFactory::iconUrlForDomain(const QString &url) {
+  // Icons are obtained per domain, so that all feeds of single site share them.
+  const QString domain = QUrl(url).host().isEmpty() ? url : QUrl(url).host().toLower();
+
+  return QString("http://www.google.com/s2/favicons?domain=%1").arg(domain.toHtmlEscaped());
+}
+
 QNetworkReply::NetworkError NetworkFactory::downloadIcon(const QList<QString> &urls, int timeout, QIcon &output) {
-  QNetworkReply::NetworkError network_result = QNetworkReply::UnknownNetworkError;
+  QStringList icon_urls;
 
   foreach (const QString &url, urls) {
-    const QString google_s2_with_url = QString("http://www.google.com/s2/favicons?domain=%1").arg(url.toHtmlEscaped());
-    QByteArray icon_data;
-    network_result =  performNetworkOperation(google_s2_with_url, timeout, QByteArray(), QString(), icon_data,
-                                              QNetworkAccessManager::GetOperation).first;
-
-    if (network_result == QNetworkReply::NoError) {
-      QPixmap icon_pixmap;
-      icon_pixmap.loadFromData(icon_data);
-      output = QIcon(icon_pixmap);
-      break;
+    icon_urls.append(iconUrlForDomain(url));
+  }
+
+  // All possible locations are tried at once, icons are
+  // obtained from cache if possible.
+  const QHash<QString,QIcon> icons = qApp->iconCache()->obtainIcons(icon_urls, timeout);
+
+  foreach (const QString &icon_url, icon_urls) {
+    if (icons.contains(icon_url)) {
+      output = icons.value(icon_url);
+      return QNetworkReply::NoError;
     }
   }
 
-  return network_result;
+  return QNetworkReply::ContentNotFoundError;
 }
 
 NetworkResult NetworkFactory::performNetworkOperation(const QString &url, int timeout, const QByteArray &input_data,
@@ -39,8 +39,11 @@ class NetworkFactory {
     // Returns human readable text for given network error.
     static QString networkErrorText(QNetworkReply::NetworkError error_code);
 
+    // Returns URL of favicon for the site, given URL belongs to.
+    static QString iconUrlForDomain(const QString &url);
+
     // Performs SYNCHRONOUS download if favicon for the site,
-    // given URL belongs to.
+    // given URL belongs to. Icons are cached.
     static QNetworkReply::NetworkError downloadIcon(const QList<QString> &urls, int timeout, QIcon &output);
 
     static NetworkResult performNetworkOperation(const QString &url, int timeout, const QByteArray &input_data,
@@ -25,12 +25,13 @@
 #include "services/abstract/serviceroot.h"
 
 #include <QThread>
+#include <QUrl>
 
 
 Feed::Feed(RootItem *parent)
-  : RootItem(parent), m_url(QString()), m_status(Normal), m_autoUpdateType(DefaultAutoUpdate),
+  : RootItem(parent), m_url(QString()), m_status(Normal), m_contentUnchanged(false), m_autoUpdateType(DefaultAutoUpdate),
     m_autoUpdateInitialInterval(DEFAULT_AUTO_UPDATE_INTERVAL), m_autoUpdateRemainingInterval(DEFAULT_AUTO_UPDATE_INTERVAL),
-    m_totalCount(0), m_unreadCount(0) {
+    m_totalCount(0), m_unreadCount(0), m_messageFingerprints(QHash<quint64,quint64>()), m_messageFingerprintsGeneration(-1) {
   setKind(RootItemKind::Feed);
   setAutoDelete(false);
 }
@@ -38,11 +39,6 @@ Feed::Feed(RootItem *parent)
 Feed::~Feed() {
 }
 
-QList<Message> Feed::undeletedMessages() const {
-  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
-  return DatabaseQueries::getUndeletedMessagesForFeed(database, customId(), getParentServiceRoot()->accountId());
-}
-
 QVariant Feed::data(int column, int role) const {
   switch (role) {
     case Qt::ForegroundRole:
@@ -127,21 +123,71 @@ void Feed::run() {
                      << customId() << " in thread: \'"
                      << QThread::currentThreadId() << "\'.";
 
+  setContentUnchanged(false);
+
   QList<Message> msgs = obtainNewMessages();
 
+  // List is not shared with anyone yet, so messages
+  // are completed in place, without copying them.
+  resolveRelativeUrls(msgs);
   emit messagesObtained(msgs);
 }
 
+void Feed::resolveRelativeUrls(QList<Message> &messages) const {
+  QString base_url;
+
+  for (QList<Message>::iterator i = messages.begin(); i != messages.end(); i++) {
+    Message &message = *i;
+
+    if (message.m_url.startsWith(QL1S("//"))) {
+      message.m_url = QString(URI_SCHEME_HTTP) + message.m_url.mid(2);
+    }
+    else if (message.m_url.startsWith(QL1S("/"))) {
+      if (base_url.isNull()) {
+        base_url = QUrl(url()).toString(QUrl::RemoveUserInfo |
+                                        QUrl::RemovePath |
+                                        QUrl::RemoveQuery |
+                                        QUrl::RemoveFilename |
+                                        QUrl::StripTrailingSlash);
+      }
+
+      message.m_url = base_url + message.m_url;
+    }
+  }
+}
+
+void Feed::messagesStored() {
+}
+
 int Feed::updateMessages(const QList<Message> &messages) {
   int custom_id = customId();
   int account_id = getParentServiceRoot()->accountId();
   bool anything_updated = false;
   bool ok;
   QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
-  int updated_messages = DatabaseQueries::updateMessages(database, messages, custom_id, account_id, url(),
-                                                         &anything_updated, &ok);
+
+  const int fingerprints_generation = DatabaseQueries::messageStateGeneration(account_id, custom_id);
+
+  if (m_messageFingerprintsGeneration != fingerprints_generation) {
+    // Some messages of this feed were removed from DB or changed locally since we
+    // loaded fingerprints or fingerprints were not loaded yet at all, (re)load them.
+    bool fingerprints_ok;
+
+    m_messageFingerprintsGeneration = fingerprints_generation;
+    m_messageFingerprints = DatabaseQueries::getMessageFingerprintsForFeed(database, custom_id, account_id, &fingerprints_ok);
+
+    if (!fingerprints_ok) {
+      m_messageFingerprints.clear();
+      m_messageFingerprintsGeneration = -1;
+    }
+  }
+
+  int updated_messages = DatabaseQueries::updateMessages(database, messages, custom_id, account_id,
+                                                         &m_messageFingerprints, &anything_updated, &ok);
 
   if (ok) {
+    messagesStored();
+
     if (updated_messages > 0) {
       setStatus(NewMessages);
     }
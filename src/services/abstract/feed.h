@@ -24,6 +24,7 @@
 
 #include <QVariant>
 #include <QRunnable>
+#include <QHash>
 
 
 // Base class for "feed" nodes.
@@ -53,8 +54,6 @@ class Feed : public RootItem, public QRunnable {
     explicit Feed(RootItem *parent = NULL);
     virtual ~Feed();
 
-    QList<Message> undeletedMessages() const;
-
     int countOfAllMessages() const;
     int countOfUnreadMessages() const;
 
@@ -88,27 +87,53 @@ class Feed : public RootItem, public QRunnable {
       m_url = url;
     }
 
+    // Returns true if last update of this feed found out
+    // that feed data did not change since previous update.
+    inline bool contentUnchanged() const {
+      return m_contentUnchanged;
+    }
+
+    inline void setContentUnchanged(bool content_unchanged) {
+      m_contentUnchanged = content_unchanged;
+    }
+
     int updateMessages(const QList<Message> &messages);
     void updateCounts(bool including_total_count);
 
     // Runs update in thread (thread pooled).
     void run();
 
+  protected:
+    // Is called when messages obtained by last update
+    // were successfully stored in the database.
+    virtual void messagesStored();
+
   private:
     // Performs synchronous obtaining of new messages for this feed.
     virtual QList<Message> obtainNewMessages() = 0;
 
+    // Replaces relative URLs of given messages with absolute ones.
+    void resolveRelativeUrls(QList<Message> &messages) const;
+
   signals:
-    void messagesObtained(QList<Message> messages);
+    // NOTE: Messages are not modified after this is emitted, so the list
+    // is passed to other threads only as shared read-only handle.
+    void messagesObtained(const QList<Message> &messages);
 
   private:
     QString m_url;
     Status m_status;
+    bool m_contentUnchanged;
     AutoUpdateType m_autoUpdateType;
     int m_autoUpdateInitialInterval;
     int m_autoUpdateRemainingInterval;
     int m_totalCount;
     int m_unreadCount;
+
+    // Fingerprints of messages stored in DB for this feed, keyed by identity hashes.
+    // NOTE: These are lazily loaded from DB, see DatabaseQueries::messageStateGeneration().
+    QHash<quint64,quint64> m_messageFingerprints;
+    int m_messageFingerprintsGeneration;
 };
 
 Q_DECLARE_METATYPE(Feed::AutoUpdateType)
@@ -84,11 +84,8 @@ QList<QAction*> RecycleBin::contextMenu() {
   return m_contextMenu;
 }
 
-QList<Message> RecycleBin::undeletedMessages() const {
-  const int account_id = getParentServiceRoot()->accountId();
-  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
-
-  return DatabaseQueries::getUndeletedMessagesForBin(database, account_id);
+MessagesCursor RecycleBin::undeletedMessagesCursor(MessagesCursor::Columns columns) const {
+  return DatabaseQueries::getUndeletedMessagesCursorForBin(getParentServiceRoot()->accountId(), columns);
 }
 
 bool RecycleBin::markAsReadUnread(RootItem::ReadStatus status) {
@@ -22,10 +22,14 @@
 #include "services/abstract/category.h"
 #include "services/abstract/recyclebin.h"
 #include "miscellaneous/application.h"
+#include "miscellaneous/databasequeries.h"
 
 #include <QVariant>
+#include <QCollator>
 
 
+QAtomicInt RootItem::s_treeGeneration = 0;
+
 RootItem::RootItem(RootItem *parent_item)
   : QObject(nullptr),
     m_kind(RootItemKind::Root),
@@ -36,12 +40,26 @@ RootItem::RootItem(RootItem *parent_item)
     m_icon(QIcon()),
     m_creationDate(QDateTime()),
     m_childItems(QList<RootItem*>()),
-    m_parentItem(parent_item) {
+    m_parentItem(parent_item),
+    m_row(-1) {
   setupFonts();
 }
 
 RootItem::~RootItem() {
   qDeleteAll(m_childItems);
+  notifyTreeChanged();
+}
+
+const QCollatorSortKey &RootItem::titleSortKey() const {
+  if (m_titleSortKey.isNull()) {
+    // Key is created lazily when items are sorted for the first time
+    // and then only when title changes.
+    static const QCollator collator;
+
+    m_titleSortKey.reset(new QCollatorSortKey(collator.sortKey(m_title)));
+  }
+
+  return *m_titleSortKey;
 }
 
 QString RootItem::hashCode() const {
@@ -84,14 +102,22 @@ bool RootItem::markAsReadUnread(ReadStatus status) {
   return result;
 }
 
-QList<Message> RootItem::undeletedMessages() const {
-  QList<Message> messages;
+MessagesCursor RootItem::undeletedMessagesCursor(MessagesCursor::Columns columns) const {
+  const ServiceRoot *service_root = getParentServiceRoot();
+  QList<int> feed_custom_ids;
 
-  foreach (RootItem *child, m_childItems) {
-    messages.append(child->undeletedMessages());
+  if (service_root == nullptr) {
+    return MessagesCursor();
   }
 
-  return messages;
+  foreach (const Feed *feed, getSubTreeFeeds()) {
+    feed_custom_ids.append(feed->customId());
+  }
+
+  return DatabaseQueries::getUndeletedMessagesCursorForFeeds(feed_custom_ids, service_root->accountId(),
+                                                             qApp->settings()->value(GROUP(Messages),
+                                                                                     SETTING(Messages::ShowArchivedMessages)).toBool(),
+                                                             columns);
 }
 
 bool RootItem::cleanMessages(bool clear_only_read) {
@@ -120,7 +146,15 @@ void RootItem::setupFonts() {
 
 int RootItem::row() const {
   if (m_parentItem) {
-    return m_parentItem->m_childItems.indexOf(const_cast<RootItem*>(this));
+    const QList<RootItem*> &siblings = m_parentItem->m_childItems;
+
+    // Cached row is kept up to date when children are added/removed,
+    // it is looked up again only if children were changed in other way.
+    if (m_row < 0 || m_row >= siblings.size() || siblings.at(m_row) != this) {
+      m_row = siblings.indexOf(const_cast<RootItem*>(this));
+    }
+
+    return m_row;
   }
   else {
     // This item has no parent. Therefore, its row index is 0.
@@ -245,120 +279,90 @@ bool RootItem::isParentOf(const RootItem *child) const {
 }
 
 QList<RootItem*> RootItem::getSubTree() const {
-  QList<RootItem*> children;
-  QList<RootItem*> traversable_items;
-
-  traversable_items.append(const_cast<RootItem* const>(this));
-
-  // Iterate all nested items.
-  while (!traversable_items.isEmpty()) {
-    RootItem *active_item = traversable_items.takeFirst();
-
-    children.append(active_item);
-    traversable_items.append(active_item->childItems());
-  }
-
-  return children;
+  return subTreeIndex().m_items;
 }
 
 QList<RootItem*> RootItem::getSubTree(RootItemKind::Kind kind_of_item) const {
   QList<RootItem*> children;
-  QList<RootItem*> traversable_items;
 
-  traversable_items.append(const_cast<RootItem* const>(this));
-
-  // Iterate all nested items.
-  while (!traversable_items.isEmpty()) {
-    RootItem *active_item = traversable_items.takeFirst();
-
-    if ((active_item->kind() & kind_of_item) > 0) {
-      children.append(active_item);
+  foreach (RootItem *item, subTreeIndex().m_items) {
+    if ((item->kind() & kind_of_item) > 0) {
+      children.append(item);
     }
-
-    traversable_items.append(active_item->childItems());
   }
 
   return children;
 }
 
 QList<Category*> RootItem::getSubTreeCategories() const {
-  QList<Category*> children;
-  QList<RootItem*> traversable_items;
-
-  traversable_items.append(const_cast<RootItem* const>(this));
-
-  // Iterate all nested items.
-  while (!traversable_items.isEmpty()) {
-    RootItem *active_item = traversable_items.takeFirst();
-
-    if (active_item->kind() == RootItemKind::Category) {
-      children.append(active_item->toCategory());
-    }
-
-    traversable_items.append(active_item->childItems());
-  }
-
-  return children;
+  return subTreeIndex().m_categories;
 }
 
 QHash<int,Category*> RootItem::getHashedSubTreeCategories() const {
-  QHash<int,Category*> children;
-  QList<RootItem*> traversable_items;
-
-  traversable_items.append(const_cast<RootItem* const>(this));
-
-  // Iterate all nested items.
-  while (!traversable_items.isEmpty()) {
-    RootItem *active_item = traversable_items.takeFirst();
-
-    if (active_item->kind() == RootItemKind::Category && !children.contains(active_item->customId())) {
-      children.insert(active_item->customId(), active_item->toCategory());
-    }
-
-    traversable_items.append(active_item->childItems());
-  }
-
-  return children;
+  return subTreeIndex().m_categoriesByCustomId;
 }
 
 QHash<int,Feed*> RootItem::getHashedSubTreeFeeds() const {
-  QHash<int,Feed*> children;
-  QList<RootItem*> traversable_items;
+  return subTreeIndex().m_feedsByCustomId;
+}
 
-  traversable_items.append(const_cast<RootItem* const>(this));
+QList<Feed*> RootItem::getSubTreeFeeds() const {
+  return subTreeIndex().m_feeds;
+}
 
-  // Iterate all nested items.
-  while (!traversable_items.isEmpty()) {
-    RootItem *active_item = traversable_items.takeFirst();
+const RootItem::SubTreeIndex &RootItem::subTreeIndex() const {
+  const int tree_generation = s_treeGeneration.load();
 
-    if (active_item->kind() == RootItemKind::Feed && !children.contains(active_item->customId())) {
-      children.insert(active_item->customId(), active_item->toFeed());
-    }
-
-    traversable_items.append(active_item->childItems());
+  if (!m_subTreeIndex.isNull() && m_subTreeIndex->m_treeGeneration == tree_generation) {
+    return *m_subTreeIndex;
   }
 
-  return children;
-}
+  if (m_subTreeIndex.isNull()) {
+    m_subTreeIndex.reset(new SubTreeIndex());
+  }
+  else {
+    // Containers are cleared, but their memory is reused
+    // if they are not shared with any caller.
+    m_subTreeIndex->m_items.clear();
+    m_subTreeIndex->m_feeds.clear();
+    m_subTreeIndex->m_categories.clear();
+    m_subTreeIndex->m_feedsByCustomId.clear();
+    m_subTreeIndex->m_categoriesByCustomId.clear();
+  }
 
-QList<Feed*> RootItem::getSubTreeFeeds() const {
-  QList<Feed*> children;
-  QList<RootItem*> traversable_items;
+  QList<RootItem*> &items = m_subTreeIndex->m_items;
 
-  traversable_items.append(const_cast<RootItem* const>(this));
+  items.append(const_cast<RootItem* const>(this));
 
-  // Iterate all nested items.
-  while (!traversable_items.isEmpty()) {
-    RootItem *active_item = traversable_items.takeFirst();
+  // Iterate all nested items, list of items
+  // serves as queue of items being traversed.
+  for (int i = 0; i < items.size(); i++) {
+    RootItem *active_item = items.at(i);
 
     if (active_item->kind() == RootItemKind::Feed) {
-      children.append(active_item->toFeed());
+      m_subTreeIndex->m_feeds.append(active_item->toFeed());
+
+      if (!m_subTreeIndex->m_feedsByCustomId.contains(active_item->customId())) {
+        m_subTreeIndex->m_feedsByCustomId.insert(active_item->customId(), active_item->toFeed());
+      }
     }
+    else if (active_item->kind() == RootItemKind::Category) {
+      m_subTreeIndex->m_categories.append(active_item->toCategory());
 
-    traversable_items.append(active_item->childItems());
+      if (!m_subTreeIndex->m_categoriesByCustomId.contains(active_item->customId())) {
+        m_subTreeIndex->m_categoriesByCustomId.insert(active_item->customId(), active_item->toCategory());
+      }
+    }
+
+    items.append(active_item->m_childItems);
   }
 
-  return children;
+  m_subTreeIndex->m_treeGeneration = tree_generation;
+  return *m_subTreeIndex;
+}
+
+void RootItem::notifyTreeChanged() {
+  s_treeGeneration.ref();
 }
 
 ServiceRoot *RootItem::getParentServiceRoot() const {
@@ -377,7 +381,13 @@ ServiceRoot *RootItem::getParentServiceRoot() const {
 }
 
 bool RootItem::removeChild(RootItem *child) {
-  return m_childItems.removeOne(child);
+  return removeChild(child->m_parentItem == this ? child->row() : m_childItems.indexOf(child));
+}
+
+void RootItem::updateChildRows(int first_row) {
+  for (int i = first_row; i < m_childItems.size(); i++) {
+    m_childItems.at(i)->m_row = i;
+  }
 }
 
 int RootItem::customId() const {
@@ -386,6 +396,7 @@ int RootItem::customId() const {
 
 void RootItem::setCustomId(int custom_id) {
   m_customId = custom_id;
+  notifyTreeChanged();
 }
 
 Category *RootItem::toCategory() const {
@@ -413,6 +424,8 @@ int RootItem::countOfUnreadMessages() const {
 bool RootItem::removeChild(int index) {
   if (index >= 0 && index < m_childItems.size()) {
     m_childItems.removeAt(index);
+    updateChildRows(index);
+    notifyTreeChanged();
     return true;
   }
   else {
@@ -23,6 +23,10 @@
 #include <QIcon>
 #include <QDateTime>
 #include <QFont>
+#include <QCollatorSortKey>
+#include <QScopedPointer>
+#include <QHash>
+#include <QAtomicInt>
 
 
 class Category;
@@ -96,9 +100,10 @@ class RootItem : public QObject {
     // to mark this item as read/unread.
     virtual bool markAsReadUnread(ReadStatus status);
 
-    // Get ALL undeleted messages from this item in one single list.
+    // Returns cursor for reading undeleted messages of this item in chunks,
+    // so that they do not have to be held in memory all at once.
     // This is currently used for displaying items in "newspaper mode".
-    virtual QList<Message> undeletedMessages() const;
+    virtual MessagesCursor undeletedMessagesCursor(MessagesCursor::Columns columns = MessagesCursor::AllColumns) const;
 
     // This method should "clean" all messages it contains.
     // What "clean" means? It means delete messages -> move them to recycle bin
@@ -126,6 +131,7 @@ class RootItem : public QObject {
 
     inline void setParent(RootItem *parent_item) {
       m_parentItem = parent_item;
+      notifyTreeChanged();
     }
 
     inline RootItem *child(int row) {
@@ -139,6 +145,7 @@ class RootItem : public QObject {
     inline void appendChild(RootItem *child) {
       m_childItems.append(child);
       child->setParent(this);
+      child->m_row = m_childItems.size() - 1;
     }
 
     // Access to children.
@@ -150,10 +157,13 @@ class RootItem : public QObject {
     // NOTE: Children are NOT freed from the memory.
     inline void clearChildren() {
       m_childItems.clear();
+      notifyTreeChanged();
     }
 
     inline void setChildItems(QList<RootItem*> child_items) {
       m_childItems = child_items;
+      updateChildRows(0);
+      notifyTreeChanged();
     }
 
     // Removes particular child at given index.
@@ -170,6 +180,9 @@ class RootItem : public QObject {
 
     // Returns flat list of all items from subtree where this item is a root.
     // Returned list includes this item too.
+    // NOTE: Lists and hashes of subtree items are cached in the item
+    // and built again only after any tree in the model changes, so calling
+    // these methods repeatedly is cheap. Use them from main thread only.
     QList<RootItem*> getSubTree() const;
     QList<RootItem*> getSubTree(RootItemKind::Kind kind_of_item) const;
     QList<Category*> getSubTreeCategories() const;
@@ -186,6 +199,7 @@ class RootItem : public QObject {
 
     inline void setKind(RootItemKind::Kind kind) {
       m_kind = kind;
+      notifyTreeChanged();
     }
 
     // Each item can have icon.
@@ -214,8 +228,13 @@ class RootItem : public QObject {
 
     inline void setTitle(const QString &title) {
       m_title = title;
+      m_titleSortKey.reset();
     }
 
+    // Returns collation key of title, which allows fast
+    // locale-aware comparing of titles when items are sorted.
+    const QCollatorSortKey &titleSortKey() const;
+
     inline QDateTime creationDate() const {
       return m_creationDate;
     }
@@ -258,12 +277,32 @@ class RootItem : public QObject {
     ServiceRoot *toServiceRoot() const;
 
   private:
+    // Cached flat lists/hashes of items of the subtree.
+    struct SubTreeIndex {
+      int m_treeGeneration;
+      QList<RootItem*> m_items;
+      QList<Feed*> m_feeds;
+      QList<Category*> m_categories;
+      QHash<int,Feed*> m_feedsByCustomId;
+      QHash<int,Category*> m_categoriesByCustomId;
+    };
+
     void setupFonts();
 
+    // Stores row numbers into children starting with given row.
+    void updateChildRows(int first_row);
+
+    // Returns index of subtree items, builds it if any tree changed since it was built.
+    const SubTreeIndex &subTreeIndex() const;
+
+    // Invalidates indexes of all subtrees.
+    static void notifyTreeChanged();
+
     RootItemKind::Kind m_kind;
     int m_id;
     int m_customId;
     QString m_title;
+    mutable QScopedPointer<QCollatorSortKey> m_titleSortKey;
     QString m_description;
     QIcon m_icon;
     QDateTime m_creationDate;
@@ -273,6 +312,15 @@ class RootItem : public QObject {
 
     QList<RootItem*> m_childItems;
     RootItem *m_parentItem;
+
+    // Cached position of this item among children of its parent.
+    mutable int m_row;
+
+    mutable QScopedPointer<SubTreeIndex> m_subTreeIndex;
+
+    static QAtomicInt s_treeGeneration;
 };
 
+Q_DECLARE_METATYPE(RootItem::ReadStatus)
+
 #endif // ROOTITEM_H
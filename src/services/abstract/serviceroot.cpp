@@ -22,19 +22,29 @@
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/textfactory.h"
 #include "miscellaneous/databasequeries.h"
+#include "miscellaneous/mutex.h"
+#include "network-web/iconcache.h"
 #include "services/abstract/category.h"
 #include "services/abstract/feed.h"
 #include "services/abstract/recyclebin.h"
 
 #include <QSqlTableModel>
+#include <QSqlError>
+#include <QSet>
+#include <QThread>
+#include <QMutex>
 
 
-ServiceRoot::ServiceRoot(RootItem *parent) : RootItem(parent), m_accountId(NO_PARENT_CATEGORY) {
+ServiceRoot::ServiceRoot(RootItem *parent)
+  : RootItem(parent), m_accountId(NO_PARENT_CATEGORY), m_pendingChangesMutex(new QMutex()),
+    m_pushedChangesIds(QSet<int>()), m_pushMutex(new QMutex()) {
   setKind(RootItemKind::ServiceRoot);
   setCreationDate(QDateTime::currentDateTime());
 }
 
 ServiceRoot::~ServiceRoot() {
+  delete m_pendingChangesMutex;
+  delete m_pushMutex;
 }
 
 bool ServiceRoot::deleteViaGui() {
@@ -166,18 +176,246 @@ bool ServiceRoot::cleanFeeds(QList<Feed*> items, bool clean_read_only) {
   }
 }
 
-void ServiceRoot::storeNewFeedTree(RootItem *root) {
+bool ServiceRoot::mergeNewFeedTree(RootItem *new_tree) {
   QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
 
-  if (DatabaseQueries::storeAccountTree(database, root, accountId())) {
+  // Remember where each item of new tree belongs and detach all items from
+  // the tree. Each of them is either adopted by this account or thrown away.
+  QList<RootItem*> new_items = new_tree->getSubTree();
+  QHash<RootItem*,RootItem*> new_parents;
+
+  new_items.removeFirst();
+
+  foreach (RootItem *new_item, new_items) {
+    new_parents.insert(new_item, new_item->parent());
+  }
+
+  new_tree->clearChildren();
+
+  foreach (RootItem *new_item, new_items) {
+    new_item->clearChildren();
+    new_item->setParent(nullptr);
+  }
+
+  // Items are matched via their custom IDs.
+  const QHash<int,Category*> old_categories = getHashedSubTreeCategories();
+  const QHash<int,Feed*> old_feeds = getHashedSubTreeFeeds();
+  QSet<int> synced_categories;
+  QSet<int> synced_feeds;
+
+  // Items of new tree mapped to items of this account.
+  QHash<RootItem*,RootItem*> local_items;
+  local_items.insert(new_tree, this);
+
+  QList<QPair<RootItem*,RootItem*> > reassignments;
+  QHash<RootItem*,QString> new_titles;
+  QHash<RootItem*,QIcon> new_icons;
+  QList<RootItem*> unused_items;
+  bool result = true;
+
+  // Archive database cannot be attached inside transaction.
+  qApp->database()->attachArchiveDatabase(database, false);
+
+  if (!database.transaction()) {
+    qWarning("Cannot start transaction for synchronization of feed tree: '%s'.", qPrintable(database.lastError().text()));
+    qDeleteAll(new_items);
+    return false;
+  }
+
+  // Items of new tree are sorted so that each parent precedes its children.
+  foreach (RootItem *new_item, new_items) {
+    RootItem *local_parent = local_items.value(new_parents.value(new_item));
+
+    if (new_item->kind() == RootItemKind::Category) {
+      const int parent_id = local_parent == this ? NO_PARENT_CATEGORY : local_parent->id();
+      RootItem *local_category = old_categories.value(new_item->customId());
+
+      if (synced_categories.contains(new_item->customId())) {
+        unused_items.append(new_item);
+        continue;
+      }
+
+      synced_categories.insert(new_item->customId());
+
+      if (local_category == nullptr) {
+        // Category is new.
+        result &= DatabaseQueries::storeSyncedCategory(database, new_item, parent_id, accountId());
+        local_items.insert(new_item, new_item);
+        reassignments.append(QPair<RootItem*,RootItem*>(new_item, local_parent));
+      }
+      else {
+        const bool renamed = local_category->title() != new_item->title();
+        const bool moved = local_category->parent() != local_parent;
+
+        if (renamed || moved) {
+          result &= DatabaseQueries::updateSyncedCategory(database, local_category->id(), parent_id, new_item->title());
+        }
+
+        if (renamed) {
+          new_titles.insert(local_category, new_item->title());
+        }
+
+        if (moved) {
+          reassignments.append(QPair<RootItem*,RootItem*>(local_category, local_parent));
+        }
+
+        local_items.insert(new_item, local_category);
+        unused_items.append(new_item);
+      }
+    }
+    else if (new_item->kind() == RootItemKind::Feed) {
+      const int parent_custom_id = local_parent == this ? NO_PARENT_CATEGORY : local_parent->customId();
+      Feed *local_feed = old_feeds.value(new_item->customId());
+
+      if (synced_feeds.contains(new_item->customId())) {
+        unused_items.append(new_item);
+        continue;
+      }
+
+      synced_feeds.insert(new_item->customId());
+
+      if (local_feed == nullptr) {
+        // Feed is new.
+        result &= DatabaseQueries::storeSyncedFeed(database, new_item->toFeed(), parent_custom_id, accountId());
+        reassignments.append(QPair<RootItem*,RootItem*>(new_item, local_parent));
+      }
+      else {
+        const bool renamed = local_feed->title() != new_item->title();
+        const bool moved = local_feed->parent() != local_parent;
+
+        // Service does not have to provide icons, keep existing icon then.
+        // Icons are compared via their references to icon store, which
+        // are derived from icon data, so icons are not rendered.
+        const QByteArray new_icon_reference = qApp->iconCache()->storeIcon(new_item->icon());
+        const bool icon_changed = !new_icon_reference.isEmpty() &&
+                                  new_icon_reference != qApp->iconCache()->storeIcon(local_feed->icon());
+
+        if (renamed || moved) {
+          result &= DatabaseQueries::updateSyncedFeed(database, local_feed->id(), parent_custom_id, new_item->title());
+        }
+
+        if (icon_changed) {
+          result &= DatabaseQueries::updateFeedIcon(database, local_feed->id(), new_item->icon());
+          new_icons.insert(local_feed, new_item->icon());
+        }
+
+        if (renamed) {
+          new_titles.insert(local_feed, new_item->title());
+        }
+
+        if (moved) {
+          reassignments.append(QPair<RootItem*,RootItem*>(local_feed, local_parent));
+        }
+
+        unused_items.append(new_item);
+      }
+    }
+    else {
+      unused_items.append(new_item);
+    }
+  }
+
+  // Remove items which are not present in new tree, feeds first.
+  QList<RootItem*> removed_items;
+
+  foreach (Feed *feed, old_feeds) {
+    if (!synced_feeds.contains(feed->customId())) {
+      result &= DatabaseQueries::deleteFeed(database, feed->customId(), accountId());
+      removed_items.append(feed);
+    }
+  }
+
+  // Nested categories are removed before their parents.
+  QList<Category*> categories = getSubTreeCategories();
+
+  for (int i = categories.size() - 1; i >= 0; i--) {
+    if (!synced_categories.contains(categories.at(i)->customId())) {
+      result &= DatabaseQueries::deleteCategory(database, categories.at(i)->id());
+      removed_items.append(categories.at(i));
+    }
+  }
+
+  // Some feeds were maybe removed, so remove left over messages.
+  result &= DatabaseQueries::purgeLeftoverMessages(database, accountId());
+
+  if (!result || !database.commit()) {
+    qWarning("Synchronization of feed tree failed, changes are rolled back: '%s'.", qPrintable(database.lastError().text()));
+    database.rollback();
+    qDeleteAll(new_items);
+    return false;
+  }
+
+  // Changes are stored, propagate them to the model.
+  QList<RootItem*> changed_items;
+
+  foreach (RootItem *item, new_titles.keys()) {
+    item->setTitle(new_titles.value(item));
+    changed_items.append(item);
+  }
+
+  foreach (RootItem *item, new_icons.keys()) {
+    item->setIcon(new_icons.value(item));
+
+    if (!changed_items.contains(item)) {
+      changed_items.append(item);
+    }
+  }
+
+  QList<RootItem*> items_to_expand;
+
+  for (int i = 0; i < reassignments.size(); i++) {
+    RootItem *item = reassignments.at(i).first;
+
+    requestItemReassignment(item, reassignments.at(i).second);
+
+    if (item->kind() == RootItemKind::Feed) {
+      changed_items.append(item);
+    }
+  }
+
+  for (int i = 0; i < reassignments.size(); i++) {
+    RootItem *item = reassignments.at(i).first;
+
+    if (item->kind() == RootItemKind::Category &&
+        qApp->settings()->value(GROUP(CategoriesExpandStates), item->hashCode(), item->childCount() > 0).toBool()) {
+      items_to_expand.append(item);
+    }
+  }
+
+  foreach (RootItem *item, removed_items) {
+    RootItem *parent = item->parent();
+
+    requestItemRemoval(item);
+
+    if (parent != nullptr && !removed_items.contains(parent) && !changed_items.contains(parent)) {
+      changed_items.append(parent);
+    }
+  }
+
+  qDeleteAll(unused_items);
+
+  qDebug("Synchronization of feed tree of account %d done: %d items changed, %d moved/added, %d removed.",
+         accountId(), new_titles.size() + new_icons.size(), reassignments.size(), removed_items.size());
+
+  if (!reassignments.isEmpty() || !removed_items.isEmpty()) {
     RecycleBin *bin = recycleBin();
 
-    if (bin != nullptr && !childItems().contains(bin)) {
-      // As the last item, add recycle bin, which is needed.
-      appendChild(bin);
-      bin->updateCounts(true);
+    updateCounts(true);
+
+    if (bin != nullptr) {
+      changed_items.append(bin);
     }
+
+    requestReloadMessageList(false);
+  }
+
+  itemChanged(changed_items);
+
+  if (!items_to_expand.isEmpty()) {
+    requestItemExpand(items_to_expand, true);
   }
+
+  return true;
 }
 
 void ServiceRoot::removeLeftOverMessages() {
@@ -186,10 +424,11 @@ void ServiceRoot::removeLeftOverMessages() {
   DatabaseQueries::purgeLeftoverMessages(database, accountId());
 }
 
-QList<Message> ServiceRoot::undeletedMessages() const {
-  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
-
-  return DatabaseQueries::getUndeletedMessagesForAccount(database, accountId());
+MessagesCursor ServiceRoot::undeletedMessagesCursor(MessagesCursor::Columns columns) const {
+  return DatabaseQueries::getUndeletedMessagesCursorForAccount(accountId(),
+                                                               qApp->settings()->value(GROUP(Messages),
+                                                                                       SETTING(Messages::ShowArchivedMessages)).toBool(),
+                                                               columns);
 }
 
 void ServiceRoot::itemChanged(const QList<RootItem*> &items) {
@@ -217,6 +456,17 @@ void ServiceRoot::requestItemRemoval(RootItem *item) {
 }
 
 void ServiceRoot::syncIn() {
+  if (!qApp->feedUpdateLock()->tryLock()) {
+    // Feeds cannot be merged while they are updated or edited,
+    // sync-in is performed as soon as critical operation finishes.
+    qDebug("Delaying sync-in of account '%s' due to another running critical operation.", qPrintable(title()));
+    connect(qApp->feedUpdateLock(), SIGNAL(unlocked()), this, SLOT(syncIn()),
+            (Qt::ConnectionType) (Qt::UniqueConnection | Qt::QueuedConnection));
+    return;
+  }
+
+  disconnect(qApp->feedUpdateLock(), SIGNAL(unlocked()), this, SLOT(syncIn()));
+
   QIcon original_icon = icon();
 
   setIcon(qApp->icons()->fromTheme(QSL("view-refresh")));
@@ -225,56 +475,20 @@ void ServiceRoot::syncIn() {
   RootItem *new_tree = obtainNewTreeForSyncIn();
 
   if (new_tree != nullptr) {
-    // Purge old data from SQL and clean all model items.
+    // Items which get moved are re-inserted into the model,
+    // so save their expand states first.
     requestItemExpandStateSave(this);
 
-    QMap<int,QVariant> feed_custom_data = storeCustomFeedsData();
-
-    removeOldFeedTree(false);
-    cleanAllItems();
-    restoreCustomFeedsData(feed_custom_data, new_tree->getHashedSubTreeFeeds());
-
-    // Model is clean, now store new tree into DB and
-    // set primary IDs of the items.
-    storeNewFeedTree(new_tree);
-
-    // We have new feed, some feeds were maybe removed,
-    // so remove left over messages.
-    removeLeftOverMessages();
-
-    foreach (RootItem *top_level_item, new_tree->childItems()) {
-      top_level_item->setParent(nullptr);
-      requestItemReassignment(top_level_item, this);
-    }
-
-    updateCounts(true);
+    // Only differences between current and new tree are applied.
+    mergeNewFeedTree(new_tree);
 
-    new_tree->clearChildren();
     new_tree->deleteLater();
-
-    QList<RootItem*> all_items = getSubTree();
-
-    itemChanged(all_items);
-    requestReloadMessageList(true);
-
-    // Now we must refresh expand states.
-    QList<RootItem*> items_to_expand;
-
-    foreach (RootItem *item, all_items) {
-      if (qApp->settings()->value(GROUP(CategoriesExpandStates), item->hashCode(), item->childCount() > 0).toBool()) {
-        items_to_expand.append(item);
-      }
-    }
-
-    if (!items_to_expand.contains(this)) {
-      items_to_expand.prepend(this);
-    }
-
-    requestItemExpand(items_to_expand, true);
   }
 
   setIcon(original_icon);
   itemChanged(QList<RootItem*>() << this);
+
+  qApp->feedUpdateLock()->unlock();
 }
 
 RootItem *ServiceRoot::obtainNewTreeForSyncIn() const {
@@ -375,6 +589,172 @@ QStringList ServiceRoot::customIDsOfMessages(const QList<Message> &messages) {
   return list;
 }
 
+bool ServiceRoot::recordPendingChanges(const QList<Message> &messages, RootItem::ReadStatus read) {
+  QList<PendingChange> changes;
+  changes.reserve(messages.size());
+
+  foreach (const Message &message, messages) {
+    PendingChange change;
+
+    change.m_id = 0;
+    change.m_type = PendingChange::Read;
+    change.m_value = read;
+    change.m_customId = message.m_customId;
+    change.m_feedId = message.m_feedId;
+    change.m_customHash = message.m_customHash;
+    changes.append(change);
+  }
+
+  return recordPendingChanges(changes);
+}
+
+bool ServiceRoot::recordPendingChanges(const QList<ImportanceChange> &changes) {
+  QList<PendingChange> pending_changes;
+  pending_changes.reserve(changes.size());
+
+  foreach (const ImportanceChange &pair, changes) {
+    PendingChange change;
+
+    change.m_id = 0;
+    change.m_type = PendingChange::Importance;
+    change.m_value = pair.second;
+    change.m_customId = pair.first.m_customId;
+    change.m_feedId = pair.first.m_feedId;
+    change.m_customHash = pair.first.m_customHash;
+    pending_changes.append(change);
+  }
+
+  return recordPendingChanges(pending_changes);
+}
+
+bool ServiceRoot::recordPendingChanges(const QList<PendingChange> &changes) {
+  if (changes.isEmpty()) {
+    return true;
+  }
+
+  m_pendingChangesMutex->lock();
+  const bool recorded = DatabaseQueries::recordPendingChanges(pendingChangesConnection(), accountId(),
+                                                              changes, m_pushedChangesIds);
+  m_pendingChangesMutex->unlock();
+
+  if (recorded) {
+    emit pendingChangesRecorded();
+    return true;
+  }
+  else {
+    qWarning("Failed to record %d pending changes of account %d.", changes.size(), accountId());
+    return false;
+  }
+}
+
+bool ServiceRoot::pushPendingChanges() {
+  QMutexLocker push_locker(m_pushMutex);
+  QSqlDatabase database = pendingChangesConnection();
+
+  forever {
+    bool ok;
+
+    // Changes are marked as being pushed, so that changes
+    // recorded meanwhile do not cancel them.
+    m_pendingChangesMutex->lock();
+    QList<PendingChange> changes = DatabaseQueries::getPendingChanges(database, accountId(), PENDING_CHANGES_BATCH, &ok);
+
+    foreach (const PendingChange &change, changes) {
+      m_pushedChangesIds.insert(change.m_id);
+    }
+
+    m_pendingChangesMutex->unlock();
+
+    if (!ok) {
+      return false;
+    }
+    else if (changes.isEmpty()) {
+      return true;
+    }
+
+    qDebug("Pushing %d pending changes of account %d.", changes.size(), accountId());
+
+    // Changes are obtained in order in which they were recorded. Only the latest
+    // change of each message is sent, older ones are superseded by it.
+    QList<PendingChange> superseded_changes;
+    QSet<QString> changed_messages;
+
+    for (int i = changes.size() - 1; i >= 0; i--) {
+      const QString message_key = QString::number(changes.at(i).m_type) + QL1C('_') + changes.at(i).m_customId;
+
+      if (changed_messages.contains(message_key)) {
+        superseded_changes.append(changes.takeAt(i));
+      }
+      else {
+        changed_messages.insert(message_key);
+      }
+    }
+
+    const bool superseded_removed = DatabaseQueries::removePendingChanges(database, superseded_changes);
+
+    finishPendingChanges(superseded_changes);
+
+    if (!superseded_removed) {
+      finishPendingChanges(changes);
+      return false;
+    }
+
+    // Changes are sorted by their types and values, so that changes
+    // which can be sent together are next to each other.
+    qStableSort(changes.begin(), changes.end(), PendingChange::lessThan);
+    int group_start = 0;
+
+    for (int i = 1; i <= changes.size(); i++) {
+      if (i < changes.size() &&
+          changes.at(i).m_type == changes.at(group_start).m_type &&
+          changes.at(i).m_value == changes.at(group_start).m_value) {
+        continue;
+      }
+
+      const QList<PendingChange> group = changes.mid(group_start, i - group_start);
+
+      if (!sendPendingChanges(group.first().m_type, group.first().m_value, group) ||
+          !DatabaseQueries::removePendingChanges(database, group)) {
+        qWarning("Failed to push %d pending changes of account %d.", group.size(), accountId());
+        finishPendingChanges(changes.mid(group_start));
+        return false;
+      }
+
+      finishPendingChanges(group);
+      group_start = i;
+    }
+  }
+}
+
+bool ServiceRoot::sendPendingChanges(PendingChange::Type type, int value, const QList<PendingChange> &changes) {
+  Q_UNUSED(type)
+  Q_UNUSED(value)
+  Q_UNUSED(changes)
+
+  return true;
+}
+
+void ServiceRoot::finishPendingChanges(const QList<PendingChange> &changes) {
+  m_pendingChangesMutex->lock();
+
+  foreach (const PendingChange &change, changes) {
+    m_pushedChangesIds.remove(change.m_id);
+  }
+
+  m_pendingChangesMutex->unlock();
+}
+
+bool PendingChange::lessThan(const PendingChange &lhs, const PendingChange &rhs) {
+  return lhs.m_type < rhs.m_type || (lhs.m_type == rhs.m_type && lhs.m_value < rhs.m_value);
+}
+
+QSqlDatabase ServiceRoot::pendingChangesConnection() const {
+  // Changes are recorded and pushed from various threads, each
+  // thread needs its own connection.
+  const QString connection_name = QSL("PendingChanges_") + QString::number((quintptr) QThread::currentThreadId());
+  return qApp->database()->connection(connection_name, DatabaseFactory::FromSettings);
+}
+
 int ServiceRoot::accountId() const {
   return m_accountId;
 }
@@ -23,18 +23,43 @@
 #include "core/message.h"
 
 #include <QPair>
+#include <QSet>
 
 
 class FeedsModel;
 class RecycleBin;
 class QAction;
 class QSqlTableModel;
+class QSqlDatabase;
+class QMutex;
 
 // Car here represents ID of the item.
 typedef QList<QPair<int,RootItem*> > Assignment;
 typedef QPair<int,RootItem*> AssignmentItem;
 typedef QPair<Message,RootItem::Importance> ImportanceChange;
 
+// Change of state of message, which was made locally and which
+// is not yet pushed to online service.
+struct PendingChange {
+  enum Type {
+    Read = 0,
+    Importance = 1
+  };
+
+  int m_id;
+  Type m_type;
+
+  // New state of message, either RootItem::ReadStatus or RootItem::Importance.
+  int m_value;
+
+  QString m_customId;
+  QString m_feedId;
+  QString m_customHash;
+
+  // Orders changes by their types and values.
+  static bool lessThan(const PendingChange &lhs, const PendingChange &rhs);
+};
+
 // THIS IS the root node of the service.
 // NOTE: The root usually contains some core functionality of the
 // service like service account username/password etc.
@@ -71,7 +96,7 @@ class ServiceRoot : public RootItem {
 
     void updateCounts(bool including_total_count);
 
-    QList<Message> undeletedMessages() const;
+    MessagesCursor undeletedMessagesCursor(MessagesCursor::Columns columns = MessagesCursor::AllColumns) const;
 
     // Start/stop services.
     // Start method is called when feed model gets initialized OR after user adds new service.
@@ -155,6 +180,13 @@ class ServiceRoot : public RootItem {
     QStringList customIDSOfMessagesForItem(RootItem *item);
     bool markFeedsReadUnread(QList<Feed*> items, ReadStatus read);
 
+    // Pushes all changes of messages recorded in journal of pending changes
+    // to online service. Pushed changes are removed from the journal.
+    // Only one push of the account runs at a time, changes recorded
+    // meanwhile never cancel changes which are being pushed.
+    // NOTE: This method is called from worker threads.
+    bool pushPendingChanges();
+
     // Obvious methods to wrap signals.
     void itemChanged(const QList<RootItem*> &items);
     void requestReloadMessageList(bool mark_selected_messages_read);
@@ -176,9 +208,13 @@ class ServiceRoot : public RootItem {
     // Removes all messages/categories/feeds which are
     // associated with this account.
     void removeOldFeedTree(bool including_messages);
-    void storeNewFeedTree(RootItem *root);
     void cleanAllItems();
 
+    // Synchronizes feeds/categories of this account with given new tree. Items are matched
+    // via their custom IDs and only inserts, moves, renames and removals are performed,
+    // all of them in single DB transaction. New tree is left empty.
+    bool mergeNewFeedTree(RootItem *new_tree);
+
     // Removes messages which do not belong to any
     // existing feed.
     //
@@ -190,6 +226,15 @@ class ServiceRoot : public RootItem {
     QStringList customIDsOfMessages(const QList<ImportanceChange> &changes);
     QStringList customIDsOfMessages(const QList<Message> &messages);
 
+    // Records changes of given messages into journal of pending changes,
+    // changes are pushed to online service later in background.
+    bool recordPendingChanges(const QList<Message> &messages, ReadStatus read);
+    bool recordPendingChanges(const QList<ImportanceChange> &changes);
+
+    // Sends given pending changes, which all set the same "value" of given "type",
+    // to online service. Returns true if service accepted the changes.
+    virtual bool sendPendingChanges(PendingChange::Type type, int value, const QList<PendingChange> &changes);
+
     // Takes lists of feeds/categories and assembles them into the tree structure.
     void assembleCategories(Assignment categories);
     void assembleFeeds(Assignment feeds);
@@ -204,11 +249,20 @@ class ServiceRoot : public RootItem {
     void itemReassignmentRequested(RootItem *item, RootItem *new_parent);
     void itemRemovalRequested(RootItem *item);
 
+    // Emitted if new changes were recorded into journal of pending changes.
+    void pendingChangesRecorded();
+
   private:
-    virtual QMap<int,QVariant> storeCustomFeedsData() = 0;
-    virtual void restoreCustomFeedsData(const QMap<int,QVariant> &data, const QHash<int,Feed*> &feeds) = 0;
+    bool recordPendingChanges(const QList<PendingChange> &changes);
+    QSqlDatabase pendingChangesConnection() const;
+    void finishPendingChanges(const QList<PendingChange> &changes);
 
     int m_accountId;
+
+    // Guards journal of pending changes and IDs of changes being pushed.
+    QMutex *m_pendingChangesMutex;
+    QSet<int> m_pushedChangesIds;
+    QMutex *m_pushMutex;
 };
 
 #endif // SERVICEROOT_H
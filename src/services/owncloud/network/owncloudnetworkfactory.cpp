@@ -19,9 +19,9 @@
 
 #include "services/owncloud/definitions.h"
 #include "network-web/networkfactory.h"
+#include "network-web/iconcache.h"
 #include "miscellaneous/application.h"
 #include "miscellaneous/settings.h"
-#include "miscellaneous/textfactory.h"
 #include "services/abstract/rootitem.h"
 #include "services/owncloud/owncloudcategory.h"
 #include "services/owncloud/owncloudfeed.h"
@@ -515,26 +515,28 @@ RootItem *OwnCloudGetFeedsCategoriesResponse::feedsCategories(bool obtain_icons)
     parent->appendChild(category);
   }
 
+  const QJsonArray feeds = QJsonDocument::fromJson(m_contentFeeds.toUtf8()).object()["feeds"].toArray();
+  QHash<QString,QIcon> icons;
+
+  if (obtain_icons) {
+    QStringList icon_paths;
+
+    foreach (QJsonValue fed, feeds) {
+      icon_paths.append(fed.toObject()["faviconLink"].toString());
+    }
+
+    // Icons of all feeds are obtained at once.
+    icons = qApp->iconCache()->obtainIcons(icon_paths);
+  }
+
   // We have categories added, now add all feeds.
-  foreach (QJsonValue fed, QJsonDocument::fromJson(m_contentFeeds.toUtf8()).object()["feeds"].toArray()) {
+  foreach (QJsonValue fed, feeds) {
     QJsonObject item = fed.toObject();
     OwnCloudFeed *feed = new OwnCloudFeed();
+    QString icon_path = item["faviconLink"].toString();
 
-    if (obtain_icons) {
-      QString icon_path = item["faviconLink"].toString();
-
-      if (!icon_path.isEmpty()) {
-        QByteArray icon_data;
-
-        if (NetworkFactory::performNetworkOperation(icon_path, DOWNLOAD_TIMEOUT,
-                                                    QByteArray(), QString(), icon_data,
-                                                    QNetworkAccessManager::GetOperation).first == QNetworkReply::NoError) {
-          // Icon downloaded, set it up.
-          QPixmap icon_pixmap;
-          icon_pixmap.loadFromData(icon_data);
-          feed->setIcon(QIcon(icon_pixmap));
-        }
-      }
+    if (icons.contains(icon_path)) {
+      feed->setIcon(icons.value(icon_path));
     }
 
     feed->setUrl(item["link"].toString());
@@ -556,14 +558,15 @@ OwnCloudGetMessagesResponse::~OwnCloudGetMessagesResponse() {
 
 QList<Message> OwnCloudGetMessagesResponse::messages() const {
   QList<Message> msgs;
+  MessageStringPool strings;
 
   foreach (QJsonValue message, m_rawContent["items"].toArray()) {
     QJsonObject message_map = message.toObject();
     Message msg;
 
-    msg.m_author = message_map["author"].toString();
+    msg.m_author = strings.intern(message_map["author"].toString());
     msg.m_contents = message_map["body"].toString();
-    msg.m_created = TextFactory::parseDateTime(message_map["pubDate"].toDouble() * 1000);
+    msg.m_created = qint64(message_map["pubDate"].toDouble() * 1000);
     msg.m_createdFromFeed = true;
     msg.m_customId = message_map["id"].toString();
     msg.m_customHash = message_map["guidHash"].toString();
@@ -573,13 +576,13 @@ QList<Message> OwnCloudGetMessagesResponse::messages() const {
     if (!enclosure_link.isEmpty()) {
       Enclosure enclosure;
 
-      enclosure.m_mimeType = message_map["enclosureMime"].toString();
+      enclosure.m_mimeType = strings.intern(message_map["enclosureMime"].toString());
       enclosure.m_url = enclosure_link;
 
       msg.m_enclosures.append(enclosure);
     }
 
-    msg.m_feedId = message_map["feedId"].toString();
+    msg.m_feedId = strings.intern(message_map["feedId"].toString());
     msg.m_isImportant = message_map["starred"].toBool();
     msg.m_isRead = !message_map["unread"].toBool();
     msg.m_title = message_map["title"].toString();
@@ -117,46 +117,39 @@ bool OwnCloudServiceRoot::onBeforeSetMessagesRead(RootItem *selected_item, const
                                                   RootItem::ReadStatus read) {
   Q_UNUSED(selected_item)
 
-  QNetworkReply::NetworkError reply = network()->markMessagesRead(read, customIDsOfMessages(messages));
-  return reply == QNetworkReply::NoError;
+  // Server is not contacted here, change is pushed to it later in background.
+  return recordPendingChanges(messages, read);
 }
 
 bool OwnCloudServiceRoot::onBeforeSwitchMessageImportance(RootItem *selected_item,
                                                           const QList<ImportanceChange> &changes) {
   Q_UNUSED(selected_item)
 
-  // Now, we need to separate the changes because of ownCloud API limitations.
-  QStringList mark_starred_feed_ids, mark_starred_guid_hashes;
-  QStringList mark_unstarred_feed_ids, mark_unstarred_guid_hashes;
-
-  foreach (const ImportanceChange &pair, changes) {
-    if (pair.second == RootItem::Important) {
-      mark_starred_feed_ids.append(pair.first.m_feedId);
-      mark_starred_guid_hashes.append(pair.first.m_customHash);
-    }
-    else {
-      mark_unstarred_feed_ids.append(pair.first.m_feedId);
-      mark_unstarred_guid_hashes.append(pair.first.m_customHash);
-    }
-  }
+  return recordPendingChanges(changes);
+}
 
-  // OK, now perform the online update itself.
+bool OwnCloudServiceRoot::sendPendingChanges(PendingChange::Type type, int value, const QList<PendingChange> &changes) {
+  if (type == PendingChange::Read) {
+    QStringList ids;
+    ids.reserve(changes.size());
 
-  if (!mark_starred_feed_ids.isEmpty()) {
-    if (network()->markMessagesStarred(RootItem::Important, mark_starred_feed_ids, mark_starred_guid_hashes) !=
-        QNetworkReply::NoError) {
-      return false;
+    foreach (const PendingChange &change, changes) {
+      ids.append(change.m_customId);
     }
+
+    return network()->markMessagesRead((RootItem::ReadStatus) value, ids) == QNetworkReply::NoError;
   }
+  else {
+    // ownCloud API identifies starred messages via their feeds and GUID hashes.
+    QStringList feed_ids, guid_hashes;
 
-  if (!mark_unstarred_feed_ids.isEmpty()) {
-    if (network()->markMessagesStarred(RootItem::NotImportant, mark_unstarred_feed_ids, mark_unstarred_guid_hashes) !=
-        QNetworkReply::NoError) {
-      return false;
+    foreach (const PendingChange &change, changes) {
+      feed_ids.append(change.m_feedId);
+      guid_hashes.append(change.m_customHash);
     }
-  }
 
-  return true;
+    return network()->markMessagesStarred((RootItem::Importance) value, feed_ids, guid_hashes) == QNetworkReply::NoError;
+  }
 }
 
 void OwnCloudServiceRoot::updateTitle() {
@@ -217,33 +210,6 @@ void OwnCloudServiceRoot::addNewFeed(const QString &url) {
 void OwnCloudServiceRoot::addNewCategory() {
 }
 
-QMap<int,QVariant> OwnCloudServiceRoot::storeCustomFeedsData() {
-  QMap<int,QVariant> custom_data;
-
-  foreach (const Feed *feed, getSubTreeFeeds()) {
-    QVariantMap feed_custom_data;
-
-    feed_custom_data.insert(QSL("auto_update_interval"), feed->autoUpdateInitialInterval());
-    feed_custom_data.insert(QSL("auto_update_type"), feed->autoUpdateType());
-
-    custom_data.insert(feed->customId(), feed_custom_data);
-  }
-
-  return custom_data;
-}
-
-void OwnCloudServiceRoot::restoreCustomFeedsData(const QMap<int,QVariant> &data, const QHash<int,Feed*> &feeds) {
-  foreach (int custom_id, data.keys()) {
-    if (feeds.contains(custom_id)) {
-      Feed *feed = feeds.value(custom_id);
-      QVariantMap feed_custom_data = data.value(custom_id).toMap();
-
-      feed->setAutoUpdateInitialInterval(feed_custom_data.value(QSL("auto_update_interval")).toInt());
-      feed->setAutoUpdateType(static_cast<Feed::AutoUpdateType>(feed_custom_data.value(QSL("auto_update_type")).toInt()));
-    }
-  }
-}
-
 RootItem *OwnCloudServiceRoot::obtainNewTreeForSyncIn() const {
   OwnCloudGetFeedsCategoriesResponse feed_cats_response = m_network->feedsCategories();
 
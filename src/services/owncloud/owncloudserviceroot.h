@@ -55,9 +55,10 @@ class OwnCloudServiceRoot : public ServiceRoot {
     void addNewFeed(const QString &url);
     void addNewCategory();
 
+  protected:
+    bool sendPendingChanges(PendingChange::Type type, int value, const QList<PendingChange> &changes);
+
   private:
-    QMap<int,QVariant> storeCustomFeedsData();
-    void restoreCustomFeedsData(const QMap<int,QVariant> &data, const QHash<int,Feed*> &feeds);
     RootItem *obtainNewTreeForSyncIn() const;
 
     void loadFromDatabase();
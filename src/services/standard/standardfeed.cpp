@@ -24,6 +24,7 @@
 #include "miscellaneous/textfactory.h"
 #include "miscellaneous/settings.h"
 #include "miscellaneous/iconfactory.h"
+#include "miscellaneous/mutex.h"
 #include "miscellaneous/simplecrypt/simplecrypt.h"
 #include "network-web/networkfactory.h"
 #include "gui/dialogs/formmain.h"
@@ -40,6 +41,7 @@
 #include <QDomNode>
 #include <QDomElement>
 #include <QXmlStreamReader>
+#include <QTimer>
 
 
 StandardFeed::StandardFeed(RootItem *parent_item)
@@ -50,6 +52,8 @@ StandardFeed::StandardFeed(RootItem *parent_item)
   m_networkError = QNetworkReply::NoError;
   m_type = Rss0X;
   m_encoding = QString();
+  m_contentHash = 0;
+  m_pendingContentHash = 0;
 }
 
 StandardFeed::StandardFeed(const StandardFeed &other)
@@ -60,6 +64,8 @@ StandardFeed::StandardFeed(const StandardFeed &other)
   m_networkError = other.networkError();
   m_type = other.type();
   m_encoding = other.encoding();
+  m_contentHash = other.m_contentHash;
+  m_pendingContentHash = other.m_pendingContentHash;
 
   setCountOfAllMessages(other.countOfAllMessages());
   setCountOfUnreadMessages(other.countOfUnreadMessages());
@@ -420,6 +426,8 @@ bool StandardFeed::editItself(StandardFeed *new_feed_data) {
   original_feed->setEncoding(new_feed_data->encoding());
   original_feed->setDescription(new_feed_data->description());
   original_feed->setUrl(new_feed_data->url());
+  original_feed->m_contentHash = 0;
+  original_feed->m_pendingContentHash = 0;
   original_feed->setPasswordProtected(new_feed_data->passwordProtected());
   original_feed->setUsername(new_feed_data->username());
   original_feed->setPassword(new_feed_data->password());
@@ -433,9 +441,21 @@ bool StandardFeed::editItself(StandardFeed *new_feed_data) {
 
 QList<Message> StandardFeed::obtainNewMessages() {
   QByteArray feed_contents;
-  int download_timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
-  m_networkError = NetworkFactory::downloadFeedFile(url(), download_timeout, feed_contents,
-                                                    passwordProtected(), username(), password()).first;
+
+  if (!m_prefetchedContents.isEmpty() &&
+      m_prefetchedDate.secsTo(QDateTime::currentDateTimeUtc()) < PREFETCHED_CONTENTS_VALIDITY) {
+    // Whole feed was downloaded recently when its metadata were fetched, use it.
+    qDebug("Using prefetched contents of feed '%s'.", qPrintable(url()));
+    feed_contents = m_prefetchedContents;
+    m_networkError = QNetworkReply::NoError;
+  }
+  else {
+    int download_timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+    m_networkError = NetworkFactory::downloadFeedFile(url(), download_timeout, feed_contents,
+                                                      passwordProtected(), username(), password()).first;
+  }
+
+  m_prefetchedContents.clear();
 
   if (m_networkError != QNetworkReply::NoError) {
     qWarning("Error during fetching of new messages for feed '%s' (id %d).", qPrintable(url()), id());
@@ -446,6 +466,21 @@ QList<Message> StandardFeed::obtainNewMessages() {
     setStatus(Normal);
   }
 
+  const quint64 content_hash = calculateContentHash(feed_contents);
+
+  if (content_hash == m_contentHash) {
+    // Feed data are byte-to-byte same as during last update, there
+    // is no need to decode them, parse them or touch database.
+    qDebug("Contents of feed '%s' (id %d) did not change since last update.", qPrintable(url()), id());
+    setContentUnchanged(true);
+    return QList<Message>();
+  }
+  else {
+    // Hash is remembered only if messages get stored, otherwise
+    // same data must be processed again during next update.
+    m_pendingContentHash = content_hash;
+  }
+
   // Encode downloaded data for further parsing.
   QTextCodec *codec = QTextCodec::codecForName(encoding().toLocal8Bit());
   QString formatted_feed_contents;
@@ -483,6 +518,62 @@ QList<Message> StandardFeed::obtainNewMessages() {
   return messages;
 }
 
+quint64 StandardFeed::calculateContentHash(const QByteArray &feed_contents) const {
+  if (qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::ContentHashItemsOnly)).toBool()) {
+    // Skip feed header, which often contains volatile data like
+    // build date, and hash only the part starting with first message.
+    int items_start = feed_contents.indexOf(type() == Atom10 ? "<entry" : "<item");
+
+    if (items_start >= 0) {
+      return TextFactory::hash64(feed_contents.constData() + items_start, feed_contents.size() - items_start);
+    }
+  }
+
+  return TextFactory::hash64(feed_contents);
+}
+
+void StandardFeed::messagesStored() {
+  m_contentHash = m_pendingContentHash;
+}
+
+void StandardFeed::setPrefetchedContents(const QByteArray &contents) {
+  m_prefetchedContents = contents;
+  m_prefetchedDate = QDateTime::currentDateTimeUtc();
+
+  QTimer::singleShot(PREFETCHED_CONTENTS_VALIDITY * 1000, this, SLOT(dropStalePrefetchedContents()));
+}
+
+void StandardFeed::takePrefetchedContents(StandardFeed *other) {
+  if (other->m_prefetchedContents.isEmpty()) {
+    return;
+  }
+
+  m_prefetchedContents = other->m_prefetchedContents;
+  m_prefetchedDate = other->m_prefetchedDate;
+  other->m_prefetchedContents.clear();
+
+  QTimer::singleShot(qMax(0, PREFETCHED_CONTENTS_VALIDITY - m_prefetchedDate.secsTo(QDateTime::currentDateTimeUtc())) * 1000,
+                     this, SLOT(dropStalePrefetchedContents()));
+}
+
+void StandardFeed::dropStalePrefetchedContents() {
+  if (m_prefetchedContents.isEmpty() ||
+      m_prefetchedDate.secsTo(QDateTime::currentDateTimeUtc()) < PREFETCHED_CONTENTS_VALIDITY) {
+    return;
+  }
+
+  if (!qApp->feedUpdateLock()->tryLock()) {
+    // Data might be read by running update of this feed, which
+    // drops them itself, check them again later.
+    QTimer::singleShot(PREFETCHED_CONTENTS_VALIDITY * 1000, this, SLOT(dropStalePrefetchedContents()));
+    return;
+  }
+
+  qDebug("Dropping stale prefetched contents of feed '%s'.", qPrintable(url()));
+  m_prefetchedContents.clear();
+  qApp->feedUpdateLock()->unlock();
+}
+
 QNetworkReply::NetworkError StandardFeed::networkError() const {
   return m_networkError;
 }
@@ -508,4 +599,8 @@ StandardFeed::StandardFeed(const QSqlRecord &record) : Feed(nullptr) {
 
   setAutoUpdateType(static_cast<Feed::AutoUpdateType>(record.value(FDS_DB_UPDATE_TYPE_INDEX).toInt()));
   setAutoUpdateInitialInterval(record.value(FDS_DB_UPDATE_INTERVAL_INDEX).toInt());
+
+  m_networkError = QNetworkReply::NoError;
+  m_contentHash = 0;
+  m_pendingContentHash = 0;
 }
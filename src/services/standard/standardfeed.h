@@ -125,6 +125,15 @@ class StandardFeed : public Feed {
 
     QNetworkReply::NetworkError networkError() const;
 
+    // Sets raw feed data which were already downloaded elsewhere,
+    // they are used instead of downloading during next update.
+    // NOTE: Data are dropped once they are stale.
+    void setPrefetchedContents(const QByteArray &contents);
+
+    // Moves prefetched data of given feed to this feed. Copies
+    // of feeds do not get them.
+    void takePrefetchedContents(StandardFeed *other);
+
     // Tries to guess feed hidden under given URL
     // and uses given credentials.
     // Returns pointer to guessed feed (if at least partially
@@ -141,9 +150,19 @@ class StandardFeed : public Feed {
     // Fetches metadata for the feed.
     void fetchMetadataForItself();
 
+  private slots:
+    void dropStalePrefetchedContents();
+
   private:
     QList<Message> obtainNewMessages();
 
+    // Calculates hash of raw feed data, which is used
+    // to detect feeds which did not change since last update.
+    quint64 calculateContentHash(const QByteArray &feed_contents) const;
+
+  protected:
+    void messagesStored();
+
   private:
     bool m_passwordProtected;
     QString m_username;
@@ -152,6 +171,14 @@ class StandardFeed : public Feed {
     Type m_type;
     QNetworkReply::NetworkError m_networkError;
     QString m_encoding;
+
+    // Hash of raw data obtained during last update. Hash of newly
+    // downloaded data is remembered only once its messages are stored.
+    quint64 m_contentHash;
+    quint64 m_pendingContentHash;
+
+    QByteArray m_prefetchedContents;
+    QDateTime m_prefetchedDate;
 };
 
 Q_DECLARE_METATYPE(StandardFeed::Type)
@@ -0,0 +1,425 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#include "services/standard/standardfeedmetadataprober.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/settings.h"
+#include "network-web/iconcache.h"
+#include "network-web/networkfactory.h"
+#include "network-web/silentnetworkaccessmanager.h"
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QPixmap>
+#include <QIcon>
+
+
+FeedMetadataProber::FeedMetadataProber(QObject *parent)
+  : QObject(parent), m_network(new SilentNetworkAccessManager(this)), m_pendingProbes(QList<Probe*>()),
+    m_runningProbes(QHash<QNetworkReply*,Probe*>()), m_iconDownloads(QHash<QNetworkReply*,Probe*>()),
+    m_probesPerHost(QHash<QString,int>()), m_timeout(qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt()),
+    m_completed(0), m_total(0), m_failed(0), m_succeeded(0), m_prefetchedBytes(0) {
+}
+
+FeedMetadataProber::~FeedMetadataProber() {
+  QList<QNetworkReply*> replies = m_runningProbes.keys() + m_iconDownloads.keys();
+
+  foreach (QNetworkReply *reply, replies) {
+    reply->disconnect(this);
+    reply->abort();
+  }
+
+  qDeleteAll(m_pendingProbes);
+  qDeleteAll(m_runningProbes);
+  qDeleteAll(m_iconDownloads);
+}
+
+bool FeedMetadataProber::isRunning() const {
+  return m_completed < m_total;
+}
+
+void FeedMetadataProber::probeFeeds(const QList<StandardFeed*> &feeds) {
+  if (!isRunning()) {
+    m_completed = m_total = m_failed = m_succeeded = 0;
+    m_prefetchedBytes = 0;
+  }
+
+  if (feeds.isEmpty()) {
+    if (!isRunning()) {
+      emit finished(m_failed, m_succeeded);
+    }
+
+    return;
+  }
+
+  foreach (StandardFeed *feed, feeds) {
+    Probe *probe = new Probe();
+
+    probe->m_feed = feed;
+    probe->m_host = hostOf(feed->url());
+    probe->m_redirections = 0;
+    m_pendingProbes.append(probe);
+  }
+
+  m_total += feeds.size();
+
+  qDebug("Probing metadata of %d feeds, %d probes are already running.", feeds.size(), m_runningProbes.size());
+  startPendingProbes();
+}
+
+void FeedMetadataProber::cancel() {
+  if (!isRunning()) {
+    return;
+  }
+
+  // Pending probes are discarded, feeds keep their current metadata.
+  m_completed += m_pendingProbes.size();
+  m_failed += m_pendingProbes.size();
+  qDeleteAll(m_pendingProbes);
+  m_pendingProbes.clear();
+
+  if (m_runningProbes.isEmpty() && m_iconDownloads.isEmpty()) {
+    emit finished(m_failed, m_succeeded);
+  }
+  else {
+    // Running probes are finished via their "finished" signals.
+    QList<QNetworkReply*> replies = m_runningProbes.keys() + m_iconDownloads.keys();
+
+    foreach (QNetworkReply *reply, replies) {
+      reply->abort();
+    }
+  }
+}
+
+void FeedMetadataProber::onReadyRead() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+  Probe *probe = m_runningProbes.value(reply);
+
+  if (probe == nullptr) {
+    return;
+  }
+
+  const QByteArray data = reply->readAll();
+
+  probe->m_data.append(data);
+
+  if (!probe->m_headerParsed) {
+    probe->m_reader.addData(data);
+
+    if (!parseAvailableData(probe)) {
+      // Data are not valid feed, rest of the feed is not needed.
+      reply->abort();
+      return;
+    }
+  }
+
+  if (probe->m_headerParsed && (probe->m_data.size() > METADATA_PROBE_MAX_PREFETCH ||
+                                m_prefetchedBytes + probe->m_data.size() > METADATA_PROBE_MAX_PREFETCH_TOTAL)) {
+    // Header is known and rest of the feed is downloaded only to be handed
+    // over to its first update. Do that only for small feeds and only until
+    // prefetched data of all feeds reach their limit.
+    probe->m_data.clear();
+    reply->abort();
+  }
+}
+
+void FeedMetadataProber::onFinished() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+  Probe *probe = m_runningProbes.take(reply);
+
+  reply->deleteLater();
+
+  if (probe == nullptr) {
+    return;
+  }
+
+  const QUrl redirection_url = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+
+  if (redirection_url.isValid() && !probe->m_headerParsed && probe->m_redirections++ < METADATA_PROBE_MAX_REDIRECTIONS) {
+    startProbe(probe, reply->url().resolved(redirection_url));
+    return;
+  }
+
+  m_probesPerHost[probe->m_host]--;
+
+  if (probe->m_headerParsed) {
+    StandardFeed *feed = probe->m_feed;
+
+    feed->setType(probe->m_type);
+    feed->setEncoding(probe->m_encoding.isEmpty() ? QString(DEFAULT_FEED_ENCODING) : probe->m_encoding);
+    feed->setDescription(probe->m_description.trimmed());
+
+    if (!probe->m_title.trimmed().isEmpty()) {
+      feed->setTitle(probe->m_title.simplified());
+    }
+
+    if (reply->error() == QNetworkReply::NoError &&
+        m_prefetchedBytes + probe->m_data.size() <= METADATA_PROBE_MAX_PREFETCH_TOTAL) {
+      // Whole feed was downloaded, so let the first update of the feed use it
+      // instead of downloading it again.
+      m_prefetchedBytes += probe->m_data.size();
+      feed->setPrefetchedContents(probe->m_data);
+    }
+
+    downloadIcon(probe);
+  }
+  else {
+    qWarning("Metadata of feed '%s' were not obtained, network error: '%s'.",
+             qPrintable(probe->m_feed->url()), qPrintable(NetworkFactory::networkErrorText(reply->error())));
+    finishProbe(probe, false);
+  }
+
+  startPendingProbes();
+}
+
+void FeedMetadataProber::onIconFinished() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+  Probe *probe = m_iconDownloads.take(reply);
+
+  reply->deleteLater();
+
+  if (probe == nullptr) {
+    return;
+  }
+
+  QPixmap icon_pixmap;
+
+  if (reply->error() == QNetworkReply::NoError && icon_pixmap.loadFromData(reply->readAll())) {
+    probe->m_feed->setIcon(QIcon(icon_pixmap));
+  }
+
+  // Other feeds of the same site will use cached icon.
+  qApp->iconCache()->insertIcon(reply->property("icon_url").toString(), icon_pixmap.isNull() ? QIcon() : QIcon(icon_pixmap));
+
+  // Feed is probed even if icon was not obtained.
+  finishProbe(probe, true);
+  startPendingProbes();
+}
+
+void FeedMetadataProber::startPendingProbes() {
+  for (int i = 0; i < m_pendingProbes.size() &&
+       m_runningProbes.size() + m_iconDownloads.size() < METADATA_PROBES_PARALLEL; ) {
+    Probe *probe = m_pendingProbes.at(i);
+
+    if (m_probesPerHost.value(probe->m_host) >= METADATA_PROBES_PER_HOST) {
+      // Do not flood single host, try another feed.
+      i++;
+      continue;
+    }
+
+    m_pendingProbes.removeAt(i);
+    m_probesPerHost[probe->m_host]++;
+
+    QString url = probe->m_feed->url();
+
+    if (url.startsWith(QL1S(URI_SCHEME_FEED))) {
+      url.replace(QRegExp(QString('^') + URI_SCHEME_FEED), QString(URI_SCHEME_HTTP));
+    }
+
+    startProbe(probe, QUrl(url));
+  }
+}
+
+void FeedMetadataProber::startProbe(Probe *probe, const QUrl &url) {
+  QNetworkRequest request(url);
+
+  probe->m_reader.clear();
+  probe->m_data.clear();
+  probe->m_depth = 0;
+  probe->m_channelDepth = 0;
+  probe->m_headerParsed = false;
+  probe->m_type = StandardFeed::Rss2X;
+  probe->m_encoding.clear();
+  probe->m_title.clear();
+  probe->m_description.clear();
+  probe->m_link.clear();
+  probe->m_currentField = nullptr;
+
+  request.setRawHeader("Accept", ACCEPT_HEADER_FOR_FEED_DOWNLOADER);
+
+  QNetworkReply *reply = m_network->get(request);
+
+  reply->setProperty("protected", probe->m_feed->passwordProtected());
+  reply->setProperty("username", probe->m_feed->username());
+  reply->setProperty("password", probe->m_feed->password());
+
+  m_runningProbes.insert(reply, probe);
+
+  connect(reply, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+  connect(reply, SIGNAL(finished()), this, SLOT(onFinished()));
+
+  if (m_timeout > 0) {
+    QTimer::singleShot(m_timeout, reply, SLOT(abort()));
+  }
+}
+
+bool FeedMetadataProber::parseAvailableData(Probe *probe) {
+  QXmlStreamReader &reader = probe->m_reader;
+
+  while (!reader.atEnd()) {
+    switch (reader.readNext()) {
+      case QXmlStreamReader::StartDocument:
+        probe->m_encoding = reader.documentEncoding().toString();
+        break;
+
+      case QXmlStreamReader::StartElement: {
+        const QStringRef name = reader.name();
+
+        probe->m_depth++;
+        probe->m_currentField = nullptr;
+
+        if (probe->m_depth == 1) {
+          if (name == QL1S("RDF")) {
+            probe->m_type = StandardFeed::Rdf;
+          }
+          else if (name == QL1S("rss")) {
+            const QString rss_type = reader.attributes().value(QSL("version")).toString();
+
+            if (rss_type == QL1S("0.91") || rss_type == QL1S("0.92") || rss_type == QL1S("0.93")) {
+              probe->m_type = StandardFeed::Rss0X;
+            }
+            else {
+              probe->m_type = StandardFeed::Rss2X;
+            }
+          }
+          else if (name == QL1S("feed")) {
+            // ATOM feeds do not have channel element, root element is used instead.
+            probe->m_type = StandardFeed::Atom10;
+            probe->m_channelDepth = 1;
+          }
+          else {
+            reader.raiseError(QSL("Feed format was not recognized."));
+          }
+        }
+        else if (probe->m_channelDepth == 0) {
+          if (name == QL1S("channel") && probe->m_depth == 2) {
+            probe->m_channelDepth = 2;
+          }
+          else if (name == QL1S("item")) {
+            // RDF items are not nested in channel.
+            probe->m_headerParsed = true;
+            return true;
+          }
+        }
+        else if (probe->m_depth == probe->m_channelDepth + 1) {
+          if (name == QL1S("item") || name == QL1S("entry")) {
+            // All elements of header precede messages.
+            probe->m_headerParsed = true;
+            return true;
+          }
+          else if (name == QL1S("title") && probe->m_title.isEmpty()) {
+            probe->m_currentField = &probe->m_title;
+          }
+          else if ((name == QL1S("description") || name == QL1S("subtitle")) && probe->m_description.isEmpty()) {
+            probe->m_currentField = &probe->m_description;
+          }
+          else if (name == QL1S("link") && probe->m_link.isEmpty()) {
+            const QString href = reader.attributes().value(QSL("href")).toString();
+
+            if (href.isEmpty()) {
+              probe->m_currentField = &probe->m_link;
+            }
+            else {
+              probe->m_link = href;
+            }
+          }
+        }
+
+        break;
+      }
+
+      case QXmlStreamReader::Characters:
+        if (probe->m_currentField != nullptr) {
+          probe->m_currentField->append(reader.text());
+        }
+
+        break;
+
+      case QXmlStreamReader::EndElement:
+        probe->m_currentField = nullptr;
+
+        if (probe->m_channelDepth > 0 && probe->m_depth == probe->m_channelDepth) {
+          // Channel without any messages.
+          probe->m_headerParsed = true;
+          return true;
+        }
+
+        probe->m_depth--;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  if (reader.hasError() && reader.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+    qDebug("XML of feed '%s' is not valid: '%s'.", qPrintable(probe->m_feed->url()), qPrintable(reader.errorString()));
+    return false;
+  }
+  else {
+    // Either all is parsed or more data are needed.
+    return true;
+  }
+}
+
+void FeedMetadataProber::finishProbe(Probe *probe, bool success) {
+  if (success) {
+    m_succeeded++;
+  }
+  else {
+    m_failed++;
+  }
+
+  emit progress(probe->m_feed, ++m_completed, m_total);
+
+  delete probe;
+
+  if (m_completed >= m_total) {
+    qDebug("Probing of metadata finished, %d feeds probed, %d failed.", m_succeeded, m_failed);
+    qApp->iconCache()->saveIndex();
+    emit finished(m_failed, m_succeeded);
+  }
+}
+
+void FeedMetadataProber::downloadIcon(Probe *probe) {
+  const QString site_url = probe->m_link.trimmed().isEmpty() ? probe->m_feed->url() : probe->m_link.trimmed();
+  const QString icon_url = NetworkFactory::iconUrlForDomain(site_url);
+  QIcon icon;
+
+  if (qApp->iconCache()->cachedIcon(icon_url, icon)) {
+    if (!icon.isNull()) {
+      probe->m_feed->setIcon(icon);
+    }
+
+    finishProbe(probe, true);
+    return;
+  }
+
+  QNetworkReply *reply = m_network->get(QNetworkRequest(QUrl(icon_url)));
+
+  reply->setProperty("icon_url", icon_url);
+  m_iconDownloads.insert(reply, probe);
+  connect(reply, SIGNAL(finished()), this, SLOT(onIconFinished()));
+  QTimer::singleShot(DOWNLOAD_TIMEOUT, reply, SLOT(abort()));
+}
+
+QString FeedMetadataProber::hostOf(const QString &url) {
+  return QUrl(url).host().toLower();
+}
@@ -0,0 +1,109 @@
+// This file is part of RSS Guard.
+//
+// Copyright (C) 2011-2016 by Martin Rotter <rotter.martinos@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef STANDARDFEEDMETADATAPROBER_H
+#define STANDARDFEEDMETADATAPROBER_H
+
+#include <QObject>
+
+#include "services/standard/standardfeed.h"
+
+#include <QHash>
+#include <QXmlStreamReader>
+
+
+class SilentNetworkAccessManager;
+class QNetworkReply;
+
+// Fetches metadata (title, description, type, encoding and icon)
+// of many feeds at once, for example when feeds are imported.
+//
+// Feeds are probed asynchronously, with limited count of concurrent
+// downloads overall and per single host. Bodies of small feeds are handed
+// over to the feeds and used by their first update, so they are not downloaded
+// twice. Download is aborted once header of the channel is parsed and the body
+// exceeds METADATA_PROBE_MAX_PREFETCH bytes or prefetched bodies of all feeds
+// exceed METADATA_PROBE_MAX_PREFETCH_TOTAL bytes.
+class FeedMetadataProber : public QObject {
+    Q_OBJECT
+
+  public:
+    // Constructors and destructors.
+    explicit FeedMetadataProber(QObject *parent = 0);
+    virtual ~FeedMetadataProber();
+
+    bool isRunning() const;
+
+  public slots:
+    // Starts probing of given feeds. Feeds which are successfully
+    // probed are updated in place.
+    void probeFeeds(const QList<StandardFeed*> &feeds);
+
+    // Aborts all running and pending probes.
+    void cancel();
+
+  signals:
+    void progress(const StandardFeed *feed, int completed, int total);
+    void finished(int count_failed, int count_succeeded);
+
+  private slots:
+    void onReadyRead();
+    void onFinished();
+    void onIconFinished();
+
+  private:
+    // Represents state of single feed probe.
+    struct Probe {
+      StandardFeed *m_feed;
+      QXmlStreamReader m_reader;
+      QByteArray m_data;
+      QString m_host;
+      int m_redirections;
+      int m_depth;
+      int m_channelDepth;
+      bool m_headerParsed;
+      StandardFeed::Type m_type;
+      QString m_encoding;
+      QString m_title;
+      QString m_description;
+      QString m_link;
+      QString *m_currentField;
+    };
+
+    void startPendingProbes();
+    void startProbe(Probe *probe, const QUrl &url);
+    bool parseAvailableData(Probe *probe);
+    void finishProbe(Probe *probe, bool success);
+    void downloadIcon(Probe *probe);
+
+    static QString hostOf(const QString &url);
+
+    SilentNetworkAccessManager *m_network;
+    QList<Probe*> m_pendingProbes;
+    QHash<QNetworkReply*,Probe*> m_runningProbes;
+    QHash<QNetworkReply*,Probe*> m_iconDownloads;
+    QHash<QString,int> m_probesPerHost;
+
+    int m_timeout;
+    int m_completed;
+    int m_total;
+    int m_failed;
+    int m_succeeded;
+    qint64 m_prefetchedBytes;
+};
+
+#endif // STANDARDFEEDMETADATAPROBER_H
@@ -18,6 +18,7 @@
 #include "services/standard/standardfeedsimportexportmodel.h"
 
 #include "services/standard/standardfeed.h"
+#include "services/standard/standardfeedmetadataprober.h"
 #include "services/standard/standardcategory.h"
 #include "services/standard/standardserviceroot.h"
 #include "definitions/definitions.h"
@@ -29,6 +30,7 @@
 #include <QDomAttr>
 #include <QStack>
 #include <QLocale>
+#include <QEventLoop>
 
 
 FeedsImportExportModel::FeedsImportExportModel(QObject *parent)
@@ -157,6 +159,7 @@ void FeedsImportExportModel::importAsOPML20(const QByteArray &data, bool fetch_m
 
   int completed = 0, total = 0, succeded = 0, failed = 0;
   StandardServiceRoot *root_item = new StandardServiceRoot();
+  QList<StandardFeed*> feeds_to_probe;
   QStack<RootItem*> model_items; model_items.push(root_item);
   QStack<QDomElement> elements_to_process; elements_to_process.push(opml_document.documentElement().elementsByTagName(QSL("body")).at(0).toElement());
 
@@ -181,49 +184,38 @@ void FeedsImportExportModel::importAsOPML20(const QByteArray &data, bool fetch_m
           QString feed_url = child_element.attribute(QSL("xmlUrl"));
 
           if (!feed_url.isEmpty()) {
-            QPair<StandardFeed*,QNetworkReply::NetworkError> guessed;
+            QString feed_title = child_element.attribute(QSL("text"));
+            QString feed_encoding = child_element.attribute(QSL("encoding"), DEFAULT_FEED_ENCODING);
+            QString feed_type = child_element.attribute(QSL("version"), DEFAULT_FEED_TYPE).toUpper();
+            QString feed_description = child_element.attribute(QSL("description"));
+            QIcon feed_icon = qApp->icons()->fromByteArray(child_element.attribute(QSL("rssguard:icon")).toLocal8Bit());
+
+            StandardFeed *new_feed = new StandardFeed(active_model_item);
+            new_feed->setTitle(feed_title);
+            new_feed->setDescription(feed_description);
+            new_feed->setEncoding(feed_encoding);
+            new_feed->setUrl(feed_url);
+            new_feed->setCreationDate(QDateTime::currentDateTime());
+            new_feed->setIcon(feed_icon.isNull() ? qApp->icons()->fromTheme(QSL("application-rss+xml")) : feed_icon);
+
+            if (feed_type == QL1S("RSS1")) {
+              new_feed->setType(StandardFeed::Rdf);
+            }
+            else if (feed_type == QL1S("ATOM")) {
+              new_feed->setType(StandardFeed::Atom10);
+            }
+            else {
+              new_feed->setType(StandardFeed::Rss2X);
+            }
 
-            if (fetch_metadata_online &&
-                (guessed = StandardFeed::guessFeed(feed_url)).second == QNetworkReply::NoError) {
-              // We should obtain fresh metadata from online feed source.
-              guessed.first->setUrl(feed_url);
-              active_model_item->appendChild(guessed.first);
+            active_model_item->appendChild(new_feed);
 
-              succeded++;
+            if (fetch_metadata_online) {
+              // Metadata are fetched later for all feeds at once.
+              feeds_to_probe.append(new_feed);
             }
             else {
-              QString feed_title = child_element.attribute(QSL("text"));
-              QString feed_encoding = child_element.attribute(QSL("encoding"), DEFAULT_FEED_ENCODING);
-              QString feed_type = child_element.attribute(QSL("version"), DEFAULT_FEED_TYPE).toUpper();
-              QString feed_description = child_element.attribute(QSL("description"));
-              QIcon feed_icon = qApp->icons()->fromByteArray(child_element.attribute(QSL("rssguard:icon")).toLocal8Bit());
-
-              StandardFeed *new_feed = new StandardFeed(active_model_item);
-              new_feed->setTitle(feed_title);
-              new_feed->setDescription(feed_description);
-              new_feed->setEncoding(feed_encoding);
-              new_feed->setUrl(feed_url);
-              new_feed->setCreationDate(QDateTime::currentDateTime());
-              new_feed->setIcon(feed_icon.isNull() ? qApp->icons()->fromTheme(QSL("application-rss+xml")) : feed_icon);
-
-              if (feed_type == QL1S("RSS1")) {
-                new_feed->setType(StandardFeed::Rdf);
-              }
-              else if (feed_type == QL1S("ATOM")) {
-                new_feed->setType(StandardFeed::Atom10);
-              }
-              else {
-                new_feed->setType(StandardFeed::Rss2X);
-              }
-
-              active_model_item->appendChild(new_feed);
-
-              if (fetch_metadata_online && guessed.second != QNetworkReply::NoError) {
-                failed++;
-              }
-              else {
-                succeded++;
-              }
+              succeded++;
             }
           }
         }
@@ -262,6 +254,11 @@ void FeedsImportExportModel::importAsOPML20(const QByteArray &data, bool fetch_m
     }
   }
 
+  if (!feeds_to_probe.isEmpty()) {
+    // We should obtain fresh metadata from online feed sources.
+    probeFeedsMetadata(feeds_to_probe, failed, succeded);
+  }
+
   // Now, XML is processed and we have result in form of pointer item structure.
   emit layoutAboutToBeChanged();
   setRootItem(root_item);
@@ -285,37 +282,26 @@ void FeedsImportExportModel::importAsTxtURLPerLine(const QByteArray &data, bool
 
   int completed = 0, succeded = 0, failed = 0;
   StandardServiceRoot *root_item = new StandardServiceRoot();
+  QList<StandardFeed*> feeds_to_probe;
   QList<QByteArray> urls = data.split('\n');
 
   foreach (const QByteArray &url, urls) {
     if (!url.isEmpty()) {
-      QPair<StandardFeed*,QNetworkReply::NetworkError> guessed;
+      StandardFeed *feed = new StandardFeed();
 
-      if (fetch_metadata_online &&
-          (guessed = StandardFeed::guessFeed(url)).second == QNetworkReply::NoError) {
-        guessed.first->setUrl(url);
-        root_item->appendChild(guessed.first);
-        succeded++;
+      feed->setUrl(url);
+      feed->setTitle(url);
+      feed->setCreationDate(QDateTime::currentDateTime());
+      feed->setIcon(qApp->icons()->fromTheme(QSL("application-rss+xml")));
+      feed->setEncoding(DEFAULT_FEED_ENCODING);
+      root_item->appendChild(feed);
+
+      if (fetch_metadata_online) {
+        feeds_to_probe.append(feed);
       }
       else {
-        StandardFeed *feed = new StandardFeed();
-
-        feed->setUrl(url);
-        feed->setTitle(url);
-        feed->setCreationDate(QDateTime::currentDateTime());
-        feed->setIcon(qApp->icons()->fromTheme(QSL("application-rss+xml")));
-        feed->setEncoding(DEFAULT_FEED_ENCODING);
-        root_item->appendChild(feed);
-
-        if (fetch_metadata_online && guessed.second != QNetworkReply::NoError) {
-          failed++;
-        }
-        else {
-          succeded++;
-        }
+        succeded++;
       }
-
-      qApp->processEvents();
     }
     else {
       qWarning("Detected empty URL when parsing input TXT [one URL per line] data.");
@@ -325,6 +311,10 @@ void FeedsImportExportModel::importAsTxtURLPerLine(const QByteArray &data, bool
     emit parsingProgress(++completed, urls.size());
   }
 
+  if (!feeds_to_probe.isEmpty()) {
+    probeFeedsMetadata(feeds_to_probe, failed, succeded);
+  }
+
   // Now, XML is processed and we have result in form of pointer item structure.
   emit layoutAboutToBeChanged();
   setRootItem(root_item);
@@ -332,6 +322,29 @@ void FeedsImportExportModel::importAsTxtURLPerLine(const QByteArray &data, bool
   emit parsingFinished(failed, succeded, false);
 }
 
+void FeedsImportExportModel::probeFeedsMetadata(const QList<StandardFeed*> &feeds, int &count_failed, int &count_succeeded) {
+  FeedMetadataProber prober;
+  QEventLoop loop;
+
+  connect(&prober, &FeedMetadataProber::progress, [this](const StandardFeed *feed, int completed, int total) {
+    Q_UNUSED(feed)
+    emit parsingProgress(completed, total);
+  });
+  connect(&prober, &FeedMetadataProber::finished, [&](int failed, int succeeded) {
+    count_failed += failed;
+    count_succeeded += succeeded;
+    loop.quit();
+  });
+
+  // Feeds are probed in parallel, wait until all of them are done.
+  emit parsingProgress(0, feeds.size());
+  prober.probeFeeds(feeds);
+
+  if (prober.isRunning()) {
+    loop.exec();
+  }
+}
+
 FeedsImportExportModel::Mode FeedsImportExportModel::mode() const {
   return m_mode;
 }
@@ -21,6 +21,8 @@
 #include "services/abstract/accountcheckmodel.h"
 
 
+class StandardFeed;
+
 class FeedsImportExportModel : public AccountCheckModel {
     Q_OBJECT
 
@@ -55,6 +57,10 @@ class FeedsImportExportModel : public AccountCheckModel {
     void parsingFinished(int count_failed, int count_succeeded, bool parsing_error);
 
   private:
+    // Fetches metadata of given feeds from their online sources,
+    // all feeds are probed in parallel.
+    void probeFeedsMetadata(const QList<StandardFeed*> &feeds, int &count_failed, int &count_succeeded);
+
     Mode m_mode;
 };
 
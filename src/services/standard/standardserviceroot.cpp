@@ -190,15 +190,6 @@ void StandardServiceRoot::checkArgumentsForFeedAdding() {
   }
 }
 
-QMap<int,QVariant> StandardServiceRoot::storeCustomFeedsData() {
-  return QMap<int,QVariant>();
-}
-
-void StandardServiceRoot::restoreCustomFeedsData(const QMap<int,QVariant> &data, const QHash<int,Feed*> &feeds) {
-  Q_UNUSED(feeds)
-  Q_UNUSED(data)
-}
-
 QString StandardServiceRoot::processFeedUrl(const QString &feed_url) {
   if (feed_url.startsWith(QL1S(URI_SCHEME_FEED_SHORT))) {
     QString without_feed_prefix = feed_url.mid(5);
@@ -293,6 +284,9 @@ bool StandardServiceRoot::mergeImportExportModel(FeedsImportExportModel *model,
         StandardFeed *source_feed = static_cast<StandardFeed*>(source_item);
         StandardFeed *new_feed = new StandardFeed(*source_feed);
 
+        // Feed body downloaded when metadata were probed is used by first update.
+        new_feed->takePrefetchedContents(source_feed);
+
         // Append this feed and end this iteration.
         if (new_feed->addItself(target_parent)) {
           requestItemReassignment(new_feed, target_parent);
@@ -24,8 +24,8 @@
 #include "services/tt-rss/ttrsscategory.h"
 #include "miscellaneous/application.h"
 #include "miscellaneous/iconfactory.h"
-#include "miscellaneous/textfactory.h"
 #include "network-web/networkfactory.h"
+#include "network-web/iconcache.h"
 
 #include <QJsonDocument>
 #include <QJsonArray>
@@ -458,6 +458,7 @@ RootItem *TtRssGetFeedsCategoriesResponse::feedsCategories(bool obtain_icons, QS
     // We have data, construct object tree according to data.
     QJsonArray items_to_process = m_rawContent["content"].toObject()["categories"].toObject()["items"].toArray();
     QList<QPair<RootItem*,QJsonValue> > pairs;
+    QList<QPair<TtRssFeed*,QString> > feed_icons;
 
     foreach (QJsonValue item, items_to_process) {
       pairs.append(QPair<RootItem*,QJsonValue>(parent, item));
@@ -503,18 +504,8 @@ RootItem *TtRssGetFeedsCategoriesResponse::feedsCategories(bool obtain_icons, QS
             QString icon_path = item["icon"].type() == QJsonValue::String ? item["icon"].toString() : QString();
 
             if (!icon_path.isEmpty()) {
-              // Chop the "api/" suffix out and append
-              QString full_icon_address = base_address + QL1C('/') + icon_path;
-              QByteArray icon_data;
-
-              if (NetworkFactory::performNetworkOperation(full_icon_address, DOWNLOAD_TIMEOUT,
-                                                          QByteArray(), QString(), icon_data,
-                                                          QNetworkAccessManager::GetOperation).first == QNetworkReply::NoError) {
-                // Icon downloaded, set it up.
-                QPixmap icon_pixmap;
-                icon_pixmap.loadFromData(icon_data);
-                feed->setIcon(QIcon(icon_pixmap));
-              }
+              // Chop the "api/" suffix out and append, icons are obtained later all at once.
+              feed_icons.append(QPair<TtRssFeed*,QString>(feed, base_address + QL1C('/') + icon_path));
             }
           }
 
@@ -524,6 +515,22 @@ RootItem *TtRssGetFeedsCategoriesResponse::feedsCategories(bool obtain_icons, QS
         }
       }
     }
+
+    if (!feed_icons.isEmpty()) {
+      QStringList icon_addresses;
+
+      for (int i = 0; i < feed_icons.size(); i++) {
+        icon_addresses.append(feed_icons.at(i).second);
+      }
+
+      const QHash<QString,QIcon> icons = qApp->iconCache()->obtainIcons(icon_addresses);
+
+      for (int i = 0; i < feed_icons.size(); i++) {
+        if (icons.contains(feed_icons.at(i).second)) {
+          feed_icons.at(i).first->setIcon(icons.value(feed_icons.at(i).second));
+        }
+      }
+    }
   }
 
   return parent;
@@ -538,22 +545,23 @@ TtRssGetHeadlinesResponse::~TtRssGetHeadlinesResponse() {
 
 QList<Message> TtRssGetHeadlinesResponse::messages() const {
   QList<Message> messages;
+  MessageStringPool strings;
 
   foreach (QJsonValue item, m_rawContent["content"].toArray()) {
     QJsonObject mapped = item.toObject();
     Message message;
 
-    message.m_author = mapped["author"].toString();
+    message.m_author = strings.intern(mapped["author"].toString());
     message.m_isRead = !mapped["unread"].toBool();
     message.m_isImportant = mapped["marked"].toBool();
     message.m_contents = mapped["content"].toString();
 
     // Multiply by 1000 because Tiny Tiny RSS API does not include miliseconds in Unix
     // date/time number.
-    message.m_created = TextFactory::parseDateTime(mapped["updated"].toDouble() * 1000);
+    message.m_created = qint64(mapped["updated"].toDouble() * 1000);
     message.m_createdFromFeed = true;
     message.m_customId = QString::number(mapped["id"].toInt());
-    message.m_feedId = mapped["feed_id"].toString();
+    message.m_feedId = strings.intern(mapped["feed_id"].toString());
     message.m_title = mapped["title"].toString();
     message.m_url = mapped["link"].toString();
 
@@ -563,7 +571,7 @@ QList<Message> TtRssGetHeadlinesResponse::messages() const {
         QJsonObject mapped_attachemnt = attachment.toObject();
         Enclosure enclosure;
 
-        enclosure.m_mimeType = mapped_attachemnt["content_type"].toString();
+        enclosure.m_mimeType = strings.intern(mapped_attachemnt["content_type"].toString());
         enclosure.m_url = mapped_attachemnt["content_url"].toString();
         message.m_enclosures.append(enclosure);
       }
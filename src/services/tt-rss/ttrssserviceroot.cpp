@@ -180,29 +180,39 @@ QList<QAction*> TtRssServiceRoot::serviceMenu() {
 bool TtRssServiceRoot::onBeforeSetMessagesRead(RootItem *selected_item, const QList<Message> &messages, RootItem::ReadStatus read) {
   Q_UNUSED(selected_item)
 
-  TtRssUpdateArticleResponse response = m_network->updateArticles(customIDsOfMessages(messages),
-                                                                  UpdateArticle::Unread,
-                                                                  read == RootItem::Unread ?
-                                                                    UpdateArticle::SetToTrue :
-                                                                    UpdateArticle::SetToFalse);
-
-  if (m_network->lastError() == QNetworkReply::NoError && response.updateStatus() == STATUS_OK) {
-    return true;
-  }
-  else {
-    return false;
-  }
+  // Server is not contacted here, change is pushed to it later in background.
+  return recordPendingChanges(messages, read);
 }
 
 bool TtRssServiceRoot::onBeforeSwitchMessageImportance(RootItem *selected_item, const QList<ImportanceChange> &changes) {
   Q_UNUSED(selected_item)
 
-  // NOTE: We just toggle it here, because we know, that there is only
-  // toggling of starred status supported by RSS Guard right now and
-  // Tiny Tiny RSS API allows it, which is great.
-  TtRssUpdateArticleResponse response = m_network->updateArticles(customIDsOfMessages(changes),
-                                                                  UpdateArticle::Starred,
-                                                                  UpdateArticle::Togggle);
+  return recordPendingChanges(changes);
+}
+
+bool TtRssServiceRoot::sendPendingChanges(PendingChange::Type type, int value, const QList<PendingChange> &changes) {
+  QStringList ids;
+  ids.reserve(changes.size());
+
+  foreach (const PendingChange &change, changes) {
+    ids.append(change.m_customId);
+  }
+
+  // NOTE: Exact new states are sent instead of toggling, so that
+  // already pushed changes can be safely pushed again.
+  UpdateArticle::OperatingField field;
+  UpdateArticle::Mode mode;
+
+  if (type == PendingChange::Read) {
+    field = UpdateArticle::Unread;
+    mode = value == RootItem::Unread ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse;
+  }
+  else {
+    field = UpdateArticle::Starred;
+    mode = value == RootItem::Important ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse;
+  }
+
+  TtRssUpdateArticleResponse response = m_network->updateArticles(ids, field, mode);
 
   if (m_network->lastError() == QNetworkReply::NoError && response.updateStatus() == STATUS_OK) {
     return true;
@@ -280,30 +290,3 @@ RootItem *TtRssServiceRoot::obtainNewTreeForSyncIn() const {
     return nullptr;
   }
 }
-
-QMap<int,QVariant> TtRssServiceRoot::storeCustomFeedsData() {
-  QMap<int,QVariant> custom_data;
-
-  foreach (const Feed *feed, getSubTreeFeeds()) {
-    QVariantMap feed_custom_data;
-
-    feed_custom_data.insert(QSL("auto_update_interval"), feed->autoUpdateInitialInterval());
-    feed_custom_data.insert(QSL("auto_update_type"), feed->autoUpdateType());
-
-    custom_data.insert(feed->customId(), feed_custom_data);
-  }
-
-  return custom_data;
-}
-
-void TtRssServiceRoot::restoreCustomFeedsData(const QMap<int,QVariant> &data, const QHash<int,Feed*> &feeds) {
-  foreach (int custom_id, data.keys()) {
-    if (feeds.contains(custom_id)) {
-      Feed *feed = feeds.value(custom_id);
-      QVariantMap feed_custom_data = data.value(custom_id).toMap();
-
-      feed->setAutoUpdateInitialInterval(feed_custom_data.value(QSL("auto_update_interval")).toInt());
-      feed->setAutoUpdateType(static_cast<Feed::AutoUpdateType>(feed_custom_data.value(QSL("auto_update_type")).toInt()));
-    }
-  }
-}
@@ -62,10 +62,11 @@ class TtRssServiceRoot : public ServiceRoot {
     void addNewFeed(const QString &url = QString());
     void addNewCategory();
 
+  protected:
+    bool sendPendingChanges(PendingChange::Type type, int value, const QList<PendingChange> &changes);
+
   private:
     RootItem *obtainNewTreeForSyncIn() const;
-    QMap<int,QVariant> storeCustomFeedsData();
-    void restoreCustomFeedsData(const QMap<int,QVariant> &data, const QHash<int,Feed*> &feeds);
 
     void loadFromDatabase();
 